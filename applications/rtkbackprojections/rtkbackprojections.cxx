@@ -24,6 +24,8 @@
 #include "rtkFDKWarpBackProjectionImageFilter.h"
 #include "rtkJosephBackProjectionImageFilter.h"
 #include "rtkNormalizedJosephBackProjectionImageFilter.h"
+#include "rtkSiddonBackProjectionImageFilter.h"
+#include "rtkRayCastBackProjectionImageFilter.h"
 #ifdef RTK_USE_CUDA
 #  include "rtkCudaFDKBackProjectionImageFilter.h"
 #  include "rtkCudaBackProjectionImageFilter.h"
@@ -132,10 +134,12 @@ int main(int argc, char * argv[])
 #ifdef RTK_USE_CUDA
       bp = rtk::CudaRayCastBackProjectionImageFilter::New();
 #else
-      std::cerr << "The program has not been compiled with cuda option" << std::endl;
-      return EXIT_FAILURE;
+      bp = rtk::RayCastBackProjectionImageFilter<OutputImageType, OutputImageType>::New();
 #endif
       break;
+    case(bp_arg_Siddon):
+      bp = rtk::SiddonBackProjectionImageFilter<OutputImageType, OutputImageType>::New();
+      break;
     default:
     std::cerr << "Unhandled --method value." << std::endl;
     return EXIT_FAILURE;
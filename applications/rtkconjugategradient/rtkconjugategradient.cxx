@@ -27,11 +27,41 @@
 #include <fstream>
 #include <iterator>
 
+#include <itkCommand.h>
+
 #ifdef RTK_USE_CUDA
   #include <itkCudaImage.h>
 #endif
 #include <itkImageFileWriter.h>
 
+// Displays the residual norm after each iteration of the conjugate gradient
+template<class TFilter>
+class ResidualNormObserver : public itk::Command
+{
+public:
+  typedef ResidualNormObserver    Self;
+  typedef itk::Command            Superclass;
+  typedef itk::SmartPointer<Self> Pointer;
+  itkNewMacro(Self);
+
+  void Execute(itk::Object *caller, const itk::EventObject &event) ITK_OVERRIDE
+    {
+    TFilter *filter = dynamic_cast<TFilter *>(caller);
+    if( !filter || !itk::IterationEvent().CheckEvent(&event) )
+      return;
+    const std::vector<double> &norms = filter->GetResidualNorms();
+    std::cout << "Iteration " << norms.size()-1
+              << ", residual norm " << norms.back()
+              << " (" << norms.back() / norms.front() << " of the initial one)"
+              << std::endl;
+    }
+
+  void Execute(const itk::Object *, const itk::EventObject &) ITK_OVERRIDE {}
+
+protected:
+  ResidualNormObserver() {}
+};
+
 int main(int argc, char * argv[])
 {
   GGO(rtkconjugategradient, args_info);
@@ -122,7 +152,19 @@ int main(int argc, char * argv[])
   conjugategradient->SetInput( inputFilter->GetOutput() );
   conjugategradient->SetInput(1, reader->GetOutput());
   conjugategradient->SetInput(2, weightsSource->GetOutput());
-  conjugategradient->SetCudaConjugateGradient(!args_info.nocudacg_flag);
+  // The stopping criteria and the residual norms are only available with the
+  // conjugate gradient on CPU
+  conjugategradient->SetCudaConjugateGradient(!args_info.nocudacg_flag &&
+                                              !args_info.tolerance_given &&
+                                              !args_info.stagnation_given &&
+                                              !args_info.residuals_flag);
+  if(args_info.tolerance_given)
+    conjugategradient->SetTolerance(args_info.tolerance_arg);
+  if(args_info.stagnation_given)
+    conjugategradient->SetStagnationTolerance(args_info.stagnation_arg);
+  if(args_info.residuals_flag)
+    conjugategradient->AddObserver(itk::IterationEvent(),
+                                   ResidualNormObserver<ConjugateGradientFilterType>::New());
   if(args_info.mask_given)
     {
     conjugategradient->SetSupportMask(supportmaskSource->GetOutput() );
@@ -138,6 +180,17 @@ int main(int argc, char * argv[])
   conjugategradient->SetGeometry( geometryReader->GetOutputObject() );
   conjugategradient->SetNumberOfIterations( args_info.niterations_arg );
   conjugategradient->SetDisableDisplacedDetectorFilter(args_info.nodisplaced_flag);
+  switch(args_info.preconditioner_arg)
+    {
+    case(preconditioner_arg_Diagonal):
+      conjugategradient->SetPreconditioner(ConjugateGradientFilterType::DIAGONAL);
+      break;
+    case(preconditioner_arg_Ramp):
+      conjugategradient->SetPreconditioner(ConjugateGradientFilterType::RAMP);
+      break;
+    default:
+      conjugategradient->SetPreconditioner(ConjugateGradientFilterType::NONE);
+    }
 
   itk::TimeProbe readerProbe;
   if(args_info.time_flag)
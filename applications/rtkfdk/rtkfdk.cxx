@@ -22,6 +22,7 @@
 
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
 #include "rtkDisplacedDetectorForOffsetFieldOfViewImageFilter.h"
+#include "rtkFieldOfViewImageFilter.h"
 #include "rtkParkerShortScanImageFilter.h"
 #include "rtkFDKConeBeamReconstructionFilter.h"
 #ifdef RTK_USE_CUDA
@@ -43,6 +44,14 @@ int main(int argc, char * argv[])
 {
   GGO(rtkfdk, args_info);
 
+  // gengetopt has no unsigned option type, negative values would be wrapped
+  // around when passed to the filters
+  if(args_info.pipeline_arg < 0 || args_info.blocksize_arg < 1 || args_info.bricksize_arg < 0)
+    {
+    std::cerr << "--pipeline and --bricksize must be positive or zero and --blocksize strictly positive" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   typedef float OutputPixelType;
   const unsigned int Dimension = 3;
 
@@ -167,14 +176,55 @@ int main(int argc, char * argv[])
     {
     feldkamp = FDKCPUType::New();
     SET_FELDKAMP_OPTIONS( feldkamp );
+    feldkamp->SetPipelineDepth(args_info.pipeline_arg);
 
     // Motion compensated CBCT settings
     if(args_info.signal_given && args_info.dvf_given)
       {
+      // The warp backprojector ignores the options of the default backprojector
+      if(args_info.blocksize_arg != 1 || args_info.bricksize_arg != 0 || args_info.fovclip_flag ||
+         strcmp(args_info.interpolation_arg, "linear") )
+        {
+        std::cerr << "--blocksize, --bricksize, --fovclip and --interpolation are not supported with motion compensation" << std::endl;
+        return EXIT_FAILURE;
+        }
       dvfReader->SetFileName(args_info.dvf_arg);
       def->SetSignalFilename(args_info.signal_arg);
       feldkamp->SetBackProjectionFilter( bp.GetPointer() );
       }
+
+    // Backprojection options, set once the backprojector has been selected
+    feldkamp->GetBackProjectionFilter()->SetProjectionBlockSize(args_info.blocksize_arg);
+    feldkamp->GetBackProjectionFilter()->SetBrickSize(args_info.bricksize_arg);
+    if(!strcmp(args_info.interpolation_arg, "nearest") )
+      feldkamp->GetBackProjectionFilter()->SetInterpolation(FDKCPUType::BackProjectionFilterType::NEAREST);
+    else if(!strcmp(args_info.interpolation_arg, "cubic") )
+      feldkamp->GetBackProjectionFilter()->SetInterpolation(FDKCPUType::BackProjectionFilterType::BICUBIC);
+
+    // Cylindrical field of view, the largest disk is selected if the detector
+    // can be displaced as in rtk::FieldOfViewImageFilter
+    if(args_info.fovclip_flag)
+      {
+      typedef rtk::FieldOfViewImageFilter<OutputImageType, OutputImageType> FOVFilterType;
+      FOVFilterType::Pointer fov = FOVFilterType::New();
+      fov->SetGeometry( geometryReader->GetOutputObject() );
+      fov->SetProjectionsStack( reader->GetOutput() );
+      const FOVFilterType::FOVRadiusType types[3] = {FOVFilterType::RADIUSBOTH,
+                                                     FOVFilterType::RADIUSINF,
+                                                     FOVFilterType::RADIUSSUP};
+      double x, z, r, radius = -1.;
+      for(unsigned int t=0; t<(args_info.nodisplaced_flag?1:3); t++)
+        {
+        if( fov->ComputeFOVRadius(types[t], x, z, r) && r>radius )
+          {
+          radius = r;
+          feldkamp->GetBackProjectionFilter()->SetFOVCenterX(x);
+          feldkamp->GetBackProjectionFilter()->SetFOVCenterZ(z);
+          }
+        }
+      feldkamp->GetBackProjectionFilter()->SetFOVRadius(radius);
+      }
+
     pfeldkamp = feldkamp->GetOutput();
     }
 #ifdef RTK_USE_CUDA
@@ -25,6 +25,9 @@
 #include "rtkCudaForwardProjectionImageFilter.h"
 #endif
 #include "rtkRayCastInterpolatorForwardProjectionImageFilter.h"
+#include "rtkSiddonForwardProjectionImageFilter.h"
+#include "rtkRayCastForwardProjectionImageFilter.h"
+#include "rtkMipMapForwardProjectionImageFilter.h"
 
 #include <itkImageFileReader.h>
 #include <itkImageFileWriter.h>
@@ -106,10 +109,18 @@ int main(int argc, char * argv[])
     forwardProjection = rtk::CudaForwardProjectionImageFilter<OutputImageType, OutputImageType>::New();
     dynamic_cast<rtk::CudaForwardProjectionImageFilter<OutputImageType, OutputImageType>*>( forwardProjection.GetPointer() )->SetStepSize(args_info.step_arg);
 #else
-    std::cerr << "The program has not been compiled with cuda option" << std::endl;
-    return EXIT_FAILURE;
+    forwardProjection = rtk::RayCastForwardProjectionImageFilter<OutputImageType, OutputImageType>::New();
+    dynamic_cast<rtk::RayCastForwardProjectionImageFilter<OutputImageType, OutputImageType>*>( forwardProjection.GetPointer() )->SetStepSize(args_info.step_arg);
 #endif
     break;
+  case(fp_arg_Siddon):
+    forwardProjection = rtk::SiddonForwardProjectionImageFilter<OutputImageType, OutputImageType>::New();
+    break;
+  case(fp_arg_MipMap):
+    forwardProjection = rtk::MipMapForwardProjectionImageFilter<OutputImageType, OutputImageType>::New();
+    dynamic_cast<rtk::MipMapForwardProjectionImageFilter<OutputImageType, OutputImageType>*>( forwardProjection.GetPointer() )->SetStepSize(args_info.step_arg);
+    dynamic_cast<rtk::MipMapForwardProjectionImageFilter<OutputImageType, OutputImageType>*>( forwardProjection.GetPointer() )->SetNumberOfLevels(args_info.levels_arg);
+    break;
   default:
     std::cerr << "Unhandled --method value." << std::endl;
     return EXIT_FAILURE;
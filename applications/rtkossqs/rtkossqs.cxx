@@ -0,0 +1,124 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkossqs_ggo.h"
+#include "rtkGgoFunctions.h"
+
+#include "rtkThreeDCircularProjectionGeometryXMLFile.h"
+#include "rtkOSSQSConeBeamReconstructionFilter.h"
+
+#ifdef RTK_USE_CUDA
+  #include "itkCudaImage.h"
+#endif
+
+#include <itkImageFileWriter.h>
+
+int main(int argc, char * argv[])
+{
+  GGO(rtkossqs, args_info);
+
+  typedef float OutputPixelType;
+  const unsigned int Dimension = 3;
+
+#ifdef RTK_USE_CUDA
+  typedef itk::CudaImage< OutputPixelType, Dimension > OutputImageType;
+#else
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+#endif
+
+  // Projections reader
+  typedef rtk::ProjectionsReader< OutputImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  rtk::SetProjectionsReaderFromGgo<ReaderType, args_info_rtkossqs>(reader, args_info);
+
+  // Geometry
+  if(args_info.verbose_flag)
+    std::cout << "Reading geometry information from "
+              << args_info.geometry_arg
+              << "..."
+              << std::endl;
+  rtk::ThreeDCircularProjectionGeometryXMLFileReader::Pointer geometryReader;
+  geometryReader = rtk::ThreeDCircularProjectionGeometryXMLFileReader::New();
+  geometryReader->SetFilename(args_info.geometry_arg);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( geometryReader->GenerateOutputInformation() )
+
+  // Create input: either an existing volume read from a file or a blank image
+  itk::ImageSource< OutputImageType >::Pointer inputFilter;
+  if(args_info.input_given)
+    {
+    // Read an existing image to initialize the volume
+    typedef itk::ImageFileReader<  OutputImageType > InputReaderType;
+    InputReaderType::Pointer inputReader = InputReaderType::New();
+    inputReader->SetFileName( args_info.input_arg );
+    inputFilter = inputReader;
+    }
+  else
+    {
+    // Create new empty volume
+    typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+    ConstantImageSourceType::Pointer constantImageSource = ConstantImageSourceType::New();
+    rtk::SetConstantImageSourceFromGgo<ConstantImageSourceType, args_info_rtkossqs>(constantImageSource, args_info);
+    inputFilter = constantImageSource;
+    }
+
+  // OS-SQS reconstruction filter
+  rtk::OSSQSConeBeamReconstructionFilter< OutputImageType >::Pointer ossqs =
+      rtk::OSSQSConeBeamReconstructionFilter< OutputImageType >::New();
+
+  // Set the forward and back projection filters
+  ossqs->SetForwardProjectionFilter(args_info.fp_arg);
+  ossqs->SetBackProjectionFilter(args_info.bp_arg);
+  ossqs->SetInput( inputFilter->GetOutput() );
+  ossqs->SetInput(1, reader->GetOutput());
+  ossqs->SetGeometry( geometryReader->GetOutputObject() );
+  ossqs->SetNumberOfIterations( args_info.niterations_arg );
+  ossqs->SetNumberOfSubsets( args_info.nsubsets_arg );
+  ossqs->SetEnforcePositivity( args_info.positivity_flag );
+  ossqs->SetNesterovMomentum( args_info.nesterov_flag );
+  if(args_info.gammatv_given)
+    {
+    ossqs->SetPerformTVSpatialDenoising(true);
+    ossqs->SetGammaTV( args_info.gammatv_arg );
+    ossqs->SetTV_iterations( args_info.tviter_arg );
+    }
+
+  itk::TimeProbe totalTimeProbe;
+  if(args_info.time_flag)
+    {
+    std::cout << "Recording elapsed time... " << std::endl << std::flush;
+    totalTimeProbe.Start();
+    }
+
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( ossqs->Update() )
+
+  if(args_info.time_flag)
+    {
+    ossqs->PrintTiming(std::cout);
+    totalTimeProbe.Stop();
+    std::cout << "It took...  " << totalTimeProbe.GetMean() << ' ' << totalTimeProbe.GetUnit() << std::endl;
+    }
+
+  // Write
+  typedef itk::ImageFileWriter< OutputImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( args_info.output_arg );
+  writer->SetInput( ossqs->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() )
+
+  return EXIT_SUCCESS;
+}
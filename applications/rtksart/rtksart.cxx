@@ -23,6 +23,7 @@
 #include "rtkSARTConeBeamReconstructionFilter.h"
 #include "rtkNormalizedJosephBackProjectionImageFilter.h"
 #include "rtkPhaseGatingImageFilter.h"
+#include "rtkMultiResolutionConeBeamReconstructionFilter.h"
 
 #ifdef RTK_USE_CUDA
   #include "itkCudaImage.h"
@@ -34,6 +35,14 @@ int main(int argc, char * argv[])
 {
   GGO(rtksart, args_info);
 
+  // gengetopt has no unsigned option type, negative values would be wrapped
+  // around when passed to the filters
+  if(args_info.levels_arg < 1 || (args_info.coarseniterations_given && args_info.coarseniterations_arg < 1))
+    {
+    std::cerr << "--levels and --coarseniterations must be strictly positive" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   typedef float OutputPixelType;
   const unsigned int Dimension = 3;
 
@@ -92,29 +101,49 @@ int main(int argc, char * argv[])
     inputFilter = constantImageSource;
     }
 
-  // SART reconstruction filter
-  rtk::SARTConeBeamReconstructionFilter< OutputImageType >::Pointer sart =
-      rtk::SARTConeBeamReconstructionFilter< OutputImageType >::New();
-
-  // Set the forward and back projection filters
-  sart->SetForwardProjectionFilter(args_info.fp_arg);
-  sart->SetBackProjectionFilter(args_info.bp_arg);
-  sart->SetInput( inputFilter->GetOutput() );
-  if (args_info.signal_given)
+  // SART reconstruction filters, one per resolution level
+  typedef rtk::SARTConeBeamReconstructionFilter< OutputImageType > SARTType;
+  typedef rtk::MultiResolutionConeBeamReconstructionFilter< OutputImageType > MultiResolutionType;
+  MultiResolutionType::Pointer multires = MultiResolutionType::New();
+  multires->SetNumberOfLevels( args_info.levels_arg );
+  SARTType::Pointer sart;
+  for(int l=multires->GetNumberOfLevels()-1; l>=0; l--)
     {
-    sart->SetInput(1, phaseGating->GetOutput());
-    sart->SetGeometry( phaseGating->GetOutputGeometry() );
-    sart->SetGatingWeights( phaseGating->GetGatingWeightsOnSelectedProjections() );
+    sart = SARTType::New();
+
+    // Set the forward and back projection filters
+    sart->SetForwardProjectionFilter(args_info.fp_arg);
+    sart->SetBackProjectionFilter(args_info.bp_arg);
+    if (args_info.signal_given)
+      {
+      sart->SetGeometry( phaseGating->GetOutputGeometry() );
+      sart->SetGatingWeights( phaseGating->GetGatingWeightsOnSelectedProjections() );
+      }
+    else
+      sart->SetGeometry( geometryReader->GetOutputObject() );
+    if(l>0 && args_info.coarseniterations_given)
+      sart->SetNumberOfIterations( args_info.coarseniterations_arg );
+    else
+      sart->SetNumberOfIterations( args_info.niterations_arg );
+    sart->SetNumberOfProjectionsPerSubset( args_info.nprojpersubset_arg );
+    sart->SetLambda( args_info.lambda_arg );
+    sart->SetDisableDisplacedDetectorFilter(args_info.nodisplaced_flag);
+    sart->SetParallelSubsetProcessing(args_info.parallelsubset_flag);
+    sart->SetEnforcePositivity(args_info.positivity_flag);
+    if(multires->GetNumberOfLevels() > 1)
+      multires->SetReconstructionFilter(l, sart);
     }
+
+  // The last filter is the full resolution one, it is used directly with a
+  // single level
+  itk::ImageToImageFilter< OutputImageType, OutputImageType >::Pointer recon = sart.GetPointer();
+  if(multires->GetNumberOfLevels() > 1)
+    recon = multires.GetPointer();
+  recon->SetInput( inputFilter->GetOutput() );
+  if (args_info.signal_given)
+    recon->SetInput(1, phaseGating->GetOutput());
   else
-    {
-    sart->SetInput(1, reader->GetOutput());
-    sart->SetGeometry( geometryReader->GetOutputObject() );
-    }
-  sart->SetNumberOfIterations( args_info.niterations_arg );
-  sart->SetNumberOfProjectionsPerSubset( args_info.nprojpersubset_arg );
-  sart->SetLambda( args_info.lambda_arg );
-  sart->SetDisableDisplacedDetectorFilter(args_info.nodisplaced_flag);
+    recon->SetInput(1, reader->GetOutput());
 
   itk::TimeProbe totalTimeProbe;
   if(args_info.time_flag)
@@ -122,16 +151,22 @@ int main(int argc, char * argv[])
     std::cout << "Recording elapsed time... " << std::endl << std::flush;
     totalTimeProbe.Start();
     }
-  if(args_info.positivity_flag)
-    {
-    sart->SetEnforcePositivity(true);
-    }
 
-  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() )
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( recon->Update() )
 
   if(args_info.time_flag)
     {
-    sart->PrintTiming(std::cout);
+    if(multires->GetNumberOfLevels() > 1)
+      {
+      multires->PrintTiming(std::cout);
+      for(int l=multires->GetNumberOfLevels()-1; l>=0; l--)
+        {
+        std::cout << "Level " << l << ": ";
+        static_cast<SARTType *>( multires->GetReconstructionFilter(l) )->PrintTiming(std::cout);
+        }
+      }
+    else
+      sart->PrintTiming(std::cout);
     totalTimeProbe.Stop();
     std::cout << "It took...  " << totalTimeProbe.GetMean() << ' ' << totalTimeProbe.GetUnit() << std::endl;
     }
@@ -140,7 +175,7 @@ int main(int argc, char * argv[])
   typedef itk::ImageFileWriter< OutputImageType > WriterType;
   WriterType::Pointer writer = WriterType::New();
   writer->SetFileName( args_info.output_arg );
-  writer->SetInput( sart->GetOutput() );
+  writer->SetInput( recon->GetOutput() );
   TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() )
 
   return EXIT_SUCCESS;
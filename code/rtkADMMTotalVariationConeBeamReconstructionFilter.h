@@ -32,6 +32,7 @@
 #include "rtkThreeDCircularProjectionGeometry.h"
 #include "rtkDisplacedDetectorImageFilter.h"
 #include "rtkMultiplyByVectorImageFilter.h"
+#include "rtkExpressionImageFilter.h"
 
 namespace rtk
 {
@@ -78,8 +79,7 @@ namespace rtk
    * BackProjection [ label="rtk::BackProjectionImageFilter" URL="\ref rtk::BackProjectionImageFilter"];
    * AddGradient [ label="itk::AddImageFilter" URL="\ref itk::AddImageFilter"];
    * Divergence [ label="rtk::BackwardDifferenceDivergenceImageFilter" URL="\ref rtk::BackwardDifferenceDivergenceImageFilter"];
-   * Multiply [ label="itk::MultiplyImageFilter (by beta)" URL="\ref itk::MultiplyImageFilter"];
-   * SubtractVolume [ label="itk::SubtractImageFilter" URL="\ref itk::SubtractImageFilter"];
+   * SubtractVolume [ label="rtk::ExpressionImageFilter (- beta x)" URL="\ref rtk::ExpressionImageFilter"];
    * ConjugateGradient[ label="rtk::ConjugateGradientImageFilter" URL="\ref rtk::ConjugateGradientImageFilter"];
    * AfterConjugateGradient [label="", fixedsize="false", width=0, height=0, shape=none];
    * GradientTwo [ label="rtk::ForwardDifferenceGradientImageFilter" URL="\ref rtk::ForwardDifferenceGradientImageFilter"];
@@ -103,8 +103,7 @@ namespace rtk
    * AfterZeroMultiplyGradient -> AddGradient;
    * AfterZeroMultiplyGradient -> Subtract;
    * AddGradient -> Divergence [label="g_0 + d_0"];
-   * Divergence -> Multiply [label="-nabla_t(g_0 + d_0)"];
-   * Multiply -> SubtractVolume [label="-beta *nabla_t(g_0 + d_0)"];
+   * Divergence -> SubtractVolume [label="-nabla_t(g_0 + d_0)"];
    * BackProjection -> SubtractVolume [label="R_t p"];
    * SubtractVolume -> ConjugateGradient [label="b"];
    * ConjugateGradient -> AfterConjugateGradient [label="f_k+1"];
@@ -159,7 +158,10 @@ public:
         <TGradientOutputImage, TOutputImage>                                    ImageDivergenceFilterType;
     typedef rtk::SoftThresholdTVImageFilter
         <TGradientOutputImage>                                                  SoftThresholdTVFilterType;
-    typedef itk::SubtractImageFilter<TOutputImage>                              SubtractVolumeFilterType;
+    typedef rtk::Expression::Difference< rtk::Expression::Input<0>,
+                                         rtk::Expression::Product< rtk::Expression::Parameter<0>,
+                                                                   rtk::Expression::Input<1> > > SubtractVolumeExpressionType;
+    typedef rtk::ExpressionImageFilter<TOutputImage, SubtractVolumeExpressionType> SubtractVolumeFilterType;
     typedef itk::AddImageFilter<TGradientOutputImage>                           AddGradientsFilterType;
     typedef itk::MultiplyImageFilter<TOutputImage>                              MultiplyVolumeFilterType;
     typedef itk::MultiplyImageFilter<TGradientOutputImage>                      MultiplyGradientFilterType;
@@ -211,7 +213,6 @@ protected:
     /** Member pointers to the filters used internally (for convenience)*/
     typename SubtractGradientsFilterType::Pointer                               m_SubtractFilter1;
     typename SubtractGradientsFilterType::Pointer                               m_SubtractFilter2;
-    typename MultiplyVolumeFilterType::Pointer                                  m_MultiplyFilter;
     typename MultiplyVolumeFilterType::Pointer                                  m_ZeroMultiplyVolumeFilter;
     typename MultiplyGradientFilterType::Pointer                                m_ZeroMultiplyGradientFilter;
     typename ImageGradientFilterType::Pointer                                   m_GradientFilter1; 
@@ -42,7 +42,6 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
   m_ZeroMultiplyGradientFilter = MultiplyGradientFilterType::New();
   m_SubtractFilter1 = SubtractGradientsFilterType::New();
   m_SubtractFilter2 = SubtractGradientsFilterType::New();
-  m_MultiplyFilter = MultiplyVolumeFilterType::New();
   m_GradientFilter1 = ImageGradientFilterType::New();
   m_GradientFilter2 = ImageGradientFilterType::New();
   m_SubtractVolumeFilter = SubtractVolumeFilterType::New();
@@ -60,8 +59,7 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
   m_AddGradientsFilter->SetInput1(m_ZeroMultiplyGradientFilter->GetOutput());
   m_AddGradientsFilter->SetInput2(m_GradientFilter1->GetOutput());
   m_DivergenceFilter->SetInput(m_AddGradientsFilter->GetOutput());
-  m_MultiplyFilter->SetInput1( m_DivergenceFilter->GetOutput() );
-  m_SubtractVolumeFilter->SetInput2(m_MultiplyFilter->GetOutput());
+  m_SubtractVolumeFilter->SetInput(1, m_DivergenceFilter->GetOutput());
   m_ConjugateGradientFilter->SetB(m_SubtractVolumeFilter->GetOutput());
   m_ConjugateGradientFilter->SetNumberOfIterations(m_CG_iterations);
   m_GradientFilter2->SetInput(m_ConjugateGradientFilter->GetOutput());
@@ -83,7 +81,6 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
   m_GradientFilter1->ReleaseDataFlagOn();
   m_AddGradientsFilter->ReleaseDataFlagOn();
   m_DivergenceFilter->ReleaseDataFlagOn();
-  m_MultiplyFilter->ReleaseDataFlagOn();
   m_SubtractVolumeFilter->ReleaseDataFlagOn();
   m_ConjugateGradientFilter->ReleaseDataFlagOff(); // Output is f_k+1
   m_GradientFilter2->ReleaseDataFlagOn();
@@ -129,7 +126,7 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
 
   m_CGOperator->SetBeta(currentBeta);
   m_SoftThresholdFilter->SetThreshold(m_Alpha/(2 * currentBeta));
-  m_MultiplyFilter->SetConstant2( (const float) currentBeta);
+  m_SubtractVolumeFilter->SetParameter(0, currentBeta);
 }
 
 template< typename TOutputImage, typename TGradientOutputImage>
@@ -173,7 +170,7 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
   m_ZeroMultiplyVolumeFilter->SetInput1(this->GetInput(0));
   m_CGOperator->SetInput(1, this->GetInput(1));
   m_ConjugateGradientFilter->SetX(this->GetInput(0));
-  m_MultiplyFilter->SetConstant2( m_Beta );
+  m_SubtractVolumeFilter->SetParameter(0, m_Beta);
   if (m_IsGated)
     {
     // Insert the gating filter into the pipeline
@@ -195,7 +192,7 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
   // in the constructor, as m_BackProjectionFilter is set at runtime
   m_BackProjectionFilter->SetInput(0, m_ZeroMultiplyVolumeFilter->GetOutput());
   m_BackProjectionFilter->SetInput(1, m_DisplacedDetectorFilter->GetOutput());
-  m_SubtractVolumeFilter->SetInput1(m_BackProjectionFilter->GetOutput());
+  m_SubtractVolumeFilter->SetInput(0, m_BackProjectionFilter->GetOutput());
 
   // For the same reason, set geometry now
   m_CGOperator->SetGeometry(this->m_Geometry);
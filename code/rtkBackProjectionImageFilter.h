@@ -23,8 +23,11 @@
 
 #include <itkInPlaceImageFilter.h>
 #include <itkConceptChecking.h>
+#include <itkSimpleFastMutexLock.h>
 #include "rtkThreeDCircularProjectionGeometry.h"
 
+#include <vector>
+
 namespace rtk
 {
 
@@ -75,8 +78,39 @@ public:
   itkGetMacro(Transpose, bool);
   itkSetMacro(Transpose, bool);
 
+  /** Get / Set the number of projections backprojected in a tile of the
+   * output region before moving to the next tile. The default, 1,
+   * backprojects each projection in the whole region of a thread. Larger
+   * values keep the tile in cache while it accumulates the contributions of
+   * the block of projections, which divides the volume memory traffic by the
+   * block size. */
+  itkGetMacro(ProjectionBlockSize, unsigned int);
+  itkSetMacro(ProjectionBlockSize, unsigned int);
+
+  /** Get / Set the edge length, in voxels, of the cubic bricks of the output
+   * region which are handed dynamically to the threads. Neighboring bricks
+   * backprojected at the same time read overlapping windows of the
+   * projections which then remain in cache. The default, 0, splits the output
+   * region in one slab per thread. It is ignored by the subclasses which do
+   * not support bricks, see SupportsBricks. */
+  itkGetMacro(BrickSize, unsigned int);
+  itkSetMacro(BrickSize, unsigned int);
+
+  /** Get / Set the cylinder parallel to the y axis outside of which voxels
+   * are not backprojected, i.e., keep the value of input 0. The center (x,z)
+   * and the radius are in physical coordinates, typically computed with
+   * rtk::FieldOfViewImageFilter::ComputeFOVRadius. A negative radius
+   * (default) backprojects all voxels. */
+  itkGetMacro(FOVRadius, double);
+  itkSetMacro(FOVRadius, double);
+  itkGetMacro(FOVCenterX, double);
+  itkSetMacro(FOVCenterX, double);
+  itkGetMacro(FOVCenterZ, double);
+  itkSetMacro(FOVCenterZ, double);
+
 protected:
-  BackProjectionImageFilter() : m_Geometry(ITK_NULLPTR), m_Transpose(false) {
+  BackProjectionImageFilter() : m_Geometry(ITK_NULLPTR), m_Transpose(false), m_ProjectionBlockSize(1), m_BrickSize(0), m_NextBrick(0),
+    m_FOVRadius(-1.), m_FOVCenterX(0.), m_FOVCenterZ(0.) {
     this->SetNumberOfRequiredInputs(2); this->SetInPlace( true );
   };
   ~BackProjectionImageFilter() {}
@@ -88,6 +122,21 @@ protected:
 
   void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
 
+  /** Each thread gets the full requested region when bricks are used, the
+      bricks are then distributed in ThreadedGenerateData. */
+  unsigned int SplitRequestedRegion(unsigned int i, unsigned int num, OutputImageRegionType& splitRegion) ITK_OVERRIDE;
+
+  /** Whether the bricks are distributed to the threads, i.e., whether the
+      ThreadedGenerateData of this class is used. Subclasses which override
+      ThreadedGenerateData must return false, the output region is then split
+      in slabs whatever the BrickSize. */
+  virtual bool SupportsBricks() const { return true; }
+
+  /** Backprojects the input projections in one region of the output,
+      called by ThreadedGenerateData for the slab of the thread or for each
+      brick it processes. */
+  virtual void ThreadedBackprojection( const OutputImageRegionType& region, ThreadIdType threadId );
+
   /** Special case when the detector is cylindrical and centered on source */
   virtual void CylindricalDetectorCenteredOnSourceBackprojection(const OutputImageRegionType& region,
                                                                  const ProjectionMatrixType& volIndexToProjPP,
@@ -104,6 +153,22 @@ protected:
   virtual void OptimizedBackprojectionY(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
                                         const ProjectionImagePointer projection);
 
+  /** Version for any other geometry. The homogeneous projection coordinates
+    are updated incrementally along each row of the volume, i.e., one
+    division per voxel instead of a full matrix-vector product. */
+  virtual void ProjectiveBackprojection(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                                        const ProjectionImagePointer projection);
+
+  /** Splits the region of a thread in tiles small enough to remain in cache
+      while a block of m_ProjectionBlockSize projections is backprojected. */
+  void SplitRegionInProjectionBlockTiles(const OutputImageRegionType& region,
+                                         std::vector<OutputImageRegionType> &tiles) const;
+
+  /** Clips [begin, end) to the n such that the voxel at index first + n
+      along the axis dim is inside the FOV cylinder, if any. */
+  void ClipToFieldOfView(const typename TOutputImage::IndexType &first, const unsigned int dim,
+                         int &begin, int &end) const;
+
   /** The two inputs should not be in the same space so there is nothing
    * to verify. */
   void VerifyInputInformation() ITK_OVERRIDE {}
@@ -133,6 +198,21 @@ private:
   /** Flip projection flag: infludences GetProjection and
     GetIndexToIndexProjectionMatrix for optimization */
   bool m_Transpose;
+
+  /** Number of projections backprojected per tile */
+  unsigned int m_ProjectionBlockSize;
+
+  /** Bricks of the requested region, distributed to threads on demand */
+  unsigned int                       m_BrickSize;
+  std::vector<OutputImageRegionType> m_Bricks;
+  unsigned int                       m_NextBrick;
+  itk::SimpleFastMutexLock           m_BrickMutex;
+
+  /** FOV cylinder and index to physical point matrix of the output */
+  double m_FOVRadius;
+  double m_FOVCenterX;
+  double m_FOVCenterZ;
+  itk::Matrix<double, TOutputImage::ImageDimension+1, TOutputImage::ImageDimension+1> m_IndexToPhysicalPoint;
 };
 
 } // end namespace rtk
@@ -20,10 +20,12 @@
 #define rtkBackProjectionImageFilter_hxx
 
 #include "rtkHomogeneousMatrix.h"
+#include "rtkBackProjectionKernels.h"
 
 #include <itkImageRegionConstIterator.h>
 #include <itkImageRegionIteratorWithIndex.h>
-#include <itkLinearInterpolateImageFunction.h>
+
+#include <algorithm>
 
 namespace rtk
 {
@@ -58,7 +60,7 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
     }
 
   typename TInputImage::RegionType reqRegion = inputPtr1->GetLargestPossibleRegion();
-  if(m_Geometry.GetPointer() == ITK_NULLPTR || m_Geometry->GetRadiusCylindricalDetector() != 0 )
+  if(m_Geometry.GetPointer() == ITK_NULLPTR)
     {
     inputPtr1->SetRequestedRegion( inputPtr1->GetLargestPossibleRegion() );
     return;
@@ -77,10 +79,24 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
   const unsigned int nProj = this->GetInput(1)->GetLargestPossibleRegion().GetSize(Dimension-1);
   const unsigned int iFirstProj = this->GetInput(1)->GetLargestPossibleRegion().GetIndex(Dimension-1);
   this->SetTranspose(false);
+  const double radius = m_Geometry->GetRadiusCylindricalDetector();
+  itk::Matrix<double, Dimension, Dimension> projPPToProjIndex;
+  if(radius != 0)
+    projPPToProjIndex = GetProjectionPhysicalPointToProjectionIndexMatrix();
   for(unsigned int iProj=iFirstProj; iProj<iFirstProj+nProj; iProj++)
     {
-    // Extract the current slice
-    ProjectionMatrixType   matrix = GetIndexToIndexProjectionMatrix(iProj);
+    // Extract the current slice. With a cylindrical detector, the corners are
+    // first projected on the flat detector tangent to the cylinder in physical
+    // coordinates.
+    ProjectionMatrixType   matrix;
+    if(radius != 0)
+      matrix = GetVolumeIndexToProjectionPhysicalPointMatrix(iProj);
+    else
+      matrix = GetIndexToIndexProjectionMatrix(iProj);
+    itk::ContinuousIndex<double, Dimension-1> flatInf;
+    itk::ContinuousIndex<double, Dimension-1> flatSup;
+    flatInf.Fill( itk::NumericTraits<double>::max() );
+    flatSup.Fill( itk::NumericTraits<double>::NonpositiveMin() );
 
     // Check which part of the projection image will be backprojected in the
     // volume.
@@ -125,10 +141,44 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
           // Look for extremas on projection to calculate requested region
           for(int i=0; i<2; i++)
             {
-            cornerInf[i] = vnl_math_min(cornerInf[i], point[i]);
-            cornerSup[i] = vnl_math_max(cornerSup[i], point[i]);
+            flatInf[i] = vnl_math_min(flatInf[i], point[i]);
+            flatSup[i] = vnl_math_max(flatSup[i], point[i]);
             }
           }
+
+    if(radius == 0)
+      {
+      for(int i=0; i<2; i++)
+        {
+        cornerInf[i] = vnl_math_min(cornerInf[i], flatInf[i]);
+        cornerSup[i] = vnl_math_max(cornerSup[i], flatSup[i]);
+        }
+      continue;
+      }
+
+    // Map the bounding box on the flat detector onto the cylinder. The
+    // position along the arc is monotonic in the flat position, the height is
+    // the flat height multiplied by a cosine which is bounded over the box.
+    double ucInf = radius * atan(flatInf[0]/radius);
+    double ucSup = radius * atan(flatSup[0]/radius);
+    double cosInf = 1. / sqrt(1. + vnl_math_max(flatInf[0]*flatInf[0], flatSup[0]*flatSup[0])/(radius*radius));
+    double cosSup = 1.;
+    if(flatInf[0]>0. || flatSup[0]<0.)
+      cosSup = 1. / sqrt(1. + vnl_math_min(flatInf[0]*flatInf[0], flatSup[0]*flatSup[0])/(radius*radius));
+    double vcInf = vnl_math_min(flatInf[1]*cosInf, flatInf[1]*cosSup);
+    double vcSup = vnl_math_max(flatSup[1]*cosInf, flatSup[1]*cosSup);
+    for(int cv=0; cv<2; cv++)
+      for(int cu=0; cu<2; cu++)
+        {
+        const double uc = (cu)?ucSup:ucInf;
+        const double vc = (cv)?vcSup:vcInf;
+        for(int i=0; i<2; i++)
+          {
+          const double p = projPPToProjIndex[i][0] * uc + projPPToProjIndex[i][1] * vc + projPPToProjIndex[i][2];
+          cornerInf[i] = vnl_math_min(cornerInf[i], p);
+          cornerSup[i] = vnl_math_max(cornerSup[i], p);
+          }
+        }
     }
   reqRegion.SetIndex(0, vnl_math_floor(cornerInf[0]) );
   reqRegion.SetIndex(1, vnl_math_floor(cornerInf[1]) );
@@ -158,6 +208,46 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
                              << "Detector radius is " << radius
                              << ", should be " << this->m_Geometry->GetSourceToDetectorDistances()[0])
     }
+
+  m_IndexToPhysicalPoint = GetIndexToPhysicalPointMatrix<TOutputImage>(this->GetOutput());
+
+  // Split the requested region in bricks, x first so that consecutive bricks
+  // are neighbors
+  m_Bricks.clear();
+  m_NextBrick = 0;
+  if(m_BrickSize && SupportsBricks())
+    {
+    const OutputImageRegionType requested = this->GetOutput()->GetRequestedRegion();
+    OutputImageRegionType brick;
+    for(int k=requested.GetIndex(2); k<requested.GetIndex(2)+(int)requested.GetSize(2); k+=m_BrickSize)
+      {
+      brick.SetIndex(2, k);
+      brick.SetSize(2, std::min((int)m_BrickSize, requested.GetIndex(2)+(int)requested.GetSize(2)-k) );
+      for(int j=requested.GetIndex(1); j<requested.GetIndex(1)+(int)requested.GetSize(1); j+=m_BrickSize)
+        {
+        brick.SetIndex(1, j);
+        brick.SetSize(1, std::min((int)m_BrickSize, requested.GetIndex(1)+(int)requested.GetSize(1)-j) );
+        for(int i=requested.GetIndex(0); i<requested.GetIndex(0)+(int)requested.GetSize(0); i+=m_BrickSize)
+          {
+          brick.SetIndex(0, i);
+          brick.SetSize(0, std::min((int)m_BrickSize, requested.GetIndex(0)+(int)requested.GetSize(0)-i) );
+          m_Bricks.push_back(brick);
+          }
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+unsigned int
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::SplitRequestedRegion(unsigned int i, unsigned int num, OutputImageRegionType& splitRegion)
+{
+  if(!m_BrickSize || !SupportsBricks())
+    return Superclass::SplitRequestedRegion(i, num, splitRegion);
+
+  splitRegion = this->GetOutput()->GetRequestedRegion();
+  return num;
 }
 
 /**
@@ -167,16 +257,39 @@ template <class TInputImage, class TOutputImage>
 void
 BackProjectionImageFilter<TInputImage,TOutputImage>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
-                       ThreadIdType itkNotUsed(threadId) )
+                       ThreadIdType threadId)
+{
+  if(!m_BrickSize || !SupportsBricks())
+    {
+    ThreadedBackprojection(outputRegionForThread, threadId);
+    return;
+    }
+
+  // Process bricks until there is none left
+  for(;;)
+    {
+    m_BrickMutex.Lock();
+    const unsigned int iBrick = m_NextBrick++;
+    m_BrickMutex.Unlock();
+    if(iBrick >= m_Bricks.size())
+      break;
+    ThreadedBackprojection(m_Bricks[iBrick], threadId);
+    }
+}
+
+/**
+ * ThreadedBackprojection performs the accumulation
+ */
+template <class TInputImage, class TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::ThreadedBackprojection(const OutputImageRegionType& outputRegionForThread,
+                         ThreadIdType itkNotUsed(threadId) )
 {
   const unsigned int Dimension = TInputImage::ImageDimension;
   const unsigned int nProj = this->GetInput(1)->GetLargestPossibleRegion().GetSize(Dimension-1);
   const unsigned int iFirstProj = this->GetInput(1)->GetLargestPossibleRegion().GetIndex(Dimension-1);
 
-  // Create interpolator, could be any interpolation
-  typedef itk::LinearInterpolateImageFunction< ProjectionImageType, double > InterpolatorType;
-  typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
-
   // Iterators on volume input and output
   typedef itk::ImageRegionConstIterator<TInputImage> InputRegionIterator;
   InputRegionIterator itIn(this->GetInput(), outputRegionForThread);
@@ -196,66 +309,144 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
       }
     }
 
-  // Continuous index at which we interpolate
-  itk::ContinuousIndex<double, Dimension-1> pointProj;
-
-  // Go over each projection
-  for(unsigned int iProj=iFirstProj; iProj<iFirstProj+nProj; iProj++)
+  // Tiles of the thread region, the whole region if projections are not
+  // blocked
+  std::vector<OutputImageRegionType> tiles;
+  SplitRegionInProjectionBlockTiles(outputRegionForThread, tiles);
+
+  // Cylindrical detector centered on source case
+  const bool cylindrical = (m_Geometry->GetRadiusCylindricalDetector() != 0);
+  itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension> projPPToProjIndex;
+  if(cylindrical)
+    projPPToProjIndex = GetProjectionPhysicalPointToProjectionIndexMatrix();
+
+  // Go over each block of projections
+  const unsigned int blockSize = std::max(m_ProjectionBlockSize, 1u);
+  std::vector<ProjectionImagePointer> projections;
+  std::vector<ProjectionMatrixType> matrices;
+  for(unsigned int iBlock=iFirstProj; iBlock<iFirstProj+nProj; iBlock+=blockSize)
     {
-    // Extract the current slice
-    ProjectionImagePointer projection = GetProjection<ProjectionImageType>(iProj);
-
-    ProjectionMatrixType   matrix = GetIndexToIndexProjectionMatrix(iProj);
-    interpolator->SetInputImage(projection);
-
-    // Cylindrical detector centered on source case
-    if (m_Geometry->GetRadiusCylindricalDetector() != 0)
-      {
-      ProjectionMatrixType volIndexToProjPP = GetVolumeIndexToProjectionPhysicalPointMatrix(iProj);
-      itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension> projPPToProjIndex = GetProjectionPhysicalPointToProjectionIndexMatrix();
-      CylindricalDetectorCenteredOnSourceBackprojection( outputRegionForThread, volIndexToProjPP, projPPToProjIndex, projection);
-      continue;
-      }
-
-    // Optimized version
-    if (fabs(matrix[1][0])<1e-10 && fabs(matrix[2][0])<1e-10)
-      {
-      OptimizedBackprojectionX( outputRegionForThread, matrix, projection);
-      continue;
-      }
-    if (fabs(matrix[1][1])<1e-10 && fabs(matrix[2][1])<1e-10)
+    // Extract the slices and matrices of the block
+    const unsigned int nBlock = std::min(blockSize, iFirstProj+nProj-iBlock);
+    projections.resize(nBlock);
+    matrices.resize(nBlock);
+    for(unsigned int b=0; b<nBlock; b++)
       {
-      OptimizedBackprojectionY( outputRegionForThread, matrix, projection);
-      continue;
+      projections[b] = GetProjection<ProjectionImageType>(iBlock+b);
+      if(cylindrical)
+        matrices[b] = GetVolumeIndexToProjectionPhysicalPointMatrix(iBlock+b);
+      else
+        matrices[b] = GetIndexToIndexProjectionMatrix(iBlock+b);
       }
 
-    // Go over each voxel
-    itOut.GoToBegin();
-    while(!itOut.IsAtEnd() )
+    for(unsigned int t=0; t<tiles.size(); t++)
       {
-      // Compute projection index
-      for(unsigned int i=0; i<Dimension-1; i++)
+      for(unsigned int b=0; b<nBlock; b++)
         {
-        pointProj[i] = matrix[i][Dimension];
-        for(unsigned int j=0; j<Dimension; j++)
-          pointProj[i] += matrix[i][j] * itOut.GetIndex()[j];
-        }
+        const ProjectionMatrixType &matrix = matrices[b];
 
-      // Apply perspective
-      double perspFactor = matrix[Dimension-1][Dimension];
-      for(unsigned int j=0; j<Dimension; j++)
-        perspFactor += matrix[Dimension-1][j] * itOut.GetIndex()[j];
-      perspFactor = 1/perspFactor;
-      for(unsigned int i=0; i<Dimension-1; i++)
-        pointProj[i] = pointProj[i]*perspFactor;
+        if (cylindrical)
+          {
+          CylindricalDetectorCenteredOnSourceBackprojection( tiles[t], matrix, projPPToProjIndex, projections[b]);
+          continue;
+          }
 
-      // Interpolate if in projection
-      if( interpolator->IsInsideBuffer(pointProj) )
-        {
-        itOut.Set( itOut.Get() + interpolator->EvaluateAtContinuousIndex(pointProj) );
+        // Optimized version
+        if (fabs(matrix[1][0])<1e-10 && fabs(matrix[2][0])<1e-10)
+          {
+          OptimizedBackprojectionX( tiles[t], matrix, projections[b]);
+          continue;
+          }
+        if (fabs(matrix[1][1])<1e-10 && fabs(matrix[2][1])<1e-10)
+          {
+          OptimizedBackprojectionY( tiles[t], matrix, projections[b]);
+          continue;
+          }
+
+        // Any other geometry
+        ProjectiveBackprojection( tiles[t], matrix, projections[b]);
         }
+      }
+    }
+}
 
-      ++itOut;
+template <class TInputImage, class TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::ClipToFieldOfView(const typename TOutputImage::IndexType &first, const unsigned int dim,
+                    int &begin, int &end) const
+{
+  if(m_FOVRadius<0. || begin>=end)
+    return;
+
+  // Line of voxels in the (x,z) plane, x = x0 + n * dx and z = z0 + n * dz
+  const unsigned int Dimension = TOutputImage::ImageDimension;
+  double x0 = m_IndexToPhysicalPoint[0][Dimension] - m_FOVCenterX;
+  double z0 = m_IndexToPhysicalPoint[2][Dimension] - m_FOVCenterZ;
+  for(unsigned int j=0; j<Dimension; j++)
+    {
+    x0 += m_IndexToPhysicalPoint[0][j] * first[j];
+    z0 += m_IndexToPhysicalPoint[2][j] * first[j];
+    }
+  const double dx = m_IndexToPhysicalPoint[0][dim];
+  const double dz = m_IndexToPhysicalPoint[2][dim];
+
+  // Solve a n^2 + b n + c <= 0
+  const double a = dx*dx + dz*dz;
+  const double b = 2.*(x0*dx + z0*dz);
+  const double c = x0*x0 + z0*z0 - m_FOVRadius*m_FOVRadius;
+  if(a<1e-12)
+    {
+    if(c>0.)
+      end = begin;
+    return;
+    }
+  const double delta = b*b - 4.*a*c;
+  if(delta<0.)
+    {
+    end = begin;
+    return;
+    }
+  const double sqrtDelta = sqrt(delta);
+  const double lo = std::max(std::ceil( (-b-sqrtDelta) / (2.*a) ), (double)begin);
+  const double hi = std::min(std::floor( (-b+sqrtDelta) / (2.*a) ) + 1., (double)end);
+  if(lo>=hi)
+    {
+    end = begin;
+    return;
+    }
+  begin = (int)lo;
+  end = (int)hi;
+}
+
+template <class TInputImage, class TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::SplitRegionInProjectionBlockTiles(const OutputImageRegionType& region,
+                                    std::vector<OutputImageRegionType> &tiles) const
+{
+  tiles.clear();
+  if(m_ProjectionBlockSize<2)
+    {
+    tiles.push_back(region);
+    return;
+    }
+
+  // Tiles are made of complete rows of a slice and contain at most
+  // maxTileVoxels voxels (at least one row), i.e., about 32 kB in single
+  // precision
+  const unsigned int maxTileVoxels = 8192;
+  const unsigned int nRows = std::max(maxTileVoxels / std::max((unsigned int)region.GetSize(0), 1u), 1u);
+  OutputImageRegionType tile = region;
+  tile.SetSize(2, 1);
+  for(int k=region.GetIndex(2); k<region.GetIndex(2)+(int)region.GetSize(2); k++)
+    {
+    tile.SetIndex(2, k);
+    for(int j=region.GetIndex(1); j<region.GetIndex(1)+(int)region.GetSize(1); j+=nRows)
+      {
+      tile.SetIndex(1, j);
+      tile.SetSize(1, std::min((int)nRows, region.GetIndex(1)+(int)region.GetSize(1)-j) );
+      tiles.push_back(tile);
       }
     }
 }
@@ -268,63 +459,132 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
                                                     const itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension>& projPPToProjIndex,
                                                     const ProjectionImagePointer projection)
 {
-  typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
-  OutputRegionIterator itOut(this->GetOutput(), region);
-
-  const unsigned int Dimension = TInputImage::ImageDimension;
+  typename ProjectionImageType::SizeType pSize = projection->GetBufferedRegion().GetSize();
+  typename ProjectionImageType::IndexType pIndex = projection->GetBufferedRegion().GetIndex();
+  typename TOutputImage::SizeType vBufferSize = this->GetOutput()->GetBufferedRegion().GetSize();
+  typename TOutputImage::IndexType vBufferIndex = this->GetOutput()->GetBufferedRegion().GetIndex();
+  typename TInputImage::PixelType *pProj;
+  typename TOutputImage::PixelType *pVol, *pVolZeroPointer;
 
-  // Create interpolator, could be any interpolation
-  typedef itk::LinearInterpolateImageFunction< ProjectionImageType, double > InterpolatorType;
-  typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
-  interpolator->SetInputImage(projection);
+  // Pointers in memory to index (0,0,0) which do not necessarily exist
+  pVolZeroPointer = this->GetOutput()->GetBufferPointer();
+  pVolZeroPointer -= vBufferIndex[0] + vBufferSize[0] * (vBufferIndex[1] + vBufferSize[1] * vBufferIndex[2]);
 
-  // Get radius of the cylindrical detector
-  double radius = m_Geometry->GetRadiusCylindricalDetector();
+  // Shortcuts
+  const ProjectionMatrixType &m = volIndexToProjPP;
+  const itk::Matrix<double, TInputImage::ImageDimension, TInputImage::ImageDimension> &a = projPPToProjIndex;
+  const double radius = m_Geometry->GetRadiusCylindricalDetector();
+  const double invRadius = 1./radius;
 
-  // Continuous index at which we interpolate
-  itk::ContinuousIndex<double, Dimension-1> pointProj, pointProjIdx;
+  // Physical coordinates on the flat detector, on the cylindrical detector and
+  // continuous index at which we interpolate
+  double uh, vh, wh, uf, vf, uc, vc;
+  double u, v, du, dv;
+  int    ui, vi;
 
-  // Go over each voxel
-  itOut.GoToBegin();
-  while(!itOut.IsAtEnd() )
+  // If the position along the arc of the cylinder does not depend on j, the
+  // mapping onto the cylinder is computed once per column and the projection
+  // indices are affine along the column
+  if(fabs(m[0][1])<1e-10 && fabs(m[2][1])<1e-10)
     {
-    // Compute projection index
-    for(unsigned int i=0; i<Dimension-1; i++)
+    for(int k=region.GetIndex(2); k<region.GetIndex(2)+(int)region.GetSize(2); k++)
       {
-      pointProj[i] = volIndexToProjPP[i][Dimension];
-      for(unsigned int j=0; j<Dimension; j++)
-        pointProj[i] += volIndexToProjPP[i][j] * itOut.GetIndex()[j];
-      }
-
-    // Apply perspective
-    double perspFactor = volIndexToProjPP[Dimension-1][Dimension];
-    for(unsigned int j=0; j<Dimension; j++)
-      perspFactor += volIndexToProjPP[Dimension-1][j] * itOut.GetIndex()[j];
-    perspFactor = 1/perspFactor;
-    for(unsigned int i=0; i<Dimension-1; i++)
-      pointProj[i] = pointProj[i]*perspFactor;
-
-    // Apply correction for cylindrical centered on source
-    const double u = pointProj[0];
-    pointProj[0] = radius * atan(u / radius);
-    pointProj[1] = pointProj[1] * radius / sqrt(radius * radius + u * u);
-
-    // Convert to projection index
-    for(unsigned int i=0; i<Dimension-1; i++)
-      {
-      pointProjIdx[i] = projPPToProjIndex[i][Dimension-1];
-      for(unsigned int j=0; j<Dimension-1; j++)
-        pointProjIdx[i] += projPPToProjIndex[i][j] * pointProj[j];
-      }
+      for(int i=region.GetIndex(0); i<region.GetIndex(0)+(int)region.GetSize(0); i++)
+        {
+        int j = region.GetIndex(1);
+        uh = m[0][0] * i +                m[0][2] * k + m[0][3];
+        vh = m[1][0] * i + m[1][1] * j + m[1][2] * k + m[1][3];
+        wh = m[2][0] * i +                m[2][2] * k + m[2][3];
+
+        // Apply perspective and map onto the cylinder
+        wh = 1/wh;
+        uf = uh*wh;
+        vf = vh*wh;
+        const double cosine = 1. / sqrt(1. + uf*uf*invRadius*invRadius);
+        uc = radius * atan(uf*invRadius);
+        vc = vf * cosine;
+        const double dvc = m[1][1] * wh * cosine;
+
+        // Convert to projection index
+        u = a[0][0] * uc + a[0][1] * vc + a[0][2] - pIndex[0];
+        v = a[1][0] * uc + a[1][1] * vc + a[1][2] - pIndex[1];
+        du = a[0][1] * dvc;
+        dv = a[1][1] * dvc;
+
+        // Voxels of the column inside the detector and the FOV
+        int nBegin = 0;
+        int nEnd = region.GetSize(1);
+        ClipBackProjectionInterval(u, du, (int)pSize[0]-1, nBegin, nEnd);
+        ClipBackProjectionInterval(v, dv, (int)pSize[1]-1, nBegin, nEnd);
+        typename TOutputImage::IndexType first = {{i, j, k}};
+        this->ClipToFieldOfView(first, 1, nBegin, nEnd);
+
+        // Innermost loop, the clamping of the indices only guards against
+        // rounding differences with ClipBackProjectionInterval
+        pVol = pVolZeroPointer + i + vBufferSize[0] * (j + nBegin + k * vBufferSize[1] );
+        for(int n=nBegin; n<nEnd; n++, pVol += vBufferSize[0])
+          {
+          const double un = u + n * du;
+          const double vn = v + n * dv;
+          ui = std::min(std::max(vnl_math_floor(un), 0), (int)pSize[0]-2);
+          vi = std::min(std::max(vnl_math_floor(vn), 0), (int)pSize[1]-2);
+          pProj = projection->GetBufferPointer() + vi * pSize[0] + ui;
+          const double u1 = un-ui;
+          const double u2 = 1.0-u1;
+          const double v1 = vn-vi;
+          const double v2 = 1.0-v1;
+          *pVol += v2 * (u2 * *(pProj)          + u1 * *(pProj+1) ) +
+                   v1 * (u2 * *(pProj+pSize[0]) + u1 * *(pProj+pSize[0]+1) );
+          } //j
+        } //i
+      } //k
+    return;
+    }
 
-    // Interpolate if in projection
-    if( interpolator->IsInsideBuffer(pointProjIdx) )
+  // Any other geometry, the homogeneous coordinates are updated incrementally
+  // along the rows and mapped onto the cylinder for each voxel
+  for(int k=region.GetIndex(2); k<region.GetIndex(2)+(int)region.GetSize(2); k++)
+    {
+    for(int j=region.GetIndex(1); j<region.GetIndex(1)+(int)region.GetSize(1); j++)
       {
-      itOut.Set( itOut.Get() + interpolator->EvaluateAtContinuousIndex(pointProjIdx) );
-      }
-
-    ++itOut;
-    }
+      // Voxels of the row inside the FOV
+      int nBegin = 0;
+      int nEnd = region.GetSize(0);
+      typename TOutputImage::IndexType first = {{region.GetIndex(0), j, k}};
+      this->ClipToFieldOfView(first, 0, nBegin, nEnd);
+
+      int i = region.GetIndex(0) + nBegin;
+      uh = m[0][0] * i + m[0][1] * j + m[0][2] * k + m[0][3];
+      vh = m[1][0] * i + m[1][1] * j + m[1][2] * k + m[1][3];
+      wh = m[2][0] * i + m[2][1] * j + m[2][2] * k + m[2][3];
+      pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
+      for(; i<region.GetIndex(0)+nEnd; i++, uh += m[0][0], vh += m[1][0], wh += m[2][0], pVol++)
+        {
+        // Apply perspective and map onto the cylinder
+        const double w = 1/wh;
+        uf = uh*w;
+        vf = vh*w;
+        uc = radius * atan(uf*invRadius);
+        vc = vf / sqrt(1. + uf*uf*invRadius*invRadius);
+
+        // Convert to projection index
+        u = a[0][0] * uc + a[0][1] * vc + a[0][2] - pIndex[0];
+        v = a[1][0] * uc + a[1][1] * vc + a[1][2] - pIndex[1];
+        ui = vnl_math_floor(u);
+        vi = vnl_math_floor(v);
+        if(ui>=0 && ui<(int)pSize[0]-1 && vi>=0 && vi<(int)pSize[1]-1)
+          {
+          pProj = projection->GetBufferPointer() + vi * pSize[0] + ui;
+          const double u1 = u-ui;
+          const double u2 = 1.0-u1;
+          const double v1 = v-vi;
+          const double v2 = 1.0-v1;
+          *pVol += v2 * (u2 * *(pProj)          + u1 * *(pProj+1) ) +
+                   v1 * (u2 * *(pProj+pSize[0]) + u1 * *(pProj+pSize[0]+1) );
+          }
+        } //i
+      } //j
+    } //k
 }
 
 
@@ -372,20 +632,26 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
         v1 = v-vi;
         v2 = 1.0-v1;
 
+        // Voxels of the row inside the detector and the FOV
+        int nBegin = 0;
+        int nEnd = region.GetSize(0);
+        ClipBackProjectionInterval(u, du, (int)pSize[0]-1, nBegin, nEnd);
+        typename TOutputImage::IndexType first = {{i, j, k}};
+        this->ClipToFieldOfView(first, 0, nBegin, nEnd);
+
         pProj = projection->GetBufferPointer() + vi * pSize[0];
-        pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
+        pVol = pVolZeroPointer + i + nBegin + vBufferSize[0] * (j + k * vBufferSize[1] );
 
-        // Innermost loop
-        for(; i<(region.GetIndex(0) + (int)region.GetSize(0)); i++, u += du, pVol++)
+        // Innermost loop, the clamping of ui only guards against rounding
+        // differences with ClipBackProjectionInterval
+        for(int n=nBegin; n<nEnd; n++, pVol++)
           {
-          ui = vnl_math_floor(u);
-          if(ui>=0 && ui<(int)pSize[0]-1)
-            {
-            u1 = u-ui;
-            u2 = 1.0-u1;
-            *pVol += v2 * (u2 * *(pProj+ui)          + u1 * *(pProj+ui+1) ) +
-                     v1 * (u2 * *(pProj+ui+pSize[0]) + u1 * *(pProj+ui+pSize[0]+1) );
-            }
+          const double un = u + n * du;
+          ui = std::min(std::max(vnl_math_floor(un), 0), (int)pSize[0]-2);
+          u1 = un-ui;
+          u2 = 1.0-u1;
+          *pVol += v2 * (u2 * *(pProj+ui)          + u1 * *(pProj+ui+1) ) +
+                   v1 * (u2 * *(pProj+ui+pSize[0]) + u1 * *(pProj+ui+pSize[0]+1) );
           } //i
         }
       } //j
@@ -432,27 +698,102 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
       vi = vnl_math_floor(v);
       if(vi>=0 && vi<(int)pSize[1]-1)
         {
-        pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
-        for(; j<(region.GetIndex(1) + (int)region.GetSize(1)); j++, pVol += vBufferSize[0], u += du)
+        double u1, u2, v1, v2;
+        v1 = v-vi;
+        v2 = 1.0-v1;
+
+        // Voxels of the column inside the detector and the FOV
+        int nBegin = 0;
+        int nEnd = region.GetSize(1);
+        ClipBackProjectionInterval(u, du, (int)pSize[0]-1, nBegin, nEnd);
+        typename TOutputImage::IndexType first = {{i, j, k}};
+        this->ClipToFieldOfView(first, 1, nBegin, nEnd);
+
+        pProj = projection->GetBufferPointer() + vi * pSize[0];
+        pVol = pVolZeroPointer + i + vBufferSize[0] * (j + nBegin + k * vBufferSize[1] );
+        for(int n=nBegin; n<nEnd; n++, pVol += vBufferSize[0])
           {
-          ui = vnl_math_floor(u);
-          if(ui>=0 && ui<(int)pSize[0]-1)
-            {
-            double u1, u2, v1, v2;
-            pProj = projection->GetBufferPointer() + vi * pSize[0] + ui;
-            v1 = v-vi;
-            v2 = 1.0-v1;
-            u1 = u-ui;
-            u2 = 1.0-u1;
-            *pVol += v2 * (u2 * *(pProj)          + u1 * *(pProj+1) ) +
-                     v1 * (u2 * *(pProj+pSize[0]) + u1 * *(pProj+pSize[0]+1) );
-            }
+          const double un = u + n * du;
+          ui = std::min(std::max(vnl_math_floor(un), 0), (int)pSize[0]-2);
+          u1 = un-ui;
+          u2 = 1.0-u1;
+          *pVol += v2 * (u2 * *(pProj+ui)          + u1 * *(pProj+ui+1) ) +
+                   v1 * (u2 * *(pProj+ui+pSize[0]) + u1 * *(pProj+ui+pSize[0]+1) );
           } //j
         }
       } //i
     } //k
 }
 
+template <class TInputImage, class TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::ProjectiveBackprojection(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                           const ProjectionImagePointer projection)
+{
+  typename ProjectionImageType::SizeType pSize = projection->GetBufferedRegion().GetSize();
+  typename ProjectionImageType::IndexType pIndex = projection->GetBufferedRegion().GetIndex();
+  typename TOutputImage::SizeType vBufferSize = this->GetOutput()->GetBufferedRegion().GetSize();
+  typename TOutputImage::IndexType vBufferIndex = this->GetOutput()->GetBufferedRegion().GetIndex();
+  typename TInputImage::PixelType *pProj;
+  typename TOutputImage::PixelType *pVol, *pVolZeroPointer;
+
+  // Pointers in memory to index (0,0,0) which do not necessarily exist
+  pVolZeroPointer = this->GetOutput()->GetBufferPointer();
+  pVolZeroPointer -= vBufferIndex[0] + vBufferSize[0] * (vBufferIndex[1] + vBufferSize[1] * vBufferIndex[2]);
+
+  // Continuous index at which we interpolate, the homogeneous coordinates are
+  // updated incrementally along i
+  double uh, vh, wh;
+  double u, v, w;
+  int    ui, vi;
+
+  for(int k=region.GetIndex(2); k<region.GetIndex(2)+(int)region.GetSize(2); k++)
+    {
+    for(int j=region.GetIndex(1); j<region.GetIndex(1)+(int)region.GetSize(1); j++)
+      {
+      // Voxels of the row inside the FOV
+      int nBegin = 0;
+      int nEnd = region.GetSize(0);
+      typename TOutputImage::IndexType first = {{region.GetIndex(0), j, k}};
+      this->ClipToFieldOfView(first, 0, nBegin, nEnd);
+      const int iEnd = region.GetIndex(0) + nEnd;
+
+      int i = region.GetIndex(0) + nBegin;
+      uh = matrix[0][0] * i + matrix[0][1] * j + matrix[0][2] * k + matrix[0][3];
+      vh = matrix[1][0] * i + matrix[1][1] * j + matrix[1][2] * k + matrix[1][3];
+      wh = matrix[2][0] * i + matrix[2][1] * j + matrix[2][2] * k + matrix[2][3];
+      pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
+
+      // Innermost loop
+      for(; i<iEnd; i++, pVol++)
+        {
+        //Apply perspective
+        w = 1/wh;
+        u = uh*w-pIndex[0];
+        v = vh*w-pIndex[1];
+        uh += matrix[0][0];
+        vh += matrix[1][0];
+        wh += matrix[2][0];
+
+        ui = vnl_math_floor(u);
+        vi = vnl_math_floor(v);
+        if(ui>=0 && ui<(int)pSize[0]-1 && vi>=0 && vi<(int)pSize[1]-1)
+          {
+          double u1, u2, v1, v2;
+          pProj = projection->GetBufferPointer() + vi * pSize[0] + ui;
+          v1 = v-vi;
+          v2 = 1.0-v1;
+          u1 = u-ui;
+          u2 = 1.0-u1;
+          *pVol += v2 * (u2 * *(pProj)          + u1 * *(pProj+1) ) +
+                   v1 * (u2 * *(pProj+pSize[0]) + u1 * *(pProj+pSize[0]+1) );
+          }
+        } //i
+      } //j
+    } //k
+}
+
 template <class TInputImage, class TOutputImage>
 template <class TProjectionImage>
 typename TProjectionImage::Pointer
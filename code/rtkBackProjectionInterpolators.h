@@ -0,0 +1,222 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkBackProjectionInterpolators_h
+#define rtkBackProjectionInterpolators_h
+
+#include "rtkBackProjectionKernels.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace rtk
+{
+
+namespace Functor
+{
+
+/** \class NearestBackProjectionInterpolation
+ * \brief Nearest neighbor interpolation in a projection for the voxel-based
+ * backprojection.
+ *
+ * The backprojection interpolators share the same interface. The static
+ * functions LowerBound and UpperMargin give the interval
+ * [LowerBound, size-UpperMargin) of continuous indices (relative to the first
+ * pixel of the buffer) where the interpolation is possible along each
+ * dimension. The constructor prepares the interpolation in the row at
+ * continuous index v, the call operator interpolates at continuous index u of
+ * that row. Both indices must be in the valid interval; the computed pixel
+ * indices are clamped to guard against rounding errors only. The static
+ * functions BackProjectPacket and BackProjectProjectivePacket call a SIMD
+ * kernel with the same interpolation if available, see rtkBackProjectionKernels.h.
+ *
+ * \ingroup Functions
+ */
+template< class TPixel >
+class NearestBackProjectionInterpolation
+{
+public:
+  static double LowerBound() { return -0.5; }
+  static double UpperMargin() { return 0.5; }
+
+  NearestBackProjectionInterpolation(const TPixel *projection, const int size0, const int size1, const double v):
+    m_Size0(size0)
+  {
+    const int vi = std::min(std::max( (int)std::floor(v+0.5), 0), size1-1);
+    m_Row = projection + vi * size0;
+  }
+
+  inline double operator()(const double u) const
+  {
+    const int ui = std::min(std::max( (int)std::floor(u+0.5), 0), m_Size0-1);
+    return m_Row[ui];
+  }
+
+  template <class TVolumePixel>
+  static bool BackProjectPacket(TVolumePixel *, const std::ptrdiff_t, const unsigned int, const TPixel *,
+                                const int, const int, const float *, const float *, const float *, const float *)
+  {
+    return false;
+  }
+
+  template <class TVolumePixel>
+  static bool BackProjectProjectivePacket(TVolumePixel *, const std::ptrdiff_t, const unsigned int, const TPixel *,
+                                          const int, const int, const float *, const float *, const float *,
+                                          const float *, const float *, const float *)
+  {
+    return false;
+  }
+
+private:
+  const TPixel *m_Row;
+  const int     m_Size0;
+};
+
+/** \class BilinearBackProjectionInterpolation
+ * \brief Bilinear interpolation in a projection for the voxel-based
+ * backprojection.
+ *
+ * See NearestBackProjectionInterpolation for the interface.
+ *
+ * \ingroup Functions
+ */
+template< class TPixel >
+class BilinearBackProjectionInterpolation
+{
+public:
+  static double LowerBound() { return 0.; }
+  static double UpperMargin() { return 1.; }
+
+  BilinearBackProjectionInterpolation(const TPixel *projection, const int size0, const int size1, const double v):
+    m_Size0(size0)
+  {
+    const int vi = std::min(std::max( (int)std::floor(v), 0), size1-2);
+    m_V1 = v-vi;
+    m_V2 = 1.0-m_V1;
+    m_Row = projection + vi * size0;
+  }
+
+  inline double operator()(const double u) const
+  {
+    const int ui = std::min(std::max( (int)std::floor(u), 0), m_Size0-2);
+    const double u1 = u-ui;
+    const double u2 = 1.0-u1;
+    const TPixel *p = m_Row + ui;
+    return m_V2 * (u2 * p[0]       + u1 * p[1] ) +
+           m_V1 * (u2 * p[m_Size0] + u1 * p[m_Size0+1] );
+  }
+
+  template <class TVolumePixel>
+  static bool BackProjectPacket(TVolumePixel *pVol, const std::ptrdiff_t volStride, const unsigned int nSteps,
+                                const TPixel *pProj, const int pSize0, const int pSize1,
+                                const float *u, const float *du, const float *v, const float *w)
+  {
+    return BackProjectBilinearPacket(pVol, volStride, nSteps, pProj, pSize0, pSize1, u, du, v, w);
+  }
+
+  template <class TVolumePixel>
+  static bool BackProjectProjectivePacket(TVolumePixel *pVol, const std::ptrdiff_t volStride, const unsigned int nSteps,
+                                          const TPixel *pProj, const int pSize0, const int pSize1,
+                                          const float *uh, const float *vh, const float *wh,
+                                          const float *duh, const float *dvh, const float *dwh)
+  {
+    return BackProjectBilinearProjectivePacket(pVol, volStride, nSteps, pProj, pSize0, pSize1,
+                                               uh, vh, wh, duh, dvh, dwh);
+  }
+
+private:
+  const TPixel *m_Row;
+  const int     m_Size0;
+  double        m_V1;
+  double        m_V2;
+};
+
+/** \class BicubicBackProjectionInterpolation
+ * \brief Bicubic interpolation in a projection for the voxel-based
+ * backprojection, using the cubic convolution kernel of [Keys, IEEE TASSP,
+ * 1981] with a=-0.5. The 4x4 neighborhood of each interpolated location must
+ * be in the projection.
+ *
+ * See NearestBackProjectionInterpolation for the interface.
+ *
+ * \ingroup Functions
+ */
+template< class TPixel >
+class BicubicBackProjectionInterpolation
+{
+public:
+  static double LowerBound() { return 1.; }
+  static double UpperMargin() { return 2.; }
+
+  BicubicBackProjectionInterpolation(const TPixel *projection, const int size0, const int size1, const double v):
+    m_Size0(size0)
+  {
+    const int vi = std::min(std::max( (int)std::floor(v), 1), size1-3);
+    Weights(v-vi, m_WeightsV);
+    m_Row = projection + (vi-1) * size0;
+  }
+
+  inline double operator()(const double u) const
+  {
+    const int ui = std::min(std::max( (int)std::floor(u), 1), m_Size0-3);
+    double wu[4];
+    Weights(u-ui, wu);
+    const TPixel *p = m_Row + ui - 1;
+    double result = 0.;
+    for(unsigned int j=0; j<4; j++, p+=m_Size0)
+      result += m_WeightsV[j] * (wu[0]*p[0] + wu[1]*p[1] + wu[2]*p[2] + wu[3]*p[3]);
+    return result;
+  }
+
+  template <class TVolumePixel>
+  static bool BackProjectPacket(TVolumePixel *, const std::ptrdiff_t, const unsigned int, const TPixel *,
+                                const int, const int, const float *, const float *, const float *, const float *)
+  {
+    return false;
+  }
+
+  template <class TVolumePixel>
+  static bool BackProjectProjectivePacket(TVolumePixel *, const std::ptrdiff_t, const unsigned int, const TPixel *,
+                                          const int, const int, const float *, const float *, const float *,
+                                          const float *, const float *, const float *)
+  {
+    return false;
+  }
+
+private:
+  /** Weights of the pixels at -1, 0, 1 and 2 for a fractional part t */
+  static inline void Weights(const double t, double w[4])
+  {
+    const double t2 = t*t;
+    const double t3 = t2*t;
+    w[0] = -0.5*t3 +     t2 - 0.5*t;
+    w[1] =  1.5*t3 - 2.5*t2 + 1.;
+    w[2] = -1.5*t3 + 2.0*t2 + 0.5*t;
+    w[3] =  0.5*t3 - 0.5*t2;
+  }
+
+  const TPixel *m_Row;
+  const int     m_Size0;
+  double        m_WeightsV[4];
+};
+
+} // end namespace Functor
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,66 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkBackProjectionKernels.h"
+
+#ifdef RTK_USE_AVX2
+# if defined(_MSC_VER)
+#  include <intrin.h>
+# endif
+
+namespace
+{
+
+// Checks that the CPU and the operating system support AVX2 and FMA
+bool CPUSupportsAVX2()
+{
+# if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if(info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  const bool fma     = (info[2] & (1<<12)) != 0;
+  const bool osxsave = (info[2] & (1<<27)) != 0;
+  if(!fma || !osxsave)
+    return false;
+  if((_xgetbv(0) & 6) != 6) // XMM and YMM states saved by the OS
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1<<5)) != 0;
+# elif defined(__GNUC__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+# else
+  return false;
+# endif
+}
+
+}
+#endif
+
+bool
+rtk::IsAVX2BackProjectionAvailable()
+{
+#ifdef RTK_USE_AVX2
+  static const bool available = CPUSupportsAVX2();
+  return available;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,239 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkBackProjectionKernels_h
+#define rtkBackProjectionKernels_h
+
+#include "rtkWin32Header.h"
+
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+namespace rtk
+{
+
+/** Number of voxels processed simultaneously by the SIMD backprojection kernels. */
+const unsigned int BackProjectionPacketSize = 8;
+
+//--------------------------------------------------------------------
+/** \brief Clips the interval [begin, end) to the integers n for which the
+ * coordinate u0+n*du is in [0, uMax), i.e., to the voxels of a row whose
+ * projection falls inside the detector. The result is empty (begin==end) if
+ * no such n exists.
+ *
+ * \ingroup Functions
+ */
+inline void
+ClipBackProjectionInterval(const double u0, const double du, const double uMax, int &begin, int &end)
+{
+  if(begin>=end)
+    return;
+  if(du==0.)
+    {
+    if( !(u0>=0. && u0<uMax) )
+      end = begin;
+    return;
+    }
+
+  // Analytic bounds, slightly enlarged and clamped to the interval
+  double lo = -u0/du;
+  double hi = (uMax-u0)/du;
+  if(du<0.)
+    std::swap(lo, hi);
+  lo = std::max(std::floor(lo)-1., (double)begin);
+  hi = std::min(std::ceil(hi)+1., (double)end);
+  if(lo>=hi)
+    {
+    end = begin;
+    return;
+    }
+  begin = (int)lo;
+  end = (int)hi;
+
+  // The valid n form an interval because u0+n*du is monotonic, remove the
+  // extremities which are outside because of the enlargement
+  while(begin<end && !(u0+begin*du>=0. && u0+begin*du<uMax))
+    begin++;
+  while(end>begin && !(u0+(end-1)*du>=0. && u0+(end-1)*du<uMax))
+    end--;
+}
+
+//--------------------------------------------------------------------
+/** \brief Returns true if the AVX2 backprojection kernels have been compiled
+ * (CMake option RTK_USE_AVX2) and if the CPU running the code supports them.
+ * The CPU is only queried at the first call.
+ *
+ * \ingroup Functions
+ */
+RTK_EXPORT bool IsAVX2BackProjectionAvailable();
+
+#ifdef RTK_USE_AVX2
+//--------------------------------------------------------------------
+/** \brief AVX2 bilinear backprojection of a packet of 8 voxels.
+ *
+ * The 8 voxels are contiguous in memory, starting at pVol. The packet is
+ * moved nSteps times by volStride pixels. Lane l of the packet projects at
+ * continuous index (u[l]+s*du[l], v[l]) of the projection pProj of size
+ * pSize0 x pSize1 at step s and its value is accumulated in the volume with
+ * weight w[l]. Continuous indices are relative to the first pixel of pProj.
+ * Must only be called if IsAVX2BackProjectionAvailable() returns true.
+ *
+ * \ingroup Functions
+ */
+RTK_EXPORT void BackProjectBilinearPacketAVX2(float *pVol,
+                                              const std::ptrdiff_t volStride,
+                                              const unsigned int nSteps,
+                                              const float *pProj,
+                                              const int pSize0,
+                                              const int pSize1,
+                                              const float *u,
+                                              const float *du,
+                                              const float *v,
+                                              const float *w);
+
+//--------------------------------------------------------------------
+/** \brief AVX2 bilinear backprojection of a packet of 8 voxels with a
+ * projective mapping and the FDK weighting.
+ *
+ * The 8 voxels are contiguous in memory, starting at pVol, and the packet is
+ * moved nSteps times by volStride pixels. At step s, lane l has homogeneous
+ * projection coordinates (uh[l]+s*duh[l], vh[l]+s*dvh[l], wh[l]+s*dwh[l]),
+ * i.e., it projects at continuous index (uh/wh, vh/wh) relative to the first
+ * pixel of pProj (size pSize0 x pSize1). The interpolated value is weighted
+ * by 1/wh^2. Must only be called if IsAVX2BackProjectionAvailable() returns
+ * true.
+ *
+ * \ingroup Functions
+ */
+RTK_EXPORT void BackProjectBilinearProjectivePacketAVX2(float *pVol,
+                                                        const std::ptrdiff_t volStride,
+                                                        const unsigned int nSteps,
+                                                        const float *pProj,
+                                                        const int pSize0,
+                                                        const int pSize1,
+                                                        const float *uh,
+                                                        const float *vh,
+                                                        const float *wh,
+                                                        const float *duh,
+                                                        const float *dvh,
+                                                        const float *dwh);
+#endif
+
+//--------------------------------------------------------------------
+/** \brief Bilinear backprojection of a packet of BackProjectionPacketSize
+ * voxels with the fastest SIMD kernel available, see
+ * BackProjectBilinearPacketAVX2 for the description of the parameters.
+ * Returns false if no SIMD kernel is available for these pixel types, in
+ * which case nothing is done and the caller must use its scalar code.
+ *
+ * \ingroup Functions
+ */
+template <class TVolumePixel, class TProjectionPixel>
+inline bool
+BackProjectBilinearPacket(TVolumePixel *,
+                          const std::ptrdiff_t,
+                          const unsigned int,
+                          const TProjectionPixel *,
+                          const int,
+                          const int,
+                          const float *,
+                          const float *,
+                          const float *,
+                          const float *)
+{
+  return false;
+}
+
+inline bool
+BackProjectBilinearPacket(float *pVol,
+                          const std::ptrdiff_t volStride,
+                          const unsigned int nSteps,
+                          const float *pProj,
+                          const int pSize0,
+                          const int pSize1,
+                          const float *u,
+                          const float *du,
+                          const float *v,
+                          const float *w)
+{
+#ifdef RTK_USE_AVX2
+  if( IsAVX2BackProjectionAvailable() )
+    {
+    BackProjectBilinearPacketAVX2(pVol, volStride, nSteps, pProj, pSize0, pSize1, u, du, v, w);
+    return true;
+    }
+#endif
+  return false;
+}
+
+//--------------------------------------------------------------------
+/** \brief Bilinear backprojection of a packet of BackProjectionPacketSize
+ * voxels with a projective mapping and the FDK weighting, using the fastest
+ * SIMD kernel available. See BackProjectBilinearProjectivePacketAVX2 for
+ * the description of the parameters. Returns false if no SIMD kernel is
+ * available for these pixel types, in which case nothing is done.
+ *
+ * \ingroup Functions
+ */
+template <class TVolumePixel, class TProjectionPixel>
+inline bool
+BackProjectBilinearProjectivePacket(TVolumePixel *,
+                                    const std::ptrdiff_t,
+                                    const unsigned int,
+                                    const TProjectionPixel *,
+                                    const int,
+                                    const int,
+                                    const float *,
+                                    const float *,
+                                    const float *,
+                                    const float *,
+                                    const float *,
+                                    const float *)
+{
+  return false;
+}
+
+inline bool
+BackProjectBilinearProjectivePacket(float *pVol,
+                                    const std::ptrdiff_t volStride,
+                                    const unsigned int nSteps,
+                                    const float *pProj,
+                                    const int pSize0,
+                                    const int pSize1,
+                                    const float *uh,
+                                    const float *vh,
+                                    const float *wh,
+                                    const float *duh,
+                                    const float *dvh,
+                                    const float *dwh)
+{
+#ifdef RTK_USE_AVX2
+  if( IsAVX2BackProjectionAvailable() )
+    {
+    BackProjectBilinearProjectivePacketAVX2(pVol, volStride, nSteps, pProj, pSize0, pSize1,
+                                            uh, vh, wh, duh, dvh, dwh);
+    return true;
+    }
+#endif
+  return false;
+}
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,162 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// This file is compiled with the AVX2 and FMA instruction sets enabled. It
+// must only contain code which is called after a successful runtime check,
+// see rtk::IsAVX2BackProjectionAvailable().
+
+#include "rtkBackProjectionKernels.h"
+
+#include <immintrin.h>
+
+void
+rtk::BackProjectBilinearPacketAVX2(float *pVol,
+                                   const std::ptrdiff_t volStride,
+                                   const unsigned int nSteps,
+                                   const float *pProj,
+                                   const int pSize0,
+                                   const int pSize1,
+                                   const float *u,
+                                   const float *du,
+                                   const float *v,
+                                   const float *w)
+{
+  const __m256  u0 = _mm256_loadu_ps(u);
+  const __m256  dus = _mm256_loadu_ps(du);
+  const __m256  ws = _mm256_loadu_ps(w);
+  const __m256  vs = _mm256_loadu_ps(v);
+  const __m256  one = _mm256_set1_ps(1.f);
+  const __m256  zero = _mm256_setzero_ps();
+  const __m256i minusOne = _mm256_set1_epi32(-1);
+  const __m256i uLast = _mm256_set1_epi32(pSize0-1);
+
+  // The projection row and the interpolation weights along v are constant
+  // for each lane
+  const __m256  vf = _mm256_floor_ps(vs);
+  const __m256i vi = _mm256_cvtps_epi32(vf);
+  const __m256i vMask = _mm256_and_si256(_mm256_cmpgt_epi32(vi, minusOne),
+                                         _mm256_cmpgt_epi32(_mm256_set1_epi32(pSize1-1), vi) );
+  if( _mm256_testz_si256(vMask, vMask) )
+    return;
+  const __m256  v1 = _mm256_sub_ps(vs, vf);
+  const __m256  v2 = _mm256_sub_ps(one, v1);
+  const __m256i rowIndex = _mm256_mullo_epi32(vi, _mm256_set1_epi32(pSize0) );
+  const float  *pProjNextRow = pProj + pSize0;
+
+  for(unsigned int s=0; s<nSteps; s++, pVol += volStride)
+    {
+    // Continuous index along u, computed from the packet origin to avoid the
+    // accumulation of rounding errors in single precision
+    const __m256  us = _mm256_fmadd_ps(_mm256_set1_ps( (float)s ), dus, u0);
+    const __m256  uf = _mm256_floor_ps(us);
+    const __m256i ui = _mm256_cvtps_epi32(uf);
+    const __m256i mask = _mm256_and_si256(vMask,
+                                          _mm256_and_si256(_mm256_cmpgt_epi32(ui, minusOne),
+                                                           _mm256_cmpgt_epi32(uLast, ui) ) );
+    if( _mm256_testz_si256(mask, mask) )
+      continue;
+
+    // Masked gathers of the four neighbors, lanes outside the projection
+    // are not read and set to 0
+    const __m256  maskps = _mm256_castsi256_ps(mask);
+    const __m256i idx = _mm256_add_epi32(rowIndex, ui);
+    const __m256  p00 = _mm256_mask_i32gather_ps(zero, pProj,          idx, maskps, 4);
+    const __m256  p01 = _mm256_mask_i32gather_ps(zero, pProj+1,        idx, maskps, 4);
+    const __m256  p10 = _mm256_mask_i32gather_ps(zero, pProjNextRow,   idx, maskps, 4);
+    const __m256  p11 = _mm256_mask_i32gather_ps(zero, pProjNextRow+1, idx, maskps, 4);
+
+    // Bilinear interpolation
+    const __m256 u1 = _mm256_sub_ps(us, uf);
+    const __m256 u2 = _mm256_sub_ps(one, u1);
+    const __m256 r0 = _mm256_fmadd_ps(u1, p01, _mm256_mul_ps(u2, p00) );
+    const __m256 r1 = _mm256_fmadd_ps(u1, p11, _mm256_mul_ps(u2, p10) );
+    __m256 val = _mm256_mul_ps(ws, _mm256_fmadd_ps(v1, r1, _mm256_mul_ps(v2, r0) ) );
+    val = _mm256_and_ps(val, maskps);
+
+    _mm256_storeu_ps(pVol, _mm256_add_ps(_mm256_loadu_ps(pVol), val) );
+    }
+}
+
+void
+rtk::BackProjectBilinearProjectivePacketAVX2(float *pVol,
+                                             const std::ptrdiff_t volStride,
+                                             const unsigned int nSteps,
+                                             const float *pProj,
+                                             const int pSize0,
+                                             const int pSize1,
+                                             const float *uh,
+                                             const float *vh,
+                                             const float *wh,
+                                             const float *duh,
+                                             const float *dvh,
+                                             const float *dwh)
+{
+  const __m256  uh0 = _mm256_loadu_ps(uh);
+  const __m256  vh0 = _mm256_loadu_ps(vh);
+  const __m256  wh0 = _mm256_loadu_ps(wh);
+  const __m256  duhs = _mm256_loadu_ps(duh);
+  const __m256  dvhs = _mm256_loadu_ps(dvh);
+  const __m256  dwhs = _mm256_loadu_ps(dwh);
+  const __m256  one = _mm256_set1_ps(1.f);
+  const __m256  zero = _mm256_setzero_ps();
+  const __m256i minusOne = _mm256_set1_epi32(-1);
+  const __m256i uLast = _mm256_set1_epi32(pSize0-1);
+  const __m256i vLast = _mm256_set1_epi32(pSize1-1);
+  const __m256i rowSize = _mm256_set1_epi32(pSize0);
+  const float  *pProjNextRow = pProj + pSize0;
+
+  for(unsigned int s=0; s<nSteps; s++, pVol += volStride)
+    {
+    // Homogeneous coordinates, computed from the packet origin to avoid the
+    // accumulation of rounding errors in single precision
+    const __m256 step = _mm256_set1_ps( (float)s );
+    const __m256 r = _mm256_div_ps(one, _mm256_fmadd_ps(step, dwhs, wh0) );
+    const __m256 us = _mm256_mul_ps(_mm256_fmadd_ps(step, duhs, uh0), r);
+    const __m256 vs = _mm256_mul_ps(_mm256_fmadd_ps(step, dvhs, vh0), r);
+
+    const __m256  uf = _mm256_floor_ps(us);
+    const __m256  vf = _mm256_floor_ps(vs);
+    const __m256i ui = _mm256_cvtps_epi32(uf);
+    const __m256i vi = _mm256_cvtps_epi32(vf);
+    const __m256i uMask = _mm256_and_si256(_mm256_cmpgt_epi32(ui, minusOne), _mm256_cmpgt_epi32(uLast, ui) );
+    const __m256i vMask = _mm256_and_si256(_mm256_cmpgt_epi32(vi, minusOne), _mm256_cmpgt_epi32(vLast, vi) );
+    const __m256i mask = _mm256_and_si256(uMask, vMask);
+    if( _mm256_testz_si256(mask, mask) )
+      continue;
+
+    // Masked gathers of the four neighbors
+    const __m256  maskps = _mm256_castsi256_ps(mask);
+    const __m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(vi, rowSize), ui);
+    const __m256  p00 = _mm256_mask_i32gather_ps(zero, pProj,          idx, maskps, 4);
+    const __m256  p01 = _mm256_mask_i32gather_ps(zero, pProj+1,        idx, maskps, 4);
+    const __m256  p10 = _mm256_mask_i32gather_ps(zero, pProjNextRow,   idx, maskps, 4);
+    const __m256  p11 = _mm256_mask_i32gather_ps(zero, pProjNextRow+1, idx, maskps, 4);
+
+    // Bilinear interpolation and FDK weighting
+    const __m256 u1 = _mm256_sub_ps(us, uf);
+    const __m256 u2 = _mm256_sub_ps(one, u1);
+    const __m256 v1 = _mm256_sub_ps(vs, vf);
+    const __m256 v2 = _mm256_sub_ps(one, v1);
+    const __m256 r0 = _mm256_fmadd_ps(u1, p01, _mm256_mul_ps(u2, p00) );
+    const __m256 r1 = _mm256_fmadd_ps(u1, p11, _mm256_mul_ps(u2, p10) );
+    __m256 val = _mm256_mul_ps(_mm256_mul_ps(r, r), _mm256_fmadd_ps(v1, r1, _mm256_mul_ps(v2, r0) ) );
+    val = _mm256_and_ps(val, maskps);
+
+    _mm256_storeu_ps(pVol, _mm256_add_ps(_mm256_loadu_ps(pVol), val) );
+    }
+}
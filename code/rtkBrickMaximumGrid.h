@@ -0,0 +1,138 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkBrickMaximumGrid_h
+#define rtkBrickMaximumGrid_h
+
+#include "rtkMacro.h"
+
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+#include <itkTimeStamp.h>
+
+#include <vector>
+
+namespace rtk
+{
+
+/** \class BrickMaximumGrid
+ * \brief Maximum absolute value of a 3D image in bricks of voxels, used to
+ * skip empty space in the forward projectors.
+ *
+ * The image buffer is divided in cubic bricks of BrickSize voxels. Each
+ * brick stores the maximum absolute value of its voxels and of the next voxel
+ * along each dimension, i.e., of all voxels read by a linear interpolation
+ * at a point whose integer part is in the brick. A brick is empty if this
+ * maximum is lower than or equal to Threshold. With the default threshold
+ * (0), an interpolation in an empty brick is exactly 0.
+ *
+ * \test rtkforwardprojectiontest.cxx
+ *
+ * \ingroup Projector
+ */
+template <class TImage>
+class BrickMaximumGrid : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef BrickMaximumGrid              Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  typedef typename TImage::RegionType   RegionType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(BrickMaximumGrid, itk::Object);
+
+  /** Get / Set the size of the bricks in voxels along each dimension. Must be
+   * a power of 2, default is 8. */
+  itkGetMacro(BrickSize, unsigned int);
+  void SetBrickSize(const unsigned int size);
+
+  /** Get / Set the threshold below which a brick is empty. Default is 0. */
+  itkGetMacro(Threshold, double);
+  itkSetMacro(Threshold, double);
+
+  /** Computes the grid of image if the image, its buffer, its modification
+   * or update times or the brick size have changed since the last call. */
+  void Update(const TImage *image);
+
+  /** Returns true if the brick of the voxel with index (i,j,k) is empty,
+   * i.e., if a linear interpolation between this voxel and the next ones
+   * along each dimension only reads values below the threshold. Voxels
+   * outside the buffer are never in an empty brick. */
+  inline bool IsEmpty(const int i, const int j, const int k) const
+    {
+    const int di = i - m_Index[0];
+    const int dj = j - m_Index[1];
+    const int dk = k - m_Index[2];
+    if(di<0 || dj<0 || dk<0)
+      return false;
+    const int bi = di >> m_BrickSizeLog2;
+    const int bj = dj >> m_BrickSizeLog2;
+    const int bk = dk >> m_BrickSizeLog2;
+    if(bi>=m_GridSize[0] || bj>=m_GridSize[1] || bk>=m_GridSize[2])
+      return false;
+    return m_Maximum[bi + m_GridSize[0] * (bj + m_GridSize[1] * bk)] <= m_Threshold;
+    }
+  inline bool IsEmpty(const int index[3]) const
+    {
+    return IsEmpty(index[0], index[1], index[2]);
+    }
+
+  /** Returns a number n>=1 of steps such that the points c+s*dc, s in
+   * [0,n), are in the same brick along dimension dim as c. The result is
+   * conservative, i.e., the last points of the brick may be excluded. */
+  int GetNumberOfStepsInBrick(const unsigned int dim, const double c, const double dc) const;
+
+protected:
+  BrickMaximumGrid();
+  ~BrickMaximumGrid() {}
+
+private:
+  BrickMaximumGrid(const Self&); //purposely not implemented
+  void operator=(const Self&);   //purposely not implemented
+
+  unsigned int        m_BrickSize;
+  unsigned int        m_BrickSizeLog2;
+  double              m_Threshold;
+
+  /** Description of the grid */
+  int                 m_Index[3];
+  int                 m_GridSize[3];
+  std::vector<double> m_Maximum;
+
+  /** Image used for the last computation of the grid */
+  const TImage       *m_Image;
+  const void         *m_ImageBuffer;
+  RegionType          m_ImageRegion;
+  unsigned int        m_ImageBrickSize;
+  itk::TimeStamp      m_ComputationTime;
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkBrickMaximumGrid.hxx"
+#endif
+
+#endif
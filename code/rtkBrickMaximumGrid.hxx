@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkBrickMaximumGrid_hxx
+#define rtkBrickMaximumGrid_hxx
+
+#include <itkMacro.h>
+#include <vnl/vnl_math.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace rtk
+{
+
+template <class TImage>
+BrickMaximumGrid<TImage>
+::BrickMaximumGrid():
+  m_BrickSize(8),
+  m_BrickSizeLog2(3),
+  m_Threshold(0.),
+  m_Image(ITK_NULLPTR),
+  m_ImageBuffer(ITK_NULLPTR),
+  m_ImageBrickSize(0)
+{
+  for(unsigned int i=0; i<3; i++)
+    {
+    m_Index[i] = 0;
+    m_GridSize[i] = 0;
+    }
+}
+
+template <class TImage>
+void
+BrickMaximumGrid<TImage>
+::SetBrickSize(const unsigned int size)
+{
+  if(size == 0 || (size & (size-1)) != 0)
+    {
+    itkExceptionMacro(<< "Brick size must be a power of 2, got " << size);
+    }
+  if(size == m_BrickSize)
+    return;
+  m_BrickSize = size;
+  m_BrickSizeLog2 = 0;
+  while( (1u << m_BrickSizeLog2) < size )
+    m_BrickSizeLog2++;
+  this->Modified();
+}
+
+template <class TImage>
+void
+BrickMaximumGrid<TImage>
+::Update(const TImage *image)
+{
+  // Check if the grid is up to date
+  const RegionType region = image->GetBufferedRegion();
+  if(image == m_Image &&
+     image->GetBufferPointer() == m_ImageBuffer &&
+     region == m_ImageRegion &&
+     m_BrickSize == m_ImageBrickSize &&
+     image->GetMTime() < m_ComputationTime.GetMTime() &&
+     image->GetUpdateMTime() < m_ComputationTime.GetMTime())
+    return;
+
+  const int size[3] = {(int)region.GetSize(0), (int)region.GetSize(1), (int)region.GetSize(2)};
+  for(unsigned int i=0; i<3; i++)
+    {
+    m_Index[i] = region.GetIndex(i);
+    m_GridSize[i] = (size[i] + m_BrickSize - 1) >> m_BrickSizeLog2;
+    }
+  m_Maximum.resize(m_GridSize[0] * m_GridSize[1] * m_GridSize[2]);
+
+  // Maximum over each brick and the next voxel along each dimension
+  const typename TImage::PixelType *buffer = image->GetBufferPointer();
+  std::vector<double>::iterator itMax = m_Maximum.begin();
+  for(int bk=0; bk<m_GridSize[2]; bk++)
+    {
+    const int kEnd = std::min(size[2], (int)((bk+1)*m_BrickSize+1));
+    for(int bj=0; bj<m_GridSize[1]; bj++)
+      {
+      const int jEnd = std::min(size[1], (int)((bj+1)*m_BrickSize+1));
+      for(int bi=0; bi<m_GridSize[0]; bi++, ++itMax)
+        {
+        const int iEnd = std::min(size[0], (int)((bi+1)*m_BrickSize+1));
+        double maximum = 0.;
+        for(int k=bk*m_BrickSize; k<kEnd; k++)
+          for(int j=bj*m_BrickSize; j<jEnd; j++)
+            {
+            const typename TImage::PixelType *p = buffer + size[0] * (j + size[1] * k);
+            for(int i=bi*m_BrickSize; i<iEnd; i++)
+              maximum = std::max(maximum, (double)vnl_math_abs(p[i]) );
+            }
+        *itMax = maximum;
+        }
+      }
+    }
+
+  m_Image = image;
+  m_ImageBuffer = image->GetBufferPointer();
+  m_ImageRegion = region;
+  m_ImageBrickSize = m_BrickSize;
+  m_ComputationTime.Modified();
+}
+
+template <class TImage>
+int
+BrickMaximumGrid<TImage>
+::GetNumberOfStepsInBrick(const unsigned int dim, const double c, const double dc) const
+{
+  // Margin against the rounding errors of the incremental computation of the
+  // points along a ray
+  const double margin = 1e-6;
+  const int maxSteps = m_BrickSize * m_GridSize[dim];
+
+  const int brick = (int)(std::floor(c) - m_Index[dim]) >> m_BrickSizeLog2;
+  double steps;
+  if(dc > 0.)
+    {
+    const double upper = m_Index[dim] + ( (brick+1) << m_BrickSizeLog2 );
+    steps = (upper - c - margin) / dc;
+    }
+  else if(dc < 0.)
+    {
+    const double lower = m_Index[dim] + ( brick << m_BrickSizeLog2 );
+    steps = (c - lower - margin) / -dc;
+    }
+  else
+    return maxSteps;
+
+  if(steps < 0.)
+    return 1;
+  return std::min(maxSteps, (int)std::floor(steps) + 1);
+}
+
+} // end namespace rtk
+
+#endif
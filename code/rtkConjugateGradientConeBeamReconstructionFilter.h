@@ -22,12 +22,15 @@
 #include <itkMultiplyImageFilter.h>
 #include <itkTimeProbe.h>
 #include <itkDivideOrZeroOutImageFilter.h>
+#include <itkSqrtImageFilter.h>
 
 #include "rtkConjugateGradientImageFilter.h"
 #include "rtkReconstructionConjugateGradientOperator.h"
 #include "rtkIterativeConeBeamReconstructionFilter.h"
 #include "rtkThreeDCircularProjectionGeometry.h"
 #include "rtkDisplacedDetectorImageFilter.h"
+#include "rtkRayBoxIntersectionImageFilter.h"
+#include "rtkFFTRampImageFilter.h"
 #include "rtkConstantImageSource.h"
 #include "rtkLaplacianImageFilter.h"
 
@@ -57,6 +60,18 @@ namespace rtk
    *
    * With gamma > 0, a regularization is applied.
    *
+   * The conjugate gradient can be preconditioned to converge in fewer
+   * iterations:
+   * - DIAGONAL solves M A M y = M b with f = M y, M being the diagonal matrix
+   * 1/sqrt(R_t D R 1), i.e., the inverse of the square root of the
+   * backprojection of the weighted lengths of the rays in the volume box,
+   * computed with rtk::RayBoxIntersectionImageFilter. This is handled like
+   * the support mask, which is multiplied by M if any.
+   * - RAMP replaces D by sqrt(D) F sqrt(D) in the normal equations, F being
+   * the ramp filter of rtk::FFTRampImageFilter. The solution is the same
+   * only for consistent projections since F changes the norm of the
+   * projection residual, see ReconstructionConjugateGradientOperator.
+   *
    * \dot
    * digraph ConjugateGradientConeBeamReconstructionFilter {
    *
@@ -133,6 +148,10 @@ public:
     typedef rtk::ConstantImageSource<TOutputImage>                           ConstantImageSourceType;
     typedef itk::DivideOrZeroOutImageFilter<TOutputImage>                    DivideFilterType;
     typedef itk::StatisticsImageFilter<TOutputImage>                         StatisticsImageFilterType;
+    typedef itk::SqrtImageFilter<TOutputImage, TOutputImage>                 SqrtFilterType;
+    typedef rtk::RayBoxIntersectionImageFilter<TOutputImage, TOutputImage>   RayBoxIntersectionFilterType;
+    typedef rtk::FFTRampImageFilter<TOutputImage, TOutputImage, double>      RampFilterType;
+    typedef enum {NONE=0, DIAGONAL=1, RAMP=2}                                PreconditionerType;
     typedef typename TOutputImage::Pointer                                   OutputImagePointer;
 
     /** Pass the ForwardProjection filter to the conjugate gradient operator */
@@ -157,6 +176,18 @@ public:
     itkSetMacro(IterationCosts, bool)
     itkGetMacro(IterationCosts, bool)
 
+    /** Set / Get the stopping criteria of the conjugate gradient, see
+     * ConjugateGradientImageFilter. Both are disabled by default (0). */
+    itkSetMacro(Tolerance, double)
+    itkGetMacro(Tolerance, double)
+    itkSetMacro(StagnationTolerance, double)
+    itkGetMacro(StagnationTolerance, double)
+
+    /** Set / Get the preconditioner of the conjugate gradient. Default is
+     * NONE. */
+    itkSetMacro(Preconditioner, PreconditionerType)
+    itkGetMacro(Preconditioner, PreconditionerType)
+
     /** Set / Get whether the displaced detector filter should be disabled */
     itkSetMacro(DisableDisplacedDetectorFilter, bool)
     itkGetMacro(DisableDisplacedDetectorFilter, bool)
@@ -168,17 +199,27 @@ public:
     itkSetMacro(Gamma, float)
     itkGetMacro(Gamma, float)
 
-    /** Get / Set whether conjugate gradient should be performed on GPU */
+    /** Get / Set whether conjugate gradient should be performed on GPU. The
+     * conjugate gradient on GPU does not support the stopping criteria, it is
+     * replaced by the one on CPU with a warning when either is set. */
     itkGetMacro(CudaConjugateGradient, bool)
     itkSetMacro(CudaConjugateGradient, bool)
 
     /** Getter for ResidualCosts storing array **/
     const std::vector<double> &GetResidualCosts();
 
+    /** Getter for the norms of the residuals of the conjugate gradient. An
+     * itk::IterationEvent is invoked after each iteration. **/
+    const std::vector<double> &GetResidualNorms();
+
 protected:
     ConjugateGradientConeBeamReconstructionFilter();
     ~ConjugateGradientConeBeamReconstructionFilter() {}
 
+    /** Invokes an itk::IterationEvent after each iteration of
+     * m_ConjugateGradientFilter */
+    void ReportIteration();
+
     /** Does the real work. */
     void GenerateData() ITK_OVERRIDE;
 
@@ -194,6 +235,22 @@ protected:
     typename DisplacedDetectorFilterType::Pointer                               m_DisplacedDetectorFilter;
     typename ConstantImageSourceType::Pointer                                   m_ConstantVolumeSource;
 
+    /** Filters of the diagonal preconditioner */
+    typename ConstantImageSourceType::Pointer                                   m_ConstantProjectionsSource;
+    typename RayBoxIntersectionFilterType::Pointer                              m_RayBoxFilter;
+    typename MultiplyFilterType::Pointer                                        m_MultiplyRayLengthsFilter;
+    typename BackProjectionImageFilter<TOutputImage, TOutputImage>::Pointer     m_BackProjectionFilterForPreconditioner;
+    typename SqrtFilterType::Pointer                                            m_SqrtVolumeFilter;
+    typename DivideFilterType::Pointer                                          m_InverseVolumeFilter;
+    typename MultiplyFilterType::Pointer                                        m_MultiplySupportMaskFilter;
+    typename DivideFilterType::Pointer                                          m_DivideInputFilter;
+
+    /** Filters of the ramp preconditioner */
+    typename SqrtFilterType::Pointer                                            m_SqrtWeightsFilter;
+    typename RampFilterType::Pointer                                            m_RampFilter;
+    typename RampFilterType::Pointer                                            m_RampFilterForB;
+    typename MultiplyFilterType::Pointer                                        m_MultiplyRampFilteredProjectionsFilter;
+
     /** The inputs of this filter have the same type (float, 3) but not the same meaning
     * It is normal that they do not occupy the same physical space. Therefore this check
     * must be removed */
@@ -211,12 +268,15 @@ private:
     ThreeDCircularProjectionGeometry::Pointer m_Geometry;
 
     int                          m_NumberOfIterations;
+    double                       m_Tolerance;
+    double                       m_StagnationTolerance;
     float                        m_Gamma;
     bool                         m_MeasureExecutionTimes;
     bool                         m_IterationCosts;
     bool                         m_Regularized;
     bool                         m_CudaConjugateGradient;
     bool                         m_DisableDisplacedDetectorFilter;
+    PreconditionerType           m_Preconditioner;
 };
 } //namespace ITK
 
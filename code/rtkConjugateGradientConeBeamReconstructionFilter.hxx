@@ -21,6 +21,8 @@
 
 #include "rtkConjugateGradientConeBeamReconstructionFilter.h"
 
+#include <itkCommand.h>
+
 namespace rtk
 {
 
@@ -31,12 +33,15 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>::ConjugateGradientCo
 
   // Set the default values of member parameters
   m_NumberOfIterations=3;
+  m_Tolerance=0.;
+  m_StagnationTolerance=0.;
   m_MeasureExecutionTimes=false;
   m_IterationCosts=false;
   m_Gamma = 0;
   m_Regularized = false;
   m_CudaConjugateGradient = true;
   m_DisableDisplacedDetectorFilter = false;
+  m_Preconditioner = NONE;
 
   // Create the filters
 #ifdef RTK_USE_CUDA
@@ -52,8 +57,23 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>::ConjugateGradientCo
   m_MultiplyProjectionsFilter = MultiplyFilterType::New();
   m_MultiplyOutputFilter = MultiplyFilterType::New();
 
+  m_ConstantProjectionsSource = ConstantImageSourceType::New();
+  m_RayBoxFilter = RayBoxIntersectionFilterType::New();
+  m_MultiplyRayLengthsFilter = MultiplyFilterType::New();
+  m_SqrtVolumeFilter = SqrtFilterType::New();
+  m_InverseVolumeFilter = DivideFilterType::New();
+  m_MultiplySupportMaskFilter = MultiplyFilterType::New();
+  m_DivideInputFilter = DivideFilterType::New();
+
+  m_SqrtWeightsFilter = SqrtFilterType::New();
+  m_RampFilter = RampFilterType::New();
+  m_RampFilterForB = RampFilterType::New();
+  m_MultiplyRampFilteredProjectionsFilter = MultiplyFilterType::New();
+
   // Set permanent parameters
   m_ConstantVolumeSource->SetConstant(itk::NumericTraits<typename TOutputImage::PixelType>::ZeroValue());
+  m_ConstantProjectionsSource->SetConstant(itk::NumericTraits<typename TOutputImage::PixelType>::ZeroValue());
+  m_InverseVolumeFilter->SetConstant1(1.);
   m_DisplacedDetectorFilter->SetPadOnTruncatedSide(false);
 }
 
@@ -81,6 +101,21 @@ const std::vector<double> &ConjugateGradientConeBeamReconstructionFilter<TOutput
   return m_ConjugateGradientFilter->GetResidualCosts();
 }
 
+template< typename TOutputImage>
+const std::vector<double> &ConjugateGradientConeBeamReconstructionFilter<TOutputImage>
+::GetResidualNorms()
+{
+  return m_ConjugateGradientFilter->GetResidualNorms();
+}
+
+template< typename TOutputImage>
+void
+ConjugateGradientConeBeamReconstructionFilter<TOutputImage>
+::ReportIteration()
+{
+  this->InvokeEvent( itk::IterationEvent() );
+}
+
 template< typename TOutputImage>
 void
 ConjugateGradientConeBeamReconstructionFilter<TOutputImage>
@@ -104,6 +139,7 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>
     Superclass::SetBackProjectionFilter( _arg );
     m_BackProjectionFilter = this->InstantiateBackProjectionFilter( _arg );
     m_BackProjectionFilterForB = this->InstantiateBackProjectionFilter( _arg );
+    m_BackProjectionFilterForPreconditioner = this->InstantiateBackProjectionFilter( _arg );
     m_CGOperator->SetBackProjectionFilter( m_BackProjectionFilter);
     }
 }
@@ -154,10 +190,24 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>
   m_ConjugateGradientFilter = ConjugateGradientFilterType::New();
 #ifdef RTK_USE_CUDA
   if (m_CudaConjugateGradient)
-    m_ConjugateGradientFilter = rtk::CudaConjugateGradientImageFilter_3f::New();
+    {
+    // The conjugate gradient on GPU has no stopping criteria
+    if (m_Tolerance > 0. || m_StagnationTolerance > 0.)
+      itkWarningMacro(<< "The conjugate gradient on GPU does not support the stopping criteria, reverting to the conjugate gradient on CPU")
+    else
+      m_ConjugateGradientFilter = rtk::CudaConjugateGradientImageFilter_3f::New();
+    }
 #endif
   m_ConjugateGradientFilter->SetA(m_CGOperator.GetPointer());
   m_ConjugateGradientFilter->SetIterationCosts(m_IterationCosts);
+  m_ConjugateGradientFilter->SetTolerance(m_Tolerance);
+  m_ConjugateGradientFilter->SetStagnationTolerance(m_StagnationTolerance);
+
+  // Forward the iteration events of the conjugate gradient
+  typedef itk::SimpleMemberCommand<Self> IterationCommandType;
+  typename IterationCommandType::Pointer iterationCommand = IterationCommandType::New();
+  iterationCommand->SetCallbackFunction(this, &Self::ReportIteration);
+  m_ConjugateGradientFilter->AddObserver(itk::IterationEvent(), iterationCommand);
   
   // Set runtime connections
   m_ConstantVolumeSource->SetInformationFromImage(this->GetInput(0));
@@ -178,18 +228,84 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>
   m_CGOperator->SetInput(2, m_DisplacedDetectorFilter->GetOutput());
   m_BackProjectionFilterForB->SetInput(1, m_MultiplyProjectionsFilter->GetOutput());
 
-  // If a support mask is used, it serves as preconditioning weights
-  if (this->GetSupportMask().IsNotNull())
+  // Ramp preconditioner: the weights are split in two square roots applied
+  // before and after the ramp filter
+  if (m_Preconditioner == RAMP)
+    {
+    m_SqrtWeightsFilter->SetInput(m_DisplacedDetectorFilter->GetOutput());
+    m_MultiplyProjectionsFilter->SetInput2(m_SqrtWeightsFilter->GetOutput());
+    m_RampFilterForB->SetInput(m_MultiplyProjectionsFilter->GetOutput());
+    m_MultiplyRampFilteredProjectionsFilter->SetInput1(m_RampFilterForB->GetOutput());
+    m_MultiplyRampFilteredProjectionsFilter->SetInput2(m_SqrtWeightsFilter->GetOutput());
+    m_BackProjectionFilterForB->SetInput(1, m_MultiplyRampFilteredProjectionsFilter->GetOutput());
+
+    m_CGOperator->SetInput(2, m_SqrtWeightsFilter->GetOutput());
+    m_CGOperator->SetProjectionsPreconditioner(m_RampFilter.GetPointer());
+    }
+  else
+    m_CGOperator->SetProjectionsPreconditioner(ITK_NULLPTR);
+
+  // If a support mask or the diagonal preconditioner is used, the volume is
+  // weighted at the input and at the output of the operator, in B and in the
+  // output
+  const TOutputImage *volumeWeights = this->GetSupportMask();
+  if (m_Preconditioner == DIAGONAL)
     {
-    // Multiply the volume by support mask, and pass it to the conjugate gradient operator
+    // Backprojection of the weighted ray lengths in the volume box
+    m_ConstantProjectionsSource->SetInformationFromImage(this->GetInput(1));
+    m_RayBoxFilter->SetInput(m_ConstantProjectionsSource->GetOutput());
+    m_RayBoxFilter->SetGeometry(this->m_Geometry.GetPointer());
+    typename RayBoxIntersectionFilterType::VectorType boxMin, boxMax;
+    for(unsigned int i=0; i<3; i++)
+      {
+      boxMin[i] = this->GetInput(0)->GetOrigin()[i] - 0.5 * this->GetInput(0)->GetSpacing()[i];
+      boxMax[i] = boxMin[i] + this->GetInput(0)->GetLargestPossibleRegion().GetSize()[i] * this->GetInput(0)->GetSpacing()[i];
+      }
+    m_RayBoxFilter->SetBoxMin(boxMin);
+    m_RayBoxFilter->SetBoxMax(boxMax);
+    if(this->m_Geometry->GetMTime() > m_RayBoxFilter->GetOutput()->GetUpdateMTime())
+      m_RayBoxFilter->Modified();
+    m_MultiplyRayLengthsFilter->SetInput1(m_RayBoxFilter->GetOutput());
+    m_MultiplyRayLengthsFilter->SetInput2(m_DisplacedDetectorFilter->GetOutput());
+    m_BackProjectionFilterForPreconditioner->SetInput(0, m_ConstantVolumeSource->GetOutput());
+    m_BackProjectionFilterForPreconditioner->SetInput(1, m_MultiplyRayLengthsFilter->GetOutput());
+    m_BackProjectionFilterForPreconditioner->SetGeometry(this->m_Geometry.GetPointer());
+
+    // Inverse of its square root, zero where no ray goes
+    m_SqrtVolumeFilter->SetInput(m_BackProjectionFilterForPreconditioner->GetOutput());
+    m_InverseVolumeFilter->SetInput2(m_SqrtVolumeFilter->GetOutput());
+    volumeWeights = m_InverseVolumeFilter->GetOutput();
+    if (this->GetSupportMask().IsNotNull())
+      {
+      m_MultiplySupportMaskFilter->SetInput1(m_InverseVolumeFilter->GetOutput());
+      m_MultiplySupportMaskFilter->SetInput2(this->GetSupportMask());
+      volumeWeights = m_MultiplySupportMaskFilter->GetOutput();
+      }
+
+    // The initial volume is divided by the weights
+    m_DivideInputFilter->SetInput1(this->GetInput(0));
+    m_DivideInputFilter->SetInput2(volumeWeights);
+    m_ConjugateGradientFilter->SetX(m_DivideInputFilter->GetOutput());
+
+    // The weights are kept between executions, the intermediate images are not
+    m_RayBoxFilter->ReleaseDataFlagOn();
+    m_MultiplyRayLengthsFilter->ReleaseDataFlagOn();
+    m_BackProjectionFilterForPreconditioner->ReleaseDataFlagOn();
+    m_SqrtVolumeFilter->ReleaseDataFlagOn();
+    m_DivideInputFilter->ReleaseDataFlagOn();
+    }
+
+  if (volumeWeights)
+    {
+    // Multiply the volume by the weights, and pass them to the conjugate gradient operator
     m_MultiplyVolumeFilter->SetInput1(m_BackProjectionFilterForB->GetOutput());
-    m_MultiplyVolumeFilter->SetInput2(this->GetSupportMask());
-    m_CGOperator->SetSupportMask(this->GetSupportMask());
+    m_MultiplyVolumeFilter->SetInput2(volumeWeights);
+    m_CGOperator->SetSupportMask(volumeWeights);
     m_ConjugateGradientFilter->SetB(m_MultiplyVolumeFilter->GetOutput());
 
-    // Multiply the output by the support mask
+    // Multiply the output by the weights
     m_MultiplyOutputFilter->SetInput1(m_ConjugateGradientFilter->GetOutput());
-    m_MultiplyOutputFilter->SetInput2(this->GetSupportMask());
+    m_MultiplyOutputFilter->SetInput2(volumeWeights);
     }
 
   // For the same reason, set geometry now
@@ -205,11 +321,16 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>
   // Set memory management parameters
   m_MultiplyProjectionsFilter->ReleaseDataFlagOn();
   m_BackProjectionFilterForB->ReleaseDataFlagOn();
-  if (this->GetSupportMask().IsNotNull())
+  if (volumeWeights)
     {
     m_MultiplyVolumeFilter->ReleaseDataFlagOn();
     m_MultiplyOutputFilter->ReleaseDataFlagOn();
     }
+  if (m_Preconditioner == RAMP)
+    {
+    m_RampFilterForB->ReleaseDataFlagOn();
+    m_MultiplyRampFilteredProjectionsFilter->ReleaseDataFlagOn();
+    }
 
   // Have the last filter calculate its output information
   m_ConjugateGradientFilter->UpdateOutputInformation();
@@ -247,7 +368,8 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>
 
   m_ConjugateGradientFilter->Update();
 
-  if (this->GetSupportMask())
+  const bool volumeWeighted = this->GetSupportMask().IsNotNull() || m_Preconditioner == DIAGONAL;
+  if (volumeWeighted)
     {
     m_MultiplyOutputFilter->Update();
     }
@@ -258,7 +380,7 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>
     std::cout << "ConjugateGradient took " << ConjugateGradientTimeProbe.GetTotal() << ' ' << ConjugateGradientTimeProbe.GetUnit() << std::endl;
     }
 
-  if (this->GetSupportMask())
+  if (volumeWeighted)
     {
     this->GraftOutput( m_MultiplyOutputFilter->GetOutput() );
     }
@@ -21,11 +21,10 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkSubtractImageFilter.h"
+#include "itkMultiplyImageFilter.h"
 #include "itkStatisticsImageFilter.h"
 
-#include "rtkConjugateGradientGetR_kPlusOneImageFilter.h"
-#include "rtkConjugateGradientGetX_kPlusOneImageFilter.h"
-#include "rtkConjugateGradientGetP_kPlusOneImageFilter.h"
+#include "rtkConjugateGradientUpdateImageFilter.h"
 
 #include "rtkConjugateGradientOperator.h"
 #include "itkTimeProbe.h"
@@ -39,6 +38,19 @@ namespace rtk
  * ConjugateGradientImageFilter implements the algorithm described
  * in http://en.wikipedia.org/wiki/Conjugate_gradient_method
  *
+ * X, R and P are allocated once and each iteration updates them in place
+ * with a single ConjugateGradientUpdateImageFilter after the computation of
+ * A P.
+ *
+ * The iterations stop before NumberOfIterations when the norm of the
+ * residual R_k is below Tolerance times the norm of R_0, or when it has
+ * decreased by less than StagnationTolerance times its previous value during
+ * the last iteration. Both criteria are disabled by default (0). The norm of
+ * each residual is stored in ResidualNorms and an itk::IterationEvent is
+ * invoked after each iteration so that observers can monitor the
+ * convergence. The CUDA subclasses do not compute the residual norms on the
+ * CPU and always perform NumberOfIterations iterations.
+ *
 */
 
 template< typename OutputImageType>
@@ -56,9 +68,7 @@ public:
   typedef ConjugateGradientOperator<OutputImageType>                                ConjugateGradientOperatorType;
   typedef typename ConjugateGradientOperatorType::Pointer                           ConjugateGradientOperatorPointerType;
   typedef typename OutputImageType::Pointer                                         OutputImagePointer;
-  typedef typename rtk::ConjugateGradientGetP_kPlusOneImageFilter<OutputImageType>  GetP_kPlusOne_FilterType;
-  typedef typename rtk::ConjugateGradientGetR_kPlusOneImageFilter<OutputImageType>  GetR_kPlusOne_FilterType;
-  typedef typename rtk::ConjugateGradientGetX_kPlusOneImageFilter<OutputImageType>  GetX_kPlusOne_FilterType;
+  typedef typename rtk::ConjugateGradientUpdateImageFilter<OutputImageType>         UpdateFilterType;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self)
@@ -70,6 +80,17 @@ public:
   itkGetMacro(NumberOfIterations, int)
   itkSetMacro(NumberOfIterations, int)
 
+  /** Relative residual norm, |R_k| / |R_0|, below which the iterations
+   * stop. Default is 0 (disabled). */
+  itkGetMacro(Tolerance, double)
+  itkSetMacro(Tolerance, double)
+
+  /** Minimum relative decrease of the residual norm during one iteration,
+   * (|R_k-1| - |R_k|) / |R_k-1|, below which the iterations stop. Default is
+   * 0 (disabled). */
+  itkGetMacro(StagnationTolerance, double)
+  itkSetMacro(StagnationTolerance, double)
+
   /** Displays the conjugate gradient cost function at each iteration. */
   itkGetMacro(IterationCosts, bool)
   itkSetMacro(IterationCosts, bool)
@@ -91,7 +112,11 @@ public:
 
   /** Setter and getter for ResidualCosts storing array **/
   const std::vector<double> &GetResidualCosts();
-  
+
+  /** Norms of the residuals R_0 to R_k of the last execution, k being the
+   * current iteration during the execution. **/
+  const std::vector<double> &GetResidualNorms();
+
 protected:
   ConjugateGradientImageFilter();
   ~ConjugateGradientImageFilter() {}
@@ -109,8 +134,11 @@ protected:
   ConjugateGradientOperatorPointerType m_A;
 
   int                 m_NumberOfIterations;
+  double              m_Tolerance;
+  double              m_StagnationTolerance;
   bool                m_IterationCosts;
   std::vector<double> m_ResidualCosts;
+  std::vector<double> m_ResidualNorms;
   double              m_C;
 
   void CalculateResidualCosts(OutputImagePointer R_kPlusOne, OutputImagePointer X_kPlusOne);
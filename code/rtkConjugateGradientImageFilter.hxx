@@ -21,6 +21,9 @@
 
 #include "rtkConjugateGradientImageFilter.h"
 
+#include <itkImageDuplicator.h>
+#include <itkImageRegionConstIterator.h>
+
 namespace rtk
 {
 
@@ -30,6 +33,8 @@ ConjugateGradientImageFilter<OutputImageType>::ConjugateGradientImageFilter()
   this->SetNumberOfRequiredInputs(2);
 
   m_NumberOfIterations = 1;
+  m_Tolerance = 0.;
+  m_StagnationTolerance = 0.;
   m_IterationCosts = false;
   m_C=0.0;
 //  m_MeasureExecutionTimes = false;
@@ -99,6 +104,13 @@ const std::vector<double> &ConjugateGradientImageFilter<OutputImageType>
   return this->m_ResidualCosts;
 }
 
+template<typename OutputImageType>
+const std::vector<double> &ConjugateGradientImageFilter<OutputImageType>
+::GetResidualNorms()
+{
+  return this->m_ResidualNorms;
+}
+
 template<typename OutputImageType>
 void ConjugateGradientImageFilter<OutputImageType>::SetX(const OutputImageType* OutputImage)
 {
@@ -170,96 +182,77 @@ template<typename OutputImageType>
 void ConjugateGradientImageFilter<OutputImageType>
 ::GenerateData()
 {
+  // Compute R_zero = B - A X_zero
   typename SubtractFilterType::Pointer SubtractFilter = SubtractFilterType::New();
   SubtractFilter->SetInput(0, this->GetB());
   SubtractFilter->SetInput(1, m_A->GetOutput());
   SubtractFilter->Update();
 
-  typename GetP_kPlusOne_FilterType::Pointer GetP_kPlusOne_Filter = GetP_kPlusOne_FilterType::New();
-  typename GetR_kPlusOne_FilterType::Pointer GetR_kPlusOne_Filter = GetR_kPlusOne_FilterType::New();
-  typename GetX_kPlusOne_FilterType::Pointer GetX_kPlusOne_Filter = GetX_kPlusOne_FilterType::New();
+  typename OutputImageType::Pointer R_k = SubtractFilter->GetOutput();
+  R_k->DisconnectPipeline();
+
+  // X, R and P are allocated once and updated in place by UpdateFilter
+  typedef itk::ImageDuplicator<OutputImageType> DuplicatorType;
+  typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
+  duplicator->SetInputImage(this->GetX());
+  duplicator->Update();
+  typename OutputImageType::Pointer X_k = duplicator->GetOutput();
 
   // Compute P_zero = R_zero
-  typename OutputImageType::Pointer P_zero = SubtractFilter->GetOutput();
-  P_zero->DisconnectPipeline();
+  duplicator->SetInputImage(R_k);
+  duplicator->Update();
+  typename OutputImageType::Pointer P_k = duplicator->GetOutput();
+
+  // Compute the squared norm of R_zero, the next ones are computed by
+  // UpdateFilter
+  double squaredNormR_k = 0.;
+  itk::ImageRegionConstIterator<OutputImageType> itR(R_k, R_k->GetBufferedRegion());
+  for(; !itR.IsAtEnd(); ++itR)
+    squaredNormR_k += itR.Get() * itR.Get();
+  m_ResidualNorms.clear();
+  m_ResidualNorms.push_back(vcl_sqrt(squaredNormR_k));
 
   if (m_IterationCosts)
-    CalculateResidualCosts(P_zero,this->GetX());
-
-  // Compute AP_zero
-  m_A->SetX(P_zero);
-
-  GetR_kPlusOne_Filter->SetRk(P_zero);
-  GetR_kPlusOne_Filter->SetPk(P_zero);
-  GetR_kPlusOne_Filter->SetAPk(m_A->GetOutput());
+    CalculateResidualCosts(R_k,X_k);
 
-  GetP_kPlusOne_Filter->SetR_kPlusOne(GetR_kPlusOne_Filter->GetOutput());
-  GetP_kPlusOne_Filter->SetRk(P_zero);
-  GetP_kPlusOne_Filter->SetPk(P_zero);
+  m_A->SetX(P_k);
 
-  GetX_kPlusOne_Filter->SetXk(this->GetX());
-  GetX_kPlusOne_Filter->SetPk(P_zero);
-
-  // Define the smart pointers that will be used with DisconnectPipeline()
-  typename OutputImageType::Pointer R_kPlusOne;
-  typename OutputImageType::Pointer P_kPlusOne;
-  typename OutputImageType::Pointer X_kPlusOne;
+  typename UpdateFilterType::Pointer UpdateFilter = UpdateFilterType::New();
+  UpdateFilter->SetRk(R_k);
+  UpdateFilter->SetPk(P_k);
+  UpdateFilter->SetAPk(m_A->GetOutput());
 
   // Start the iterative procedure
   for (int iter=0; iter<m_NumberOfIterations; iter++)
     {
-    if(iter>0)
-      {
-      R_kPlusOne = GetR_kPlusOne_Filter->GetOutput();
-      R_kPlusOne->DisconnectPipeline();
-
-      P_kPlusOne = GetP_kPlusOne_Filter->GetOutput();
-      P_kPlusOne->DisconnectPipeline();
-
-      X_kPlusOne = GetX_kPlusOne_Filter->GetOutput();
-      X_kPlusOne->DisconnectPipeline();
-
-      if (m_IterationCosts)
-        CalculateResidualCosts(R_kPlusOne,X_kPlusOne);
-
-      m_A->SetX(P_kPlusOne);
-
-      GetR_kPlusOne_Filter->SetRk(R_kPlusOne);
-      GetR_kPlusOne_Filter->SetPk(P_kPlusOne);
-      GetR_kPlusOne_Filter->SetAPk(m_A->GetOutput());
-
-      GetP_kPlusOne_Filter->SetRk(R_kPlusOne);
-      GetP_kPlusOne_Filter->SetPk(P_kPlusOne);
-      GetP_kPlusOne_Filter->SetR_kPlusOne(GetR_kPlusOne_Filter->GetOutput());
-
-      GetX_kPlusOne_Filter->SetPk(P_kPlusOne);
-      GetX_kPlusOne_Filter->SetXk(X_kPlusOne);
-
-      P_zero->ReleaseData();
-      }
-
-    m_A->Update();
-    GetR_kPlusOne_Filter->Update();
-    GetX_kPlusOne_Filter->SetAlphak(GetR_kPlusOne_Filter->GetAlphak());
-    GetX_kPlusOne_Filter->Update();
-    GetP_kPlusOne_Filter->SetSquaredNormR_k(GetR_kPlusOne_Filter->GetSquaredNormR_k());
-    GetP_kPlusOne_Filter->SetSquaredNormR_kPlusOne(GetR_kPlusOne_Filter->GetSquaredNormR_kPlusOne());
-    GetP_kPlusOne_Filter->Update();
+    if(iter>0 && m_IterationCosts)
+      CalculateResidualCosts(R_k,X_k);
+
+    // X_k+1 is computed in place of X_k, the other images are modified
+    // in place and remain the inputs of UpdateFilter
+    UpdateFilter->SetXk(X_k);
+    UpdateFilter->SetSquaredNormR_k(squaredNormR_k);
+    UpdateFilter->Update();
+    X_k = UpdateFilter->GetOutput();
+    X_k->DisconnectPipeline();
+    squaredNormR_k = UpdateFilter->GetSquaredNormR_kPlusOne();
+    m_ResidualNorms.push_back(vcl_sqrt(squaredNormR_k));
+    this->InvokeEvent( itk::IterationEvent() );
+
+    // Stopping criteria
+    const double previousNorm = m_ResidualNorms[m_ResidualNorms.size()-2];
+    const double norm = m_ResidualNorms.back();
+    if( norm <= m_Tolerance * m_ResidualNorms.front() )
+      break;
+    if( m_StagnationTolerance > 0. && previousNorm - norm < m_StagnationTolerance * previousNorm )
+      break;
     }
 
-  this->GraftOutput(GetX_kPlusOne_Filter->GetOutput());
+  this->GraftOutput(X_k);
 
-  // Release the data from internal filters
-  if (m_NumberOfIterations > 1)
-    {
-    R_kPlusOne->ReleaseData();
-    P_kPlusOne->ReleaseData();
-    X_kPlusOne->ReleaseData();
-    }
-  GetR_kPlusOne_Filter->GetOutput()->ReleaseData();
-  GetP_kPlusOne_Filter->GetOutput()->ReleaseData();
+  R_k->ReleaseData();
+  P_k->ReleaseData();
   m_A->GetOutput()->ReleaseData();
-  SubtractFilter->GetOutput()->ReleaseData();
 }
 
 }// end namespace
@@ -0,0 +1,129 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkConjugateGradientUpdateImageFilter_h
+#define rtkConjugateGradientUpdateImageFilter_h
+
+#include <itkInPlaceImageFilter.h>
+#include <itkBarrier.h>
+
+#include "rtkConfiguration.h"
+#include "rtkMacro.h"
+
+namespace rtk
+{
+/** \class ConjugateGradientUpdateImageFilter
+ * \brief Updates X_k, R_k and P_k of the conjugate gradient in one filter.
+ *
+ * Given the current estimate X_k (input 0), the residual R_k (input 1), the
+ * search direction P_k (input 2), A P_k (input 3) and the squared norm of
+ * R_k, the filter computes
+ * alpha_k = |R_k|^2 / P_k^T A P_k
+ * X_k+1 = X_k + alpha_k P_k
+ * R_k+1 = R_k - alpha_k A P_k
+ * beta_k = |R_k+1|^2 / |R_k|^2
+ * P_k+1 = R_k+1 + beta_k P_k
+ *
+ * The three updates and the two inner products are computed by the same
+ * threads, synchronized with a barrier, so that each image is read at most
+ * three times and no image is allocated. X_k+1 is the output, which is
+ * computed in place of X_k by default. R_k+1 and P_k+1 replace R_k and P_k in
+ * their buffers, which are marked as modified.
+ *
+ * \test rtkconjugategradienttest.cxx
+ *
+ * \ingroup ReconstructionAlgorithm
+ */
+template< typename TImage>
+class ConjugateGradientUpdateImageFilter : public itk::InPlaceImageFilter< TImage, TImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ConjugateGradientUpdateImageFilter          Self;
+  typedef itk::InPlaceImageFilter< TImage, TImage>    Superclass;
+  typedef itk::SmartPointer< Self >                   Pointer;
+  typedef typename TImage::RegionType                 OutputImageRegionType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self)
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ConjugateGradientUpdateImageFilter, itk::InPlaceImageFilter)
+
+  /** Functions to set the inputs */
+  void SetXk(const TImage* Xk);
+  void SetRk(TImage* Rk);
+  void SetPk(TImage* Pk);
+  void SetAPk(const TImage* APk);
+
+  /** Squared norm of R_k, which is the squared norm of R_k+1 of the previous
+   * update. */
+  itkGetMacro(SquaredNormR_k, double)
+  itkSetMacro(SquaredNormR_k, double)
+
+  itkGetMacro(Alphak, double)
+  itkGetMacro(Betak, double)
+  itkGetMacro(SquaredNormR_kPlusOne, double)
+
+protected:
+  ConjugateGradientUpdateImageFilter();
+  ~ConjugateGradientUpdateImageFilter() {}
+
+  typename TImage::Pointer GetXk();
+  typename TImage::Pointer GetRk();
+  typename TImage::Pointer GetPk();
+  typename TImage::Pointer GetAPk();
+
+  /** Initialize the thread synchronization barrier before the threads run,
+      and create a few vectors in which each thread will store temporary
+      accumulation results */
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  /** Do the real work */
+  void ThreadedGenerateData(const OutputImageRegionType &outputRegionForThread,
+                            ThreadIdType threadId) ITK_OVERRIDE;
+
+  /** Set m_Alphak, m_Betak and m_SquaredNormR_kPlusOne and mark R and P as
+      modified */
+  void AfterThreadedGenerateData() ITK_OVERRIDE;
+
+private:
+  ConjugateGradientUpdateImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  double m_Alphak;
+  double m_Betak;
+  double m_SquaredNormR_k;
+  double m_SquaredNormR_kPlusOne;
+
+  // Thread synchronization tool
+  itk::Barrier::Pointer m_Barrier;
+
+  // These vectors store one accumulation value per thread
+  // The values are then summed
+  std::vector<double> m_PktApkVector;
+  std::vector<double> m_SquaredNormR_kPlusOneVector;
+};
+} //namespace rtk
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkConjugateGradientUpdateImageFilter.hxx"
+#endif
+
+#endif
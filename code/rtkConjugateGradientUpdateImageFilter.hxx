@@ -0,0 +1,205 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkConjugateGradientUpdateImageFilter_hxx
+#define rtkConjugateGradientUpdateImageFilter_hxx
+
+#include "rtkConjugateGradientUpdateImageFilter.h"
+
+#include "itkObjectFactory.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+namespace rtk
+{
+
+template< typename TImage>
+ConjugateGradientUpdateImageFilter<TImage>::ConjugateGradientUpdateImageFilter():
+  m_Alphak(0.),
+  m_Betak(0.),
+  m_SquaredNormR_k(0.),
+  m_SquaredNormR_kPlusOne(0.)
+{
+  this->SetNumberOfRequiredInputs(4);
+  this->SetInPlace(true);
+}
+
+template< typename TImage>
+void ConjugateGradientUpdateImageFilter<TImage>::SetXk(const TImage* Xk)
+{
+  this->SetNthInput(0, const_cast<TImage*>(Xk));
+}
+
+template< typename TImage>
+void ConjugateGradientUpdateImageFilter<TImage>::SetRk(TImage* Rk)
+{
+  this->SetNthInput(1, Rk);
+}
+
+template< typename TImage>
+void ConjugateGradientUpdateImageFilter<TImage>::SetPk(TImage* Pk)
+{
+  this->SetNthInput(2, Pk);
+}
+
+template< typename TImage>
+void ConjugateGradientUpdateImageFilter<TImage>::SetAPk(const TImage* APk)
+{
+  this->SetNthInput(3, const_cast<TImage*>(APk));
+}
+
+template< typename TImage>
+typename TImage::Pointer ConjugateGradientUpdateImageFilter<TImage>::GetXk()
+{
+  return static_cast< TImage * >
+          ( this->itk::ProcessObject::GetInput(0) );
+}
+
+template< typename TImage>
+typename TImage::Pointer ConjugateGradientUpdateImageFilter<TImage>::GetRk()
+{
+  return static_cast< TImage * >
+          ( this->itk::ProcessObject::GetInput(1) );
+}
+
+template< typename TImage>
+typename TImage::Pointer ConjugateGradientUpdateImageFilter<TImage>::GetPk()
+{
+  return static_cast< TImage * >
+          ( this->itk::ProcessObject::GetInput(2) );
+}
+
+template< typename TImage>
+typename TImage::Pointer ConjugateGradientUpdateImageFilter<TImage>::GetAPk()
+{
+  return static_cast< TImage * >
+          ( this->itk::ProcessObject::GetInput(3) );
+}
+
+template< typename TImage>
+void ConjugateGradientUpdateImageFilter<TImage>
+::BeforeThreadedGenerateData()
+{
+  // Instead of using GetNumberOfThreads, we need to split the image into the
+  // number of regions that will actually be returned by
+  // itkImageSource::SplitRequestedRegion. Sometimes this number is less than
+  // the number of threads requested.
+  OutputImageRegionType dummy;
+  unsigned int actualThreads = this->SplitRequestedRegion(
+    0, this->GetNumberOfThreads(), dummy);
+
+  m_Barrier = itk::Barrier::New();
+  m_Barrier->Initialize(actualThreads);
+
+  m_PktApkVector.assign(this->GetNumberOfThreads(), 0.);
+  m_SquaredNormR_kPlusOneVector.assign(this->GetNumberOfThreads(), 0.);
+}
+
+template< typename TImage>
+void ConjugateGradientUpdateImageFilter<TImage>
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId)
+{
+  const double eps=1e-8;
+
+  typedef itk::ImageRegionIterator<TImage>      RegionIterator;
+  typedef itk::ImageRegionConstIterator<TImage> RegionConstIterator;
+  RegionConstIterator x_k_It(this->GetXk(), outputRegionForThread);
+  RegionIterator      r_k_It(this->GetRk(), outputRegionForThread);
+  RegionIterator      p_k_It(this->GetPk(), outputRegionForThread);
+  RegionConstIterator A_p_k_It(this->GetAPk(), outputRegionForThread);
+  RegionIterator      outputIt(this->GetOutput(), outputRegionForThread);
+
+  // Compute p_k_t_A_p_k
+  double p_k_t_A_p_k = 0.;
+  while(!p_k_It.IsAtEnd())
+    {
+    p_k_t_A_p_k += p_k_It.Get() * A_p_k_It.Get();
+    ++p_k_It;
+    ++A_p_k_It;
+    }
+  m_PktApkVector[threadId] = p_k_t_A_p_k;
+  m_Barrier->Wait();
+
+  // Each thread computes alpha_k, with the same summation order
+  p_k_t_A_p_k = 0.;
+  for (unsigned int i=0; i<m_PktApkVector.size(); i++)
+    p_k_t_A_p_k += m_PktApkVector[i];
+  const double alphak = m_SquaredNormR_k / (p_k_t_A_p_k + eps);
+
+  // Compute X_k+1 in the output and R_k+1 in place of R_k
+  double squaredNormR_kPlusOne = 0.;
+  p_k_It.GoToBegin();
+  A_p_k_It.GoToBegin();
+  while(!outputIt.IsAtEnd())
+    {
+    outputIt.Set(x_k_It.Get() + alphak * p_k_It.Get());
+    const double r = r_k_It.Get() - alphak * A_p_k_It.Get();
+    r_k_It.Set(r);
+    squaredNormR_kPlusOne += r * r;
+    ++x_k_It;
+    ++r_k_It;
+    ++p_k_It;
+    ++A_p_k_It;
+    ++outputIt;
+    }
+  m_SquaredNormR_kPlusOneVector[threadId] = squaredNormR_kPlusOne;
+  m_Barrier->Wait();
+
+  // Each thread computes beta_k
+  squaredNormR_kPlusOne = 0.;
+  for (unsigned int i=0; i<m_SquaredNormR_kPlusOneVector.size(); i++)
+    squaredNormR_kPlusOne += m_SquaredNormR_kPlusOneVector[i];
+  const double betak = squaredNormR_kPlusOne / (m_SquaredNormR_k + eps);
+
+  // Compute P_k+1 in place of P_k
+  r_k_It.GoToBegin();
+  p_k_It.GoToBegin();
+  while(!p_k_It.IsAtEnd())
+    {
+    p_k_It.Set(r_k_It.Get() + betak * p_k_It.Get());
+    ++r_k_It;
+    ++p_k_It;
+    }
+}
+
+template< typename TImage>
+void ConjugateGradientUpdateImageFilter<TImage>
+::AfterThreadedGenerateData()
+{
+  const double eps=1e-8;
+
+  double p_k_t_A_p_k = 0.;
+  m_SquaredNormR_kPlusOne = 0.;
+  for (unsigned int i=0; i<m_PktApkVector.size(); i++)
+    {
+    p_k_t_A_p_k += m_PktApkVector[i];
+    m_SquaredNormR_kPlusOne += m_SquaredNormR_kPlusOneVector[i];
+    }
+  m_Alphak = m_SquaredNormR_k / (p_k_t_A_p_k + eps);
+  m_Betak = m_SquaredNormR_kPlusOne / (m_SquaredNormR_k + eps);
+
+  // R and P have been modified in place, the filters which use them, e.g.,
+  // the operator A, must be executed again
+  this->GetRk()->Modified();
+  this->GetPk()->Modified();
+}
+
+}// end namespace
+
+
+#endif
@@ -0,0 +1,182 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkExpressionImageFilter_h
+#define rtkExpressionImageFilter_h
+
+#include <itkInPlaceImageFilter.h>
+
+#include <cmath>
+#include <vector>
+
+namespace rtk
+{
+
+/** \namespace Expression
+ * \brief Nodes of the pointwise expressions evaluated by ExpressionImageFilter.
+ *
+ * An expression is a type composed of the templates below, e.g.,
+ * Expression::Sum< Expression::Input<0>, Expression::Product< Expression::Parameter<0>, Expression::Input<1> > >
+ * computes in0 + p0 * in1 at each pixel. Each node has a static Evaluate
+ * function of the values of the input pixels and of the parameters, and
+ * the numbers of inputs and parameters it uses, so that the compiler can
+ * inline the whole expression.
+ */
+namespace Expression
+{
+
+/** Value of the pixel of input I */
+template <unsigned int I>
+struct Input
+{
+  itkStaticConstMacro(NumberOfInputs, unsigned int, I+1);
+  itkStaticConstMacro(NumberOfParameters, unsigned int, 0);
+  static inline double Evaluate(const double *in, const double *) { return in[I]; }
+};
+
+/** Value of parameter I, constant over the image */
+template <unsigned int I>
+struct Parameter
+{
+  itkStaticConstMacro(NumberOfInputs, unsigned int, 0);
+  itkStaticConstMacro(NumberOfParameters, unsigned int, I+1);
+  static inline double Evaluate(const double *, const double *p) { return p[I]; }
+};
+
+/** Base of the binary nodes, counts the inputs and the parameters of A and B */
+template <class A, class B>
+struct BinaryNode
+{
+  itkStaticConstMacro(NumberOfInputs, unsigned int,
+                      (A::NumberOfInputs > B::NumberOfInputs)?A::NumberOfInputs:B::NumberOfInputs);
+  itkStaticConstMacro(NumberOfParameters, unsigned int,
+                      (A::NumberOfParameters > B::NumberOfParameters)?A::NumberOfParameters:B::NumberOfParameters);
+};
+
+template <class A, class B>
+struct Sum : public BinaryNode<A,B>
+{
+  static inline double Evaluate(const double *in, const double *p)
+  { return A::Evaluate(in, p) + B::Evaluate(in, p); }
+};
+
+template <class A, class B>
+struct Difference : public BinaryNode<A,B>
+{
+  static inline double Evaluate(const double *in, const double *p)
+  { return A::Evaluate(in, p) - B::Evaluate(in, p); }
+};
+
+template <class A, class B>
+struct Product : public BinaryNode<A,B>
+{
+  static inline double Evaluate(const double *in, const double *p)
+  { return A::Evaluate(in, p) * B::Evaluate(in, p); }
+};
+
+/** Quotient A / B, zero where |B| < 1e-5 as in itk::DivideOrZeroOutImageFilter */
+template <class A, class B>
+struct QuotientOrZero : public BinaryNode<A,B>
+{
+  static inline double Evaluate(const double *in, const double *p)
+  {
+    const double b = B::Evaluate(in, p);
+    if(std::abs(b) < 1e-5)
+      return 0.;
+    return A::Evaluate(in, p) / b;
+  }
+};
+
+template <class A, class B>
+struct Maximum : public BinaryNode<A,B>
+{
+  static inline double Evaluate(const double *in, const double *p)
+  {
+    const double a = A::Evaluate(in, p);
+    const double b = B::Evaluate(in, p);
+    return (a<b)?b:a;
+  }
+};
+
+} // end namespace Expression
+
+/** \class ExpressionImageFilter
+ * \brief Evaluates a pointwise expression of several images in one pass.
+ *
+ * The chains of itk arithmetic filters of the iterative reconstruction
+ * filters allocate an image and go over all pixels at each step. This filter
+ * evaluates a whole expression, see the Expression namespace, in a single
+ * threaded pass over its inputs. The number of inputs is the number of
+ * Input nodes of the expression, all inputs must have the same largest
+ * possible region. The parameters are set with SetParameter.
+ *
+ * The filter can run in place, the output then reuses the buffer of input 0.
+ * This is disabled by default, it must only be enabled when input 0 is not
+ * used after the filter has been updated.
+ *
+ * \ingroup IntensityImageFilters
+ */
+template <class TImage, class TExpression>
+class ITK_EXPORT ExpressionImageFilter :
+  public itk::InPlaceImageFilter<TImage, TImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ExpressionImageFilter                  Self;
+  typedef itk::InPlaceImageFilter<TImage,TImage> Superclass;
+  typedef itk::SmartPointer<Self>                Pointer;
+  typedef itk::SmartPointer<const Self>          ConstPointer;
+
+  /** Useful typedefs. */
+  typedef TExpression                            ExpressionType;
+  typedef typename TImage::RegionType            OutputImageRegionType;
+  typedef typename TImage::PixelType             PixelType;
+
+  itkStaticConstMacro(NumberOfInputs, unsigned int, TExpression::NumberOfInputs);
+  itkStaticConstMacro(NumberOfParameters, unsigned int, TExpression::NumberOfParameters);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ExpressionImageFilter, itk::InPlaceImageFilter);
+
+  /** Get / Set parameter i of the expression. Default is 0. */
+  double GetParameter(unsigned int i) const;
+  void SetParameter(unsigned int i, double value);
+
+protected:
+  ExpressionImageFilter();
+  ~ExpressionImageFilter() {}
+
+  void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
+
+private:
+  ExpressionImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);        //purposely not implemented
+
+  std::vector<double> m_Parameters;
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkExpressionImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkExpressionImageFilter_hxx
+#define rtkExpressionImageFilter_hxx
+
+#include "rtkExpressionImageFilter.h"
+
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+#include <algorithm>
+
+namespace rtk
+{
+
+template <class TImage, class TExpression>
+ExpressionImageFilter<TImage, TExpression>
+::ExpressionImageFilter():
+  m_Parameters(std::max((unsigned int)TExpression::NumberOfParameters, 1u), 0.)
+{
+  this->SetNumberOfRequiredInputs(TExpression::NumberOfInputs);
+  this->SetInPlace(false);
+}
+
+template <class TImage, class TExpression>
+double
+ExpressionImageFilter<TImage, TExpression>
+::GetParameter(unsigned int i) const
+{
+  if(i >= TExpression::NumberOfParameters)
+    itkExceptionMacro(<< "The expression has " << TExpression::NumberOfParameters << " parameters");
+  return m_Parameters[i];
+}
+
+template <class TImage, class TExpression>
+void
+ExpressionImageFilter<TImage, TExpression>
+::SetParameter(unsigned int i, double value)
+{
+  if(i >= TExpression::NumberOfParameters)
+    itkExceptionMacro(<< "The expression has " << TExpression::NumberOfParameters << " parameters");
+  if(m_Parameters[i] != value)
+    {
+    m_Parameters[i] = value;
+    this->Modified();
+    }
+}
+
+template <class TImage, class TExpression>
+void
+ExpressionImageFilter<TImage, TExpression>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId) )
+{
+  const unsigned int nInputs = TExpression::NumberOfInputs;
+
+  // All input pixels are read before the output pixel is written, which
+  // allows in place computation
+  typedef itk::ImageRegionConstIterator<TImage> InputIteratorType;
+  std::vector<InputIteratorType> itIn;
+  for(unsigned int i=0; i<nInputs; i++)
+    itIn.push_back( InputIteratorType(this->GetInput(i), outputRegionForThread) );
+  itk::ImageRegionIterator<TImage> itOut(this->GetOutput(), outputRegionForThread);
+
+  double values[TExpression::NumberOfInputs];
+  const double *parameters = &(m_Parameters[0]);
+  while(!itOut.IsAtEnd())
+    {
+    for(unsigned int i=0; i<nInputs; i++)
+      {
+      values[i] = itIn[i].Get();
+      ++(itIn[i]);
+      }
+    itOut.Set( static_cast<PixelType>( TExpression::Evaluate(values, parameters) ) );
+    ++itOut;
+    }
+}
+
+} // end namespace rtk
+
+#endif
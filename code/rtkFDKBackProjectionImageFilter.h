@@ -21,6 +21,8 @@
 
 #include "rtkBackProjectionImageFilter.h"
 
+#include <vector>
+
 namespace rtk
 {
 
@@ -31,6 +33,15 @@ namespace rtk
  * [Feldkamp, Davis, Kress, 1984] algorithm for filtered backprojection
  * reconstruction of cone-beam CT images with a circular source trajectory.
  *
+ * The projections of the input stack are extracted (and transposed) once in
+ * BeforeThreadedGenerateData and the copies are shared by all threads.
+ * Projections can be backprojected by blocks, see
+ * BackProjectionImageFilter::SetProjectionBlockSize.
+ *
+ * The loops along rows and columns of voxels are clipped to the voxels which
+ * project inside the detector and, optionally, inside the cylindrical field
+ * of view (see BackProjectionImageFilter::SetFOVRadius).
+ *
  * \author Simon Rit
  *
  * \ingroup Projector
@@ -57,13 +68,26 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(FDKBackProjectionImageFilter, ImageToImageFilter);
 
+  /** Interpolation in the projections. Each value selects an instantiation
+   * of the backprojection loops with the corresponding interpolator of
+   * rtkBackProjectionInterpolators.h, there is no test in the inner loops. */
+  typedef enum {NEAREST=0, BILINEAR=1, BICUBIC=2} InterpolationType;
+
+  /** Get / Set the interpolation, bilinear by default. */
+  itkGetMacro(Interpolation, InterpolationType);
+  itkSetMacro(Interpolation, InterpolationType);
+
 protected:
-  FDKBackProjectionImageFilter() {};
+  FDKBackProjectionImageFilter() : m_Interpolation(BILINEAR) {};
   ~FDKBackProjectionImageFilter() {}
 
   void GenerateOutputInformation() ITK_OVERRIDE;
 
-  void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  void AfterThreadedGenerateData() ITK_OVERRIDE;
+
+  void ThreadedBackprojection( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
 
   /** Optimized version when the rotation is parallel to X, i.e. matrix[1][0]
     and matrix[2][0] are zeros. */
@@ -75,9 +99,39 @@ protected:
   void OptimizedBackprojectionY(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
                                         const ProjectionImagePointer projection) ITK_OVERRIDE;
 
+  /** Version for any other geometry, with the FDK weighting and SIMD
+    packets of voxels along each row of the volume. */
+  void ProjectiveBackprojection(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                                const ProjectionImagePointer projection) ITK_OVERRIDE;
+
+  /** Implementations of the three backprojections above for a given
+    interpolator, see rtkBackProjectionInterpolators.h. */
+  template <class TInterpolator>
+  void InterpolatedBackprojectionX(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                                   const ProjectionImagePointer projection);
+  template <class TInterpolator>
+  void InterpolatedBackprojectionY(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                                   const ProjectionImagePointer projection);
+
+  /** Backprojection of the voxels [nBegin, nEnd) of column (i,k) along Y,
+    relative to the region index, clipped to the detector. */
+  template <class TInterpolator>
+  void InterpolatedBackprojectionColumnY(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                                         const ProjectionImagePointer projection, const int i, const int k,
+                                         int nBegin, int nEnd);
+  template <class TInterpolator>
+  void InterpolatedProjectiveBackprojection(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                                            const ProjectionImagePointer projection);
+
 private:
   FDKBackProjectionImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&);               //purposely not implemented
+
+  /** Copies of the projections of the input stack in the layout used by
+      the backprojection, read-only during ThreadedGenerateData. */
+  std::vector<ProjectionImagePointer> m_ProjectionsCache;
+
+  InterpolationType m_Interpolation;
 };
 
 } // end namespace rtk
@@ -19,10 +19,11 @@
 #ifndef rtkFDKBackProjectionImageFilter_hxx
 #define rtkFDKBackProjectionImageFilter_hxx
 
-#include <itkImageRegionIteratorWithIndex.h>
-#include <itkLinearInterpolateImageFunction.h>
+#include "rtkBackProjectionInterpolators.h"
 
-#define BILINEAR_BACKPROJECTION
+#include <itkImageRegionIterator.h>
+
+#include <algorithm>
 
 namespace rtk
 {
@@ -42,27 +43,47 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
   Superclass::GenerateOutputInformation();
 }
 
+template <class TInputImage, class TOutputImage>
+void
+FDKBackProjectionImageFilter<TInputImage,TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  // Extract each projection once for all threads
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const unsigned int nProj = this->GetInput(1)->GetLargestPossibleRegion().GetSize(Dimension-1);
+  const unsigned int iFirstProj = this->GetInput(1)->GetLargestPossibleRegion().GetIndex(Dimension-1);
+  m_ProjectionsCache.resize(nProj);
+  for(unsigned int iProj=iFirstProj; iProj<iFirstProj+nProj; iProj++)
+    m_ProjectionsCache[iProj-iFirstProj] = this->template GetProjection< ProjectionImageType >(iProj);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKBackProjectionImageFilter<TInputImage,TOutputImage>
+::AfterThreadedGenerateData()
+{
+  m_ProjectionsCache.clear();
+}
+
 /**
- * GenerateData performs the accumulation
+ * ThreadedBackprojection performs the accumulation
  */
 template <class TInputImage, class TOutputImage>
 void
 FDKBackProjectionImageFilter<TInputImage,TOutputImage>
-::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
-                       ThreadIdType itkNotUsed(threadId) )
+::ThreadedBackprojection(const OutputImageRegionType& outputRegionForThread,
+                         ThreadIdType itkNotUsed(threadId) )
 {
   const unsigned int Dimension = TInputImage::ImageDimension;
   const unsigned int nProj = this->GetInput(1)->GetLargestPossibleRegion().GetSize(Dimension-1);
   const unsigned int iFirstProj = this->GetInput(1)->GetLargestPossibleRegion().GetIndex(Dimension-1);
 
-  // Create interpolator, could be any interpolation
-  typedef itk::LinearInterpolateImageFunction< ProjectionImageType, double > InterpolatorType;
-  typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
-
   // Iterators on volume input and output
   typedef itk::ImageRegionConstIterator<TInputImage> InputRegionIterator;
   InputRegionIterator itIn(this->GetInput(), outputRegionForThread);
-  typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
+  typedef itk::ImageRegionIterator<TOutputImage> OutputRegionIterator;
   OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
 
   // Initialize output region with input region in case the filter is not in
@@ -84,64 +105,53 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
   itk::ContinuousIndex<double, Dimension> rotCenterIndex;
   this->GetInput(0)->TransformPhysicalPointToContinuousIndex(rotCenterPoint, rotCenterIndex);
 
-  // Continuous index at which we interpolate
-  itk::ContinuousIndex<double, Dimension-1> pointProj;
+  // Tiles of the thread region, the whole region if projections are not
+  // blocked
+  std::vector<OutputImageRegionType> tiles;
+  this->SplitRegionInProjectionBlockTiles(outputRegionForThread, tiles);
 
-  // Go over each projection
-  for(unsigned int iProj=iFirstProj; iProj<iFirstProj+nProj; iProj++)
+  // Go over each block of projections
+  const unsigned int blockSize = std::max(this->GetProjectionBlockSize(), 1u);
+  std::vector<ProjectionMatrixType> matrices;
+  for(unsigned int iBlock=iFirstProj; iBlock<iFirstProj+nProj; iBlock+=blockSize)
     {
-    // Extract the current slice
-    ProjectionImagePointer projection;
-    projection = this->template GetProjection< ProjectionImageType >(iProj);
-    interpolator->SetInputImage(projection);
-
-    // Index to index matrix normalized to have a correct backprojection weight
-    // (1 at the isocenter)
-    ProjectionMatrixType matrix = this->GetIndexToIndexProjectionMatrix(iProj);
-    double perspFactor = matrix[Dimension-1][Dimension];
-    for(unsigned int j=0; j<Dimension; j++)
-      perspFactor += matrix[Dimension-1][j] * rotCenterIndex[j];
-    matrix /= perspFactor;
-
-    // Optimized version
-    if (fabs(matrix[1][0])<1e-10 && fabs(matrix[2][0])<1e-10)
-      {
-      OptimizedBackprojectionX( outputRegionForThread, matrix, projection);
-      continue;
-      }
-    if (fabs(matrix[1][1])<1e-10 && fabs(matrix[2][1])<1e-10)
+    const unsigned int nBlock = std::min(blockSize, iFirstProj+nProj-iBlock);
+    matrices.resize(nBlock);
+    for(unsigned int b=0; b<nBlock; b++)
       {
-      OptimizedBackprojectionY( outputRegionForThread, matrix, projection);
-      continue;
+      // Index to index matrix normalized to have a correct backprojection weight
+      // (1 at the isocenter)
+      ProjectionMatrixType &matrix = matrices[b];
+      matrix = this->GetIndexToIndexProjectionMatrix(iBlock+b);
+      double perspFactor = matrix[Dimension-1][Dimension];
+      for(unsigned int j=0; j<Dimension; j++)
+        perspFactor += matrix[Dimension-1][j] * rotCenterIndex[j];
+      matrix /= perspFactor;
       }
 
-    // Go over each voxel
-    itOut.GoToBegin();
-    while(!itOut.IsAtEnd() )
+    for(unsigned int t=0; t<tiles.size(); t++)
       {
-      // Compute projection index
-      for(unsigned int i=0; i<Dimension-1; i++)
+      for(unsigned int b=0; b<nBlock; b++)
         {
-        pointProj[i] = matrix[i][Dimension];
-        for(unsigned int j=0; j<Dimension; j++)
-          pointProj[i] += matrix[i][j] * itOut.GetIndex()[j];
-        }
+        // Current slice, extracted in BeforeThreadedGenerateData
+        const ProjectionImagePointer &projection = m_ProjectionsCache[iBlock+b-iFirstProj];
+        const ProjectionMatrixType &matrix = matrices[b];
 
-      // Apply perspective
-      double perspFactor = matrix[Dimension-1][Dimension];
-      for(unsigned int j=0; j<Dimension; j++)
-        perspFactor += matrix[Dimension-1][j] * itOut.GetIndex()[j];
-      perspFactor = 1/perspFactor;
-      for(unsigned int i=0; i<Dimension-1; i++)
-        pointProj[i] = pointProj[i]*perspFactor;
+        // Optimized version
+        if (fabs(matrix[1][0])<1e-10 && fabs(matrix[2][0])<1e-10)
+          {
+          OptimizedBackprojectionX( tiles[t], matrix, projection);
+          continue;
+          }
+        if (fabs(matrix[1][1])<1e-10 && fabs(matrix[2][1])<1e-10)
+          {
+          OptimizedBackprojectionY( tiles[t], matrix, projection);
+          continue;
+          }
 
-      // Interpolate if in projection
-      if( interpolator->IsInsideBuffer(pointProj) )
-        {
-        itOut.Set( itOut.Get() + perspFactor*perspFactor*interpolator->EvaluateAtContinuousIndex(pointProj) );
+        // Any other geometry
+        ProjectiveBackprojection( tiles[t], matrix, projection);
         }
-
-      ++itOut;
       }
     }
 }
@@ -151,21 +161,85 @@ void
 FDKBackProjectionImageFilter<TInputImage,TOutputImage>
 ::OptimizedBackprojectionX(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
                            const ProjectionImagePointer projection)
+{
+  typedef typename TInputImage::PixelType ProjectionPixelType;
+  switch(m_Interpolation)
+    {
+    case NEAREST:
+      InterpolatedBackprojectionX< Functor::NearestBackProjectionInterpolation<ProjectionPixelType> >(region, matrix, projection);
+      break;
+    case BICUBIC:
+      InterpolatedBackprojectionX< Functor::BicubicBackProjectionInterpolation<ProjectionPixelType> >(region, matrix, projection);
+      break;
+    default:
+      InterpolatedBackprojectionX< Functor::BilinearBackProjectionInterpolation<ProjectionPixelType> >(region, matrix, projection);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKBackProjectionImageFilter<TInputImage,TOutputImage>
+::OptimizedBackprojectionY(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                           const ProjectionImagePointer projection)
+{
+  typedef typename TInputImage::PixelType ProjectionPixelType;
+  switch(m_Interpolation)
+    {
+    case NEAREST:
+      InterpolatedBackprojectionY< Functor::NearestBackProjectionInterpolation<ProjectionPixelType> >(region, matrix, projection);
+      break;
+    case BICUBIC:
+      InterpolatedBackprojectionY< Functor::BicubicBackProjectionInterpolation<ProjectionPixelType> >(region, matrix, projection);
+      break;
+    default:
+      InterpolatedBackprojectionY< Functor::BilinearBackProjectionInterpolation<ProjectionPixelType> >(region, matrix, projection);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FDKBackProjectionImageFilter<TInputImage,TOutputImage>
+::ProjectiveBackprojection(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                           const ProjectionImagePointer projection)
+{
+  typedef typename TInputImage::PixelType ProjectionPixelType;
+  switch(m_Interpolation)
+    {
+    case NEAREST:
+      InterpolatedProjectiveBackprojection< Functor::NearestBackProjectionInterpolation<ProjectionPixelType> >(region, matrix, projection);
+      break;
+    case BICUBIC:
+      InterpolatedProjectiveBackprojection< Functor::BicubicBackProjectionInterpolation<ProjectionPixelType> >(region, matrix, projection);
+      break;
+    default:
+      InterpolatedProjectiveBackprojection< Functor::BilinearBackProjectionInterpolation<ProjectionPixelType> >(region, matrix, projection);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+template <class TInterpolator>
+void
+FDKBackProjectionImageFilter<TInputImage,TOutputImage>
+::InterpolatedBackprojectionX(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                              const ProjectionImagePointer projection)
 {
   typename ProjectionImageType::SizeType pSize = projection->GetBufferedRegion().GetSize();
   typename ProjectionImageType::IndexType pIndex = projection->GetBufferedRegion().GetIndex();
   typename TOutputImage::SizeType vBufferSize = this->GetOutput()->GetBufferedRegion().GetSize();
   typename TOutputImage::IndexType vBufferIndex = this->GetOutput()->GetBufferedRegion().GetIndex();
-  typename TInputImage::PixelType *pProj;
   typename TOutputImage::PixelType *pVol, *pVolZeroPointer;
 
   // Pointers in memory to index (0,0,0) which do not necessarily exist
   pVolZeroPointer = this->GetOutput()->GetBufferPointer();
   pVolZeroPointer -= vBufferIndex[0] + vBufferSize[0] * (vBufferIndex[1] + vBufferSize[1] * vBufferIndex[2]);
 
+  // Valid continuous indices for the interpolation
+  const double lowerBound = TInterpolator::LowerBound();
+  const double uUpperBound = pSize[0] - TInterpolator::UpperMargin();
+  const double vUpperBound = pSize[1] - TInterpolator::UpperMargin();
+
   // Continuous index at which we interpolate
   double u, v, w;
-  int    ui, vi;
   double du;
 
   for(int k=region.GetIndex(2); k<region.GetIndex(2)+(int)region.GetSize(2); k++)
@@ -184,58 +258,57 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
       du = w * matrix[0][0];
       w *= w;
 
-#ifdef BILINEAR_BACKPROJECTION
-      double u1, u2, v1, v2;
-      vi = vnl_math_floor(v);
-      if(vi>=0 && vi<(int)pSize[1]-1)
-        {
-        v1 = v-vi;
-        v2 = 1.0-v1;
-#else
-      vi = itk::Math::Round<double>(v)-pIndex[1];
-      if(vi>=0 && vi<(int)pSize[1])
-        {
-#endif
+      if(v<lowerBound || v>=vUpperBound)
+        continue;
+      const TInterpolator interpolator(projection->GetBufferPointer(), (int)pSize[0], (int)pSize[1], v);
+
+      // Voxels of the row inside the detector and the FOV
+      int nBegin = 0;
+      int nEnd = region.GetSize(0);
+      ClipBackProjectionInterval(u-lowerBound, du, uUpperBound-lowerBound, nBegin, nEnd);
+      typename TOutputImage::IndexType first = {{i, j, k}};
+      this->ClipToFieldOfView(first, 0, nBegin, nEnd);
 
-        pProj = projection->GetBufferPointer() + vi * pSize[0];
-        pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
+      pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
+      int n = nBegin;
 
-        // Innermost loop
-        for(; i<(region.GetIndex(0) + (int)region.GetSize(0)); i++, u += du, pVol++)
+      // SIMD version, packets of consecutive voxels of the row
+      const unsigned int nPackets = (nEnd - nBegin) / BackProjectionPacketSize;
+      if(nPackets)
+        {
+        float pu[BackProjectionPacketSize], pdu[BackProjectionPacketSize];
+        float pv[BackProjectionPacketSize], pw[BackProjectionPacketSize];
+        for(unsigned int l=0; l<BackProjectionPacketSize; l++)
           {
-#ifdef BILINEAR_BACKPROJECTION
-          ui = vnl_math_floor(u);
-          if(ui>=0 && ui<(int)pSize[0]-1)
-            {
-            u1 = u-ui;
-            u2 = 1.0-u1;
-            *pVol += w * (v2 * (u2 * *(pProj+ui)          + u1 * *(pProj+ui+1) ) +
-                          v1 * (u2 * *(pProj+ui+pSize[0]) + u1 * *(pProj+ui+pSize[0]+1) ) );
-            }
-#else
-          ui = itk::Math::Round<double>(u);
-          if(ui>=0 && ui<(int)pSize[0])
-            {
-            *pVol += w * *(pProj+ui);
-            }
-#endif
-          } //i
+          pu[l] = u + (n+(int)l) * du;
+          pdu[l] = BackProjectionPacketSize * du;
+          pv[l] = v;
+          pw[l] = w;
+          }
+        if( TInterpolator::BackProjectPacket(pVol+n, BackProjectionPacketSize, nPackets,
+                                             projection->GetBufferPointer(), (int)pSize[0], (int)pSize[1],
+                                             pu, pdu, pv, pw) )
+          n += nPackets * BackProjectionPacketSize;
         }
+
+      // Innermost loop, without test since the interval has been clipped
+      for(; n<nEnd; n++)
+        pVol[n] += w * interpolator(u + n * du);
       } //j
     } //k
 }
 
 template <class TInputImage, class TOutputImage>
+template <class TInterpolator>
 void
 FDKBackProjectionImageFilter<TInputImage,TOutputImage>
-::OptimizedBackprojectionY(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
-                           const ProjectionImagePointer projection)
+::InterpolatedBackprojectionY(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                              const ProjectionImagePointer projection)
 {
   typename ProjectionImageType::SizeType pSize = projection->GetBufferedRegion().GetSize();
   typename ProjectionImageType::IndexType pIndex = projection->GetBufferedRegion().GetIndex();
   typename TOutputImage::SizeType vBufferSize = this->GetOutput()->GetBufferedRegion().GetSize();
   typename TOutputImage::IndexType vBufferIndex = this->GetOutput()->GetBufferedRegion().GetIndex();
-  typename TInputImage::PixelType *pProj;
   typename TOutputImage::PixelType *pVol, *pVolZeroPointer;
 
   // Pointers in memory to index (0,0,0) which do not necessarily exist
@@ -244,61 +317,232 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
 
   // Continuous index at which we interpolate
   double u, v, w;
-  int    ui, vi;
-  double du;
 
   for(int k=region.GetIndex(2); k<region.GetIndex(2)+(int)region.GetSize(2); k++)
     {
-    for(int i=region.GetIndex(0); i<region.GetIndex(0)+(int)region.GetSize(0); i++)
+    int i = region.GetIndex(0);
+
+    // SIMD version, packets of consecutive columns processed simultaneously
+    // along the j direction
+    for(; i+(int)BackProjectionPacketSize<=region.GetIndex(0)+(int)region.GetSize(0); i+=BackProjectionPacketSize)
       {
       int j = region.GetIndex(1);
-      u = matrix[0][0] * i + matrix[0][1] * j + matrix[0][2] * k + matrix[0][3];
-      v = matrix[1][0] * i +                    matrix[1][2] * k + matrix[1][3];
-      w = matrix[2][0] * i +                    matrix[2][2] * k + matrix[2][3];
+      float pu[BackProjectionPacketSize], pdu[BackProjectionPacketSize];
+      float pv[BackProjectionPacketSize], pw[BackProjectionPacketSize];
+      for(unsigned int l=0; l<BackProjectionPacketSize; l++)
+        {
+        u = matrix[0][0] * (i+(int)l) + matrix[0][1] * j + matrix[0][2] * k + matrix[0][3];
+        v = matrix[1][0] * (i+(int)l) +                    matrix[1][2] * k + matrix[1][3];
+        w = matrix[2][0] * (i+(int)l) +                    matrix[2][2] * k + matrix[2][3];
+
+        //Apply perspective
+        w = 1/w;
+        pu[l] = u*w-pIndex[0];
+        pv[l] = v*w-pIndex[1];
+        pdu[l] = w * matrix[0][1];
+        pw[l] = w*w;
+        }
 
-      //Apply perspective
-      w = 1/w;
-      u = u*w-pIndex[0];
-      v = v*w-pIndex[1];
-      du = w * matrix[0][1];
-      w *= w;
+      // The kernel processes the intersection of the FOV intervals of the
+      // columns of the packet, the detector boundaries are handled by the
+      // kernel. The voxels of each column outside the intersection are
+      // backprojected one column at a time below.
+      int lBegin[BackProjectionPacketSize], lEnd[BackProjectionPacketSize];
+      int nBegin = 0;
+      int nEnd = region.GetSize(1);
+      for(unsigned int l=0; l<BackProjectionPacketSize; l++)
+        {
+        lBegin[l] = 0;
+        lEnd[l] = region.GetSize(1);
+        typename TOutputImage::IndexType first = {{i+(int)l, j, k}};
+        this->ClipToFieldOfView(first, 1, lBegin[l], lEnd[l]);
+        nBegin = std::max(nBegin, lBegin[l]);
+        nEnd = std::min(nEnd, lEnd[l]);
+        }
+      if(nBegin<nEnd)
+        {
+        for(unsigned int l=0; l<BackProjectionPacketSize; l++)
+          pu[l] += nBegin * pdu[l];
+
+        pVol = pVolZeroPointer + i + vBufferSize[0] * (j + nBegin + k * vBufferSize[1] );
+        if( !TInterpolator::BackProjectPacket(pVol, vBufferSize[0], nEnd - nBegin,
+                                              projection->GetBufferPointer(), (int)pSize[0], (int)pSize[1],
+                                              pu, pdu, pv, pw) )
+          break;
+        }
+      else
+        nBegin = nEnd = region.GetSize(1);
 
-#ifdef BILINEAR_BACKPROJECTION
-      vi = vnl_math_floor(v);
-      if(vi>=0 && vi<(int)pSize[1]-1)
+      for(unsigned int l=0; l<BackProjectionPacketSize; l++)
         {
-#else
-      vi = itk::Math::Round<double>(v);
-      if(vi>=0 && vi<(int)pSize[1])
+        InterpolatedBackprojectionColumnY<TInterpolator>(region, matrix, projection, i+(int)l, k,
+                                                         lBegin[l], std::min(lEnd[l], nBegin));
+        InterpolatedBackprojectionColumnY<TInterpolator>(region, matrix, projection, i+(int)l, k,
+                                                         std::max(lBegin[l], nEnd), lEnd[l]);
+        }
+      }
+
+    for(; i<region.GetIndex(0)+(int)region.GetSize(0); i++)
+      {
+      // Voxels of the column inside the FOV
+      int nBegin = 0;
+      int nEnd = region.GetSize(1);
+      typename TOutputImage::IndexType first = {{i, region.GetIndex(1), k}};
+      this->ClipToFieldOfView(first, 1, nBegin, nEnd);
+      InterpolatedBackprojectionColumnY<TInterpolator>(region, matrix, projection, i, k, nBegin, nEnd);
+      } //i
+    } //k
+}
+
+template <class TInputImage, class TOutputImage>
+template <class TInterpolator>
+void
+FDKBackProjectionImageFilter<TInputImage,TOutputImage>
+::InterpolatedBackprojectionColumnY(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                                    const ProjectionImagePointer projection, const int i, const int k,
+                                    int nBegin, int nEnd)
+{
+  if(nBegin>=nEnd)
+    return;
+
+  typename ProjectionImageType::SizeType pSize = projection->GetBufferedRegion().GetSize();
+  typename ProjectionImageType::IndexType pIndex = projection->GetBufferedRegion().GetIndex();
+  typename TOutputImage::SizeType vBufferSize = this->GetOutput()->GetBufferedRegion().GetSize();
+  typename TOutputImage::IndexType vBufferIndex = this->GetOutput()->GetBufferedRegion().GetIndex();
+  typename TOutputImage::PixelType *pVol;
+
+  // Valid continuous indices for the interpolation
+  const double lowerBound = TInterpolator::LowerBound();
+  const double uUpperBound = pSize[0] - TInterpolator::UpperMargin();
+  const double vUpperBound = pSize[1] - TInterpolator::UpperMargin();
+
+  const int j = region.GetIndex(1);
+  double u = matrix[0][0] * i + matrix[0][1] * j + matrix[0][2] * k + matrix[0][3];
+  double v = matrix[1][0] * i +                    matrix[1][2] * k + matrix[1][3];
+  double w = matrix[2][0] * i +                    matrix[2][2] * k + matrix[2][3];
+
+  //Apply perspective
+  w = 1/w;
+  u = u*w-pIndex[0];
+  v = v*w-pIndex[1];
+  const double du = w * matrix[0][1];
+  w *= w;
+
+  if(v<lowerBound || v>=vUpperBound)
+    return;
+  const TInterpolator interpolator(projection->GetBufferPointer(), (int)pSize[0], (int)pSize[1], v);
+
+  // Voxels of [nBegin, nEnd) inside the detector
+  ClipBackProjectionInterval(u-lowerBound, du, uUpperBound-lowerBound, nBegin, nEnd);
+
+  // Innermost loop, without test since the interval has been clipped
+  pVol = this->GetOutput()->GetBufferPointer();
+  pVol += i - vBufferIndex[0] + vBufferSize[0] * (j + nBegin - vBufferIndex[1] + vBufferSize[1] * (k - vBufferIndex[2]));
+  for(int n=nBegin; n<nEnd; n++, pVol += vBufferSize[0])
+    *pVol += w * interpolator(u + n * du);
+}
+
+template <class TInputImage, class TOutputImage>
+template <class TInterpolator>
+void
+FDKBackProjectionImageFilter<TInputImage,TOutputImage>
+::InterpolatedProjectiveBackprojection(const OutputImageRegionType& region, const ProjectionMatrixType& matrix,
+                                       const ProjectionImagePointer projection)
+{
+  typename ProjectionImageType::SizeType pSize = projection->GetBufferedRegion().GetSize();
+  typename ProjectionImageType::IndexType pIndex = projection->GetBufferedRegion().GetIndex();
+  typename TOutputImage::SizeType vBufferSize = this->GetOutput()->GetBufferedRegion().GetSize();
+  typename TOutputImage::IndexType vBufferIndex = this->GetOutput()->GetBufferedRegion().GetIndex();
+  typename TOutputImage::PixelType *pVol, *pVolZeroPointer;
+
+  // Pointers in memory to index (0,0,0) which do not necessarily exist
+  pVolZeroPointer = this->GetOutput()->GetBufferPointer();
+  pVolZeroPointer -= vBufferIndex[0] + vBufferSize[0] * (vBufferIndex[1] + vBufferSize[1] * vBufferIndex[2]);
+
+  // Valid continuous indices for the interpolation
+  const double lowerBound = TInterpolator::LowerBound();
+  const double uUpperBound = pSize[0] - TInterpolator::UpperMargin();
+  const double vUpperBound = pSize[1] - TInterpolator::UpperMargin();
+
+  // Account for the index of the projection buffer in the matrix so that the
+  // homogeneous coordinates directly give the offset in the buffer
+  ProjectionMatrixType m = matrix;
+  for(unsigned int j=0; j<4; j++)
+    {
+    m[0][j] -= pIndex[0] * matrix[2][j];
+    m[1][j] -= pIndex[1] * matrix[2][j];
+    }
+
+  // Homogeneous coordinates and their increments along i
+  double uh, vh, wh;
+  const double duh = m[0][0];
+  const double dvh = m[1][0];
+  const double dwh = m[2][0];
+
+  // Continuous index at which we interpolate
+  double u, v, w;
+
+  for(int k=region.GetIndex(2); k<region.GetIndex(2)+(int)region.GetSize(2); k++)
+    {
+    for(int j=region.GetIndex(1); j<region.GetIndex(1)+(int)region.GetSize(1); j++)
+      {
+      // Voxels of the row inside the FOV
+      int nBegin = 0;
+      int nEnd = region.GetSize(0);
+      typename TOutputImage::IndexType first = {{region.GetIndex(0), j, k}};
+      this->ClipToFieldOfView(first, 0, nBegin, nEnd);
+      const int iEnd = region.GetIndex(0) + nEnd;
+
+      int i = region.GetIndex(0) + nBegin;
+      uh = m[0][0] * i + m[0][1] * j + m[0][2] * k + m[0][3];
+      vh = m[1][0] * i + m[1][1] * j + m[1][2] * k + m[1][3];
+      wh = m[2][0] * i + m[2][1] * j + m[2][2] * k + m[2][3];
+      pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
+
+      // SIMD version, packets of consecutive voxels of the row
+      const unsigned int nPackets = (iEnd - i) / BackProjectionPacketSize;
+      if(nPackets)
         {
-#endif
-        pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
-        for(; j<(region.GetIndex(1) + (int)region.GetSize(1)); j++, pVol += vBufferSize[0], u += du)
+        float puh[BackProjectionPacketSize], pvh[BackProjectionPacketSize], pwh[BackProjectionPacketSize];
+        float pduh[BackProjectionPacketSize], pdvh[BackProjectionPacketSize], pdwh[BackProjectionPacketSize];
+        for(unsigned int l=0; l<BackProjectionPacketSize; l++)
           {
-#ifdef BILINEAR_BACKPROJECTION
-          ui = vnl_math_floor(u);
-          if(ui>=0 && ui<(int)pSize[0]-1)
-            {
-            double u1, u2, v1, v2;
-            pProj = projection->GetBufferPointer() + vi * pSize[0] + ui;
-            v1 = v-vi;
-            v2 = 1.0-v1;
-            u1 = u-ui;
-            u2 = 1.0-u1;
-            *pVol += w * (v2 * (u2 * *(pProj)          + u1 * *(pProj+1) ) +
-                          v1 * (u2 * *(pProj+pSize[0]) + u1 * *(pProj+pSize[0]+1) ) );
-            }
-#else
-          ui = itk::Math::Round<double>(u);
-          if(ui>=0 && ui<(int)pSize[0])
-            {
-            pProj = projection->GetBufferPointer() + vi * pSize[0];
-            *pVol += w * *(pProj+ui);
-            }
-#endif
-          } //j
+          puh[l] = uh + l * duh;
+          pvh[l] = vh + l * dvh;
+          pwh[l] = wh + l * dwh;
+          pduh[l] = BackProjectionPacketSize * duh;
+          pdvh[l] = BackProjectionPacketSize * dvh;
+          pdwh[l] = BackProjectionPacketSize * dwh;
+          }
+        if( TInterpolator::BackProjectProjectivePacket(pVol, BackProjectionPacketSize, nPackets,
+                                                       projection->GetBufferPointer(), (int)pSize[0], (int)pSize[1],
+                                                       puh, pvh, pwh, pduh, pdvh, pdwh) )
+          {
+          const unsigned int nVoxels = nPackets * BackProjectionPacketSize;
+          i += nVoxels;
+          uh += nVoxels * duh;
+          vh += nVoxels * dvh;
+          wh += nVoxels * dwh;
+          pVol += nVoxels;
+          }
         }
-      } //i
+
+      // Innermost loop
+      for(; i<iEnd; i++, uh += duh, vh += dvh, wh += dwh, pVol++)
+        {
+        //Apply perspective
+        w = 1/wh;
+        u = uh*w;
+        v = vh*w;
+        w *= w;
+
+        if(u>=lowerBound && u<uUpperBound && v>=lowerBound && v<vUpperBound)
+          {
+          const TInterpolator interpolator(projection->GetBufferPointer(), (int)pSize[0], (int)pSize[1], v);
+          *pVol += w * interpolator(u);
+          }
+        } //i
+      } //j
     } //k
 }
 
@@ -26,6 +26,12 @@
 
 #include <itkExtractImageFilter.h>
 #include <itkTimeProbe.h>
+#include <itkMultiThreader.h>
+#include <itkMutexLock.h>
+#include <itkConditionVariable.h>
+
+#include <deque>
+#include <new>
 
 namespace rtk
 {
@@ -42,6 +48,13 @@ namespace rtk
  * controlled with ProjectionSubsetSize) via the use of itk::ExtractImageFilter
  * to extract sub-stacks.
  *
+ * If PipelineDepth is strictly positive, the processing of the sub-stacks is
+ * pipelined: one thread weights and ramp filters the next sub-stacks while
+ * another thread backprojects the current one. Up to PipelineDepth filtered
+ * sub-stacks are queued ahead of the backprojection. In this mode, the ramp
+ * filter is applied to the full sub-stack instead of the part required by
+ * the backprojection of the requested region.
+ *
  * \dot
  * digraph FDKConeBeamReconstructionFilter {
  * node [shape=box];
@@ -105,6 +118,13 @@ public:
   itkGetMacro(ProjectionSubsetSize, unsigned int);
   itkSetMacro(ProjectionSubsetSize, unsigned int);
 
+  /** Get / Set the number of filtered sub-stacks of projections which can be
+      queued ahead of the backprojection. 0 disables pipelining, i.e., the
+      filtering and the backprojection of each sub-stack are run one after the
+      other. Default is 0. */
+  itkGetMacro(PipelineDepth, unsigned int);
+  itkSetMacro(PipelineDepth, unsigned int);
+
   /** Get / Set and init the backprojection filter. The set function takes care
    * of initializing the mini-pipeline and the ramp filter must therefore be
    * created before calling this set function. */
@@ -125,6 +145,25 @@ protected:
    * to verify. */
   void VerifyInputInformation() ITK_OVERRIDE {}
 
+  /** Pipelined version of GenerateData, used when PipelineDepth is not 0. */
+  virtual void PipelinedGenerateData();
+
+  /** Thread callbacks of the pipelined mode: the first one weights and ramp
+      filters the sub-stacks, the second one backprojects them. */
+  static ITK_THREAD_RETURN_TYPE FilterSubsetsCallback(void *arg);
+  static ITK_THREAD_RETURN_TYPE BackProjectSubsetsCallback(void *arg);
+
+  /** Types of the exceptions which are rethrown with their own type in the
+      calling thread by the pipelined mode. The other exceptions are rethrown
+      as itk::ExceptionObject with the same description, location, file and
+      line. */
+  typedef enum {GENERIC_EXCEPTION=0, PROCESS_ABORTED=1, MEMORY_ALLOCATION_ERROR=2, BAD_ALLOC=3} PipelineExceptionType;
+
+  /** Stops both threads of the pipelined mode after an exception in one of
+      them. The first exception is kept and rethrown by
+      PipelinedGenerateData in the calling thread. */
+  void AbortPipeline(const itk::ExceptionObject &err, PipelineExceptionType type=GENERIC_EXCEPTION);
+
   /** Pointers to each subfilter of this composite filter */
   typename ExtractFilterType::Pointer m_ExtractFilter;
   typename WeightFilterType::Pointer  m_WeightFilter;
@@ -139,6 +178,18 @@ private:
   /** Number of projections processed at a time. */
   unsigned int m_ProjectionSubsetSize;
 
+  /** Maximum number of filtered sub-stacks waiting for backprojection. */
+  unsigned int m_PipelineDepth;
+
+  /** Queue of filtered sub-stacks shared by the two threads of the pipelined
+      mode and its synchronization objects. */
+  std::deque<typename OutputImageType::Pointer> m_FilteredSubsets;
+  itk::SimpleMutexLock                          m_PipelineMutex;
+  itk::ConditionVariable::Pointer               m_PipelineCondition;
+  bool                                          m_PipelineAbort;
+  itk::ExceptionObject                          m_PipelineException;
+  PipelineExceptionType                         m_PipelineExceptionType;
+
   /** Probes to time reconstruction */
   itk::TimeProbe m_PreFilterProbe;
   itk::TimeProbe m_FilterProbe;
@@ -25,7 +25,10 @@ namespace rtk
 template<class TInputImage, class TOutputImage, class TFFTPrecision>
 FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
 ::FDKConeBeamReconstructionFilter():
-  m_ProjectionSubsetSize(16)
+  m_ProjectionSubsetSize(16),
+  m_PipelineDepth(0),
+  m_PipelineAbort(false),
+  m_PipelineExceptionType(GENERIC_EXCEPTION)
 {
   this->SetNumberOfRequiredInputs(2);
 
@@ -34,6 +37,7 @@ FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
   m_WeightFilter = WeightFilterType::New();
   m_RampFilter = RampFilterType::New();
   this->SetBackProjectionFilter( BackProjectionFilterType::New() );
+  m_PipelineCondition = itk::ConditionVariable::New();
 
   //Permanent internal connections
   m_WeightFilter->SetInput( m_ExtractFilter->GetOutput() );
@@ -112,42 +116,267 @@ FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
   subsetRegion = this->GetInput(1)->GetLargestPossibleRegion();
   unsigned int nProj = subsetRegion.GetSize( Dimension-1 );
 
-  for(unsigned int i=0; i<nProj; i+=m_ProjectionSubsetSize)
+  if(m_PipelineDepth>0 && nProj>m_ProjectionSubsetSize)
     {
-    // After the first bp update, we need to use its output as input.
-    if(i)
+    this->PipelinedGenerateData();
+    }
+  else
+    {
+    for(unsigned int i=0; i<nProj; i+=m_ProjectionSubsetSize)
       {
-      typename TInputImage::Pointer pimg = m_BackProjectionFilter->GetOutput();
-      pimg->DisconnectPipeline();
-      m_BackProjectionFilter->SetInput( pimg );
+      // After the first bp update, we need to use its output as input.
+      if(i)
+        {
+        typename TInputImage::Pointer pimg = m_BackProjectionFilter->GetOutput();
+        pimg->DisconnectPipeline();
+        m_BackProjectionFilter->SetInput( pimg );
 
-      // Change projection subset
-      subsetRegion.SetIndex( Dimension-1, i );
-      subsetRegion.SetSize( Dimension-1, std::min(m_ProjectionSubsetSize, nProj-i) );
-      m_ExtractFilter->SetExtractionRegion(subsetRegion);
+        // Change projection subset
+        subsetRegion.SetIndex( Dimension-1, i );
+        subsetRegion.SetSize( Dimension-1, std::min(m_ProjectionSubsetSize, nProj-i) );
+        m_ExtractFilter->SetExtractionRegion(subsetRegion);
 
-      // This is required to reset the full pipeline
-      m_BackProjectionFilter->GetOutput()->UpdateOutputInformation();
-      m_BackProjectionFilter->GetOutput()->PropagateRequestedRegion();
-      }
+        // This is required to reset the full pipeline
+        m_BackProjectionFilter->GetOutput()->UpdateOutputInformation();
+        m_BackProjectionFilter->GetOutput()->PropagateRequestedRegion();
+        }
 
-    m_PreFilterProbe.Start();
-    m_WeightFilter->Update();
-    m_PreFilterProbe.Stop();
+      m_PreFilterProbe.Start();
+      m_WeightFilter->Update();
+      m_PreFilterProbe.Stop();
 
-    m_FilterProbe.Start();
-    m_RampFilter->Update();
-    m_FilterProbe.Stop();
+      m_FilterProbe.Start();
+      m_RampFilter->Update();
+      m_FilterProbe.Stop();
 
-    m_BackProjectionProbe.Start();
-    m_BackProjectionFilter->Update();
-    m_BackProjectionProbe.Stop();
+      m_BackProjectionProbe.Start();
+      m_BackProjectionFilter->Update();
+      m_BackProjectionProbe.Stop();
+      }
     }
 
   this->GraftOutput( m_BackProjectionFilter->GetOutput() );
   this->GenerateOutputInformation();
 }
 
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::PipelinedGenerateData()
+{
+  m_FilteredSubsets.clear();
+  m_PipelineAbort = false;
+  m_PipelineExceptionType = GENERIC_EXCEPTION;
+
+  // One thread for the weighting and the ramp filtering, one thread for the
+  // backprojection. Each filter is itself multithreaded.
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(2);
+  threader->SetMultipleMethod(0, FilterSubsetsCallback, this);
+  threader->SetMultipleMethod(1, BackProjectSubsetsCallback, this);
+  threader->MultipleMethodExecute();
+
+  // Restore the permanent connection of the mini-pipeline
+  m_FilteredSubsets.clear();
+  m_BackProjectionFilter->SetInput( 1, m_RampFilter->GetOutput() );
+
+  // Rethrow the exception of the threads in the calling thread. The
+  // exception object has been copied as an itk::ExceptionObject, the
+  // exceptions which are handled differently by the callers, in particular
+  // itk::ProcessAborted by the itk pipeline, are rebuilt with their type.
+  if(m_PipelineAbort)
+    {
+    switch(m_PipelineExceptionType)
+      {
+      case BAD_ALLOC:
+        throw std::bad_alloc();
+      case PROCESS_ABORTED:
+        {
+        itk::ProcessAborted err(m_PipelineException.GetFile(), m_PipelineException.GetLine());
+        err.SetDescription(m_PipelineException.GetDescription());
+        err.SetLocation(m_PipelineException.GetLocation());
+        throw err;
+        }
+      case MEMORY_ALLOCATION_ERROR:
+        throw itk::MemoryAllocationError(m_PipelineException.GetFile(),
+                                         m_PipelineException.GetLine(),
+                                         m_PipelineException.GetDescription(),
+                                         m_PipelineException.GetLocation());
+      default:
+        throw m_PipelineException;
+      }
+    }
+}
+
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::AbortPipeline(const itk::ExceptionObject &err, PipelineExceptionType type)
+{
+  m_PipelineMutex.Lock();
+  if(!m_PipelineAbort)
+    {
+    m_PipelineAbort = true;
+    m_PipelineException = err;
+    m_PipelineExceptionType = type;
+    }
+  m_PipelineCondition->Broadcast();
+  m_PipelineMutex.Unlock();
+}
+
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+ITK_THREAD_RETURN_TYPE
+FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::FilterSubsetsCallback(void *arg)
+{
+  Self *self = static_cast<Self *>( ((itk::MultiThreader::ThreadInfoStruct *)(arg))->UserData );
+  const unsigned int Dimension = Self::InputImageDimension;
+
+  typename ExtractFilterType::InputImageRegionType subsetRegion;
+  subsetRegion = self->GetInput(1)->GetLargestPossibleRegion();
+  const unsigned int nProj = subsetRegion.GetSize( Dimension-1 );
+  const int iFirstProj = subsetRegion.GetIndex( Dimension-1 );
+
+  try
+    {
+    for(unsigned int i=0; i<nProj; i+=self->m_ProjectionSubsetSize)
+      {
+      // Wait for room in the queue of filtered sub-stacks
+      self->m_PipelineMutex.Lock();
+      while(self->m_FilteredSubsets.size()>=self->m_PipelineDepth && !self->m_PipelineAbort)
+        self->m_PipelineCondition->Wait( &(self->m_PipelineMutex) );
+      const bool abort = self->m_PipelineAbort;
+      self->m_PipelineMutex.Unlock();
+      if(abort)
+        break;
+
+      // Change projection subset
+      subsetRegion.SetIndex( Dimension-1, iFirstProj+i );
+      subsetRegion.SetSize( Dimension-1, std::min(self->m_ProjectionSubsetSize, nProj-i) );
+      self->m_ExtractFilter->SetExtractionRegion(subsetRegion);
+
+      // The ramp filter is disconnected from the backprojection, it processes
+      // the full sub-stack
+      self->m_PreFilterProbe.Start();
+      self->m_WeightFilter->UpdateLargestPossibleRegion();
+      self->m_PreFilterProbe.Stop();
+
+      self->m_FilterProbe.Start();
+      self->m_RampFilter->UpdateLargestPossibleRegion();
+      self->m_FilterProbe.Stop();
+
+      // Hand over the filtered sub-stack to the backprojection thread
+      typename OutputImageType::Pointer filtered = self->m_RampFilter->GetOutput();
+      filtered->DisconnectPipeline();
+
+      self->m_PipelineMutex.Lock();
+      self->m_FilteredSubsets.push_back(filtered);
+      self->m_PipelineCondition->Broadcast();
+      self->m_PipelineMutex.Unlock();
+      }
+    }
+  catch( itk::ProcessAborted & err )
+    {
+    self->AbortPipeline(err, PROCESS_ABORTED);
+    }
+  catch( itk::MemoryAllocationError & err )
+    {
+    self->AbortPipeline(err, MEMORY_ALLOCATION_ERROR);
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    self->AbortPipeline(err);
+    }
+  catch( std::bad_alloc & )
+    {
+    self->AbortPipeline(itk::ExceptionObject(__FILE__, __LINE__, "Memory allocation failed", ITK_LOCATION), BAD_ALLOC);
+    }
+  catch( std::exception & err )
+    {
+    self->AbortPipeline(itk::ExceptionObject(__FILE__, __LINE__, err.what(), ITK_LOCATION));
+    }
+  catch( ... )
+    {
+    self->AbortPipeline(itk::ExceptionObject(__FILE__, __LINE__, "Unknown exception", ITK_LOCATION));
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+ITK_THREAD_RETURN_TYPE
+FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::BackProjectSubsetsCallback(void *arg)
+{
+  Self *self = static_cast<Self *>( ((itk::MultiThreader::ThreadInfoStruct *)(arg))->UserData );
+  const unsigned int Dimension = Self::InputImageDimension;
+
+  const unsigned int nProj = self->GetInput(1)->GetLargestPossibleRegion().GetSize( Dimension-1 );
+
+  try
+    {
+    for(unsigned int i=0; i<nProj; i+=self->m_ProjectionSubsetSize)
+      {
+      // Wait for the next filtered sub-stack
+      self->m_PipelineMutex.Lock();
+      while(self->m_FilteredSubsets.empty() && !self->m_PipelineAbort)
+        self->m_PipelineCondition->Wait( &(self->m_PipelineMutex) );
+      if(self->m_PipelineAbort)
+        {
+        self->m_PipelineMutex.Unlock();
+        break;
+        }
+      typename OutputImageType::Pointer filtered = self->m_FilteredSubsets.front();
+      self->m_FilteredSubsets.pop_front();
+      self->m_PipelineCondition->Broadcast();
+      self->m_PipelineMutex.Unlock();
+
+      // After the first bp update, we need to use its output as input.
+      if(i)
+        {
+        typename TInputImage::Pointer pimg = self->m_BackProjectionFilter->GetOutput();
+        pimg->DisconnectPipeline();
+        self->m_BackProjectionFilter->SetInput( pimg );
+        }
+      self->m_BackProjectionFilter->SetInput( 1, filtered );
+
+      // This is required to reset the full pipeline
+      self->m_BackProjectionFilter->GetOutput()->UpdateOutputInformation();
+      self->m_BackProjectionFilter->GetOutput()->PropagateRequestedRegion();
+
+      self->m_BackProjectionProbe.Start();
+      self->m_BackProjectionFilter->Update();
+      self->m_BackProjectionProbe.Stop();
+      }
+    }
+  catch( itk::ProcessAborted & err )
+    {
+    self->AbortPipeline(err, PROCESS_ABORTED);
+    }
+  catch( itk::MemoryAllocationError & err )
+    {
+    self->AbortPipeline(err, MEMORY_ALLOCATION_ERROR);
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    self->AbortPipeline(err);
+    }
+  catch( std::bad_alloc & )
+    {
+    self->AbortPipeline(itk::ExceptionObject(__FILE__, __LINE__, "Memory allocation failed", ITK_LOCATION), BAD_ALLOC);
+    }
+  catch( std::exception & err )
+    {
+    self->AbortPipeline(itk::ExceptionObject(__FILE__, __LINE__, err.what(), ITK_LOCATION));
+    }
+  catch( ... )
+    {
+    self->AbortPipeline(itk::ExceptionObject(__FILE__, __LINE__, "Unknown exception", ITK_LOCATION));
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template<class TInputImage, class TOutputImage, class TFFTPrecision>
 ThreeDCircularProjectionGeometry::Pointer
 FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
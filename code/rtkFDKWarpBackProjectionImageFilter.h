@@ -84,6 +84,10 @@ protected:
 
   void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
 
+  /** The threads are synchronized for each projection, the output region is
+      therefore always split statically and bricks are not used. */
+  bool SupportsBricks() const ITK_OVERRIDE { return false; }
+
 private:
   FDKWarpBackProjectionImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&);                   //purposely not implemented
@@ -22,8 +22,6 @@
 #include <itkImageRegionIteratorWithIndex.h>
 #include <itkLinearInterpolateImageFunction.h>
 
-#define BILINEAR_BACKPROJECTION
-
 namespace rtk
 {
 
@@ -22,6 +22,7 @@
 #include <itkInPlaceImageFilter.h>
 #include "rtkThreeDCircularProjectionGeometry.h"
 #include "rtkMacro.h"
+#include "rtkBrickMaximumGrid.h"
 
 namespace rtk
 {
@@ -29,6 +30,20 @@ namespace rtk
 /** \class ForwardProjectionImageFilter
  * \brief Base class for forward projection, i.e. accumulation along x-ray lines.
  *
+ * The CPU projectors which support it can skip the empty space of the
+ * volume, i.e., the bricks of voxels whose maximum absolute value is lower
+ * than or equal to a threshold, see BrickMaximumGrid. The bricks are
+ * computed once for each new volume. With the default threshold (0), the
+ * result is the same as without skipping.
+ *
+ * The bounding rectangle of the projection of the volume is computed once for
+ * each projection before tracing. The CPU projectors only trace the rays of
+ * the detector pixels in this rectangle, the other pixels are set to the
+ * input value. The requested region is split between threads such that they
+ * have about the same number of rays to trace. This ray culling can be
+ * turned off with RayCulling and subclasses disable it with CanCullRays
+ * when a ray which misses the volume may change the input value.
+ *
  * \author Simon Rit
  *
  * \ingroup Projector
@@ -46,6 +61,8 @@ public:
 
   typedef rtk::ThreeDCircularProjectionGeometry             GeometryType;
   typedef typename GeometryType::Pointer                    GeometryPointer;
+  typedef BrickMaximumGrid<TInputImage>                     EmptySpaceGridType;
+  typedef typename Superclass::OutputImageRegionType        OutputImageRegionType;
 
   /** Run-time type information (and related methods). */
   itkTypeMacro(ForwardProjectionImageFilter, itk::InPlaceImageFilter);
@@ -54,8 +71,33 @@ public:
   itkGetMacro(Geometry, GeometryPointer);
   itkSetMacro(Geometry, GeometryPointer);
 
+  /** Get / Set if the empty space of the volume is skipped. Default is off. */
+  itkGetMacro(EmptySpaceSkipping, bool);
+  itkSetMacro(EmptySpaceSkipping, bool);
+  itkBooleanMacro(EmptySpaceSkipping);
+
+  /** Get / Set the size of the bricks used for empty space skipping, must be
+   * a power of 2. Default is 8 voxels. */
+  itkGetMacro(EmptySpaceBrickSize, unsigned int);
+  itkSetMacro(EmptySpaceBrickSize, unsigned int);
+
+  /** Get / Set the threshold of the absolute value below which voxels are
+   * considered empty. Default is 0. */
+  itkGetMacro(EmptySpaceThreshold, double);
+  itkSetMacro(EmptySpaceThreshold, double);
+
+  /** Get / Set if only the rays of the pixels in the bounding rectangle of
+   * the projection of the volume are traced. Default is on. */
+  itkGetMacro(RayCulling, bool);
+  itkSetMacro(RayCulling, bool);
+  itkBooleanMacro(RayCulling);
+
 protected:
-  ForwardProjectionImageFilter() : m_Geometry(ITK_NULLPTR) {
+  ForwardProjectionImageFilter() : m_Geometry(ITK_NULLPTR),
+                                   m_EmptySpaceSkipping(false),
+                                   m_EmptySpaceBrickSize(8),
+                                   m_EmptySpaceThreshold(0.),
+                                   m_RayCulling(true) {
     this->SetNumberOfRequiredInputs(2); this->SetInPlace( true );
   };
 
@@ -68,12 +110,53 @@ protected:
    * to verify. */
   void VerifyInputInformation() ITK_OVERRIDE {}
 
+  /** Updates the empty space grid if required and computes the bounding
+   * rectangle of the projection of the volume in each projection. */
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  /** Splits the requested region along the projections, or along the rows if
+   * there are fewer projections than threads, such that each thread has about
+   * the same number of pixels in the bounding rectangles. */
+  unsigned int SplitRequestedRegion(unsigned int i, unsigned int num, OutputImageRegionType& splitRegion) ITK_OVERRIDE;
+
+  /** Returns false if the pixels whose rays miss the volume may not keep the
+   * input value, e.g., with a ray accumulation which does not only add the
+   * line integral to the input. Ray culling is then disabled. */
+  virtual bool CanCullRays() const { return true; }
+
+  /** Copies the input projections in the output over outputRegionForThread
+   * if the filter is not in place and returns the parts of
+   * outputRegionForThread, one per projection, whose rays may hit the volume.
+   * The pixels out of these regions keep the input value. */
+  void CullRays(const OutputImageRegionType &outputRegionForThread,
+                std::vector<OutputImageRegionType> &regions);
+
+  /** Empty space grid of the volume (input 1), ITK_NULLPTR if empty space
+   * skipping is off. Up to date in ThreadedGenerateData. */
+  const EmptySpaceGridType *GetEmptySpaceGrid() const
+    {
+    return (m_EmptySpaceSkipping)?m_EmptySpaceGrid.GetPointer():ITK_NULLPTR;
+    }
+
 private:
   ForwardProjectionImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&);            //purposely not implemented
 
   /** RTK geometry object */
   GeometryPointer m_Geometry;
+
+  /** Empty space skipping */
+  bool                                  m_EmptySpaceSkipping;
+  unsigned int                          m_EmptySpaceBrickSize;
+  double                                m_EmptySpaceThreshold;
+  typename EmptySpaceGridType::Pointer  m_EmptySpaceGrid;
+
+  /** Tracing of the rays of the bounding rectangles only */
+  bool                                  m_RayCulling;
+
+  /** Bounding rectangle of the projection of the volume, one per projection
+   * of the output requested region. */
+  std::vector<OutputImageRegionType>    m_ProjectedVolumeRegions;
 };
 
 } // end namespace rtk
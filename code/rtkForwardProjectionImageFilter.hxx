@@ -23,6 +23,7 @@
 #include "rtkRayCastInterpolateImageFunction.h"
 
 #include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
 #include <itkImageRegionIteratorWithIndex.h>
 #include <itkIdentityTransform.h>
 
@@ -51,6 +52,232 @@ ForwardProjectionImageFilter<TInputImage,TOutputImage>
   inputPtr1->SetRequestedRegion( reqRegion );
 }
 
+template <class TInputImage, class  TOutputImage>
+void
+ForwardProjectionImageFilter<TInputImage,TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  if(m_EmptySpaceSkipping)
+    {
+    if(m_EmptySpaceGrid.GetPointer() == ITK_NULLPTR)
+      m_EmptySpaceGrid = EmptySpaceGridType::New();
+    m_EmptySpaceGrid->SetBrickSize(m_EmptySpaceBrickSize);
+    m_EmptySpaceGrid->SetThreshold(m_EmptySpaceThreshold);
+    m_EmptySpaceGrid->Update( this->GetInput(1) );
+    }
+
+  // Bounding rectangle of the projection of the volume in each projection.
+  // By default, the whole projection.
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const OutputImageRegionType requested = this->GetOutput()->GetRequestedRegion();
+  const int iFirstProj = requested.GetIndex(Dimension-1);
+  const unsigned int nProj = requested.GetSize(Dimension-1);
+  m_ProjectedVolumeRegions.resize(nProj);
+  for(unsigned int k=0; k<nProj; k++)
+    {
+    m_ProjectedVolumeRegions[k] = requested;
+    m_ProjectedVolumeRegions[k].SetIndex(Dimension-1, iFirstProj+k);
+    m_ProjectedVolumeRegions[k].SetSize(Dimension-1, 1);
+    }
+  if(m_Geometry.GetPointer() == ITK_NULLPTR || !m_RayCulling || !this->CanCullRays())
+    return;
+
+  // The corners of the volume are the borders of the first and last voxels.
+  // Volume indices are mapped to the physical coordinates of the (flat)
+  // detector with the geometry matrix, and then to projection indices.
+  const typename TInputImage::RegionType volRegion = this->GetInput(1)->GetBufferedRegion();
+  const typename GeometryType::ThreeDHomogeneousMatrixType volIndexToPP =
+    GetIndexToPhysicalPointMatrix( this->GetInput(1) );
+  const typename GeometryType::ThreeDHomogeneousMatrixType projPPToIndex =
+    GetPhysicalPointToIndexMatrix( this->GetOutput() );
+  const double radius = m_Geometry->GetRadiusCylindricalDetector();
+  for(unsigned int k=0; k<nProj; k++)
+    {
+    const unsigned int iProj = iFirstProj + k;
+    if(iProj >= m_Geometry->GetMatrices().size())
+      continue;
+    const typename GeometryType::MatrixType matrix(m_Geometry->GetMatrices()[iProj].GetVnlMatrix() *
+                                                   volIndexToPP.GetVnlMatrix());
+
+    double flatInf[2], flatSup[2];
+    flatInf[0] = flatInf[1] = itk::NumericTraits<double>::max();
+    flatSup[0] = flatSup[1] = itk::NumericTraits<double>::NonpositiveMin();
+    double firstPerspFactor = 0.;
+    bool sameSide = true;
+    for(int c=0; c<8 && sameSide; c++)
+      {
+      double index[3];
+      for(unsigned int j=0; j<Dimension; j++)
+        {
+        index[j] = volRegion.GetIndex(j) - 0.5;
+        if( (c>>j) & 1 )
+          index[j] += volRegion.GetSize(j);
+        }
+
+      double point[3];
+      for(unsigned int i=0; i<Dimension; i++)
+        {
+        point[i] = matrix[i][Dimension];
+        for(unsigned int j=0; j<Dimension; j++)
+          point[i] += matrix[i][j] * index[j];
+        }
+
+      // If the corners are not all on the same side of the source, the
+      // rays of any pixel may hit the volume
+      if(c==0)
+        firstPerspFactor = point[2];
+      if(point[2]*firstPerspFactor <= 0.)
+        sameSide = false;
+
+      for(int i=0; i<2; i++)
+        {
+        flatInf[i] = vnl_math_min(flatInf[i], point[i]/point[2]);
+        flatSup[i] = vnl_math_max(flatSup[i], point[i]/point[2]);
+        }
+      }
+    if(!sameSide)
+      continue;
+
+    // Map the bounding box on the flat detector onto the cylinder, see
+    // BackProjectionImageFilter::GenerateInputRequestedRegion.
+    double uInf = flatInf[0];
+    double uSup = flatSup[0];
+    double vInf = flatInf[1];
+    double vSup = flatSup[1];
+    if(radius != 0)
+      {
+      uInf = radius * atan(flatInf[0]/radius);
+      uSup = radius * atan(flatSup[0]/radius);
+      const double cosInf = 1. / sqrt(1. + vnl_math_max(flatInf[0]*flatInf[0], flatSup[0]*flatSup[0])/(radius*radius));
+      double cosSup = 1.;
+      if(flatInf[0]>0. || flatSup[0]<0.)
+        cosSup = 1. / sqrt(1. + vnl_math_min(flatInf[0]*flatInf[0], flatSup[0]*flatSup[0])/(radius*radius));
+      vInf = vnl_math_min(flatInf[1]*cosInf, flatInf[1]*cosSup);
+      vSup = vnl_math_max(flatSup[1]*cosInf, flatSup[1]*cosSup);
+      }
+
+    // Bounding rectangle in projection indices
+    double cornerInf[2], cornerSup[2];
+    cornerInf[0] = cornerInf[1] = itk::NumericTraits<double>::max();
+    cornerSup[0] = cornerSup[1] = itk::NumericTraits<double>::NonpositiveMin();
+    for(int cv=0; cv<2; cv++)
+      for(int cu=0; cu<2; cu++)
+        {
+        const double u = (cu)?uSup:uInf;
+        const double v = (cv)?vSup:vInf;
+        for(int i=0; i<2; i++)
+          {
+          const double p = projPPToIndex[i][0] * u + projPPToIndex[i][1] * v + projPPToIndex[i][Dimension];
+          cornerInf[i] = vnl_math_min(cornerInf[i], p);
+          cornerSup[i] = vnl_math_max(cornerSup[i], p);
+          }
+        }
+
+    OutputImageRegionType rectangle = m_ProjectedVolumeRegions[k];
+    for(int i=0; i<2; i++)
+      {
+      rectangle.SetIndex(i, vnl_math_floor(cornerInf[i]) );
+      rectangle.SetSize(i, vnl_math_ceil(cornerSup[i]+1.)-vnl_math_floor(cornerInf[i]) );
+      }
+    if( rectangle.Crop( m_ProjectedVolumeRegions[k] ) )
+      m_ProjectedVolumeRegions[k] = rectangle;
+    else
+      m_ProjectedVolumeRegions[k].SetSize(0, 0);
+    }
+}
+
+template <class TInputImage, class  TOutputImage>
+unsigned int
+ForwardProjectionImageFilter<TInputImage,TOutputImage>
+::SplitRequestedRegion(unsigned int i, unsigned int num, OutputImageRegionType& splitRegion)
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const OutputImageRegionType requested = this->GetOutput()->GetRequestedRegion();
+  if(m_ProjectedVolumeRegions.size() != requested.GetSize(Dimension-1))
+    return Superclass::SplitRequestedRegion(i, num, splitRegion);
+
+  // Number of pixels in the bounding rectangles for each index along the
+  // split dimension
+  const unsigned int splitDim = (requested.GetSize(Dimension-1) >= num)?Dimension-1:1;
+  const int first = requested.GetIndex(splitDim);
+  const unsigned int n = requested.GetSize(splitDim);
+  std::vector<double> weights(n, 0.);
+  double total = 0.;
+  for(unsigned int k=0; k<m_ProjectedVolumeRegions.size(); k++)
+    {
+    const OutputImageRegionType &r = m_ProjectedVolumeRegions[k];
+    if(splitDim == Dimension-1)
+      weights[k] = r.GetNumberOfPixels();
+    else if(r.GetSize(0) != 0)
+      for(unsigned int j=0; j<r.GetSize(1); j++)
+        weights[r.GetIndex(1)-first+j] += r.GetSize(0);
+    total += r.GetNumberOfPixels();
+    }
+  if(total == 0.)
+    {
+    std::fill(weights.begin(), weights.end(), 1.);
+    total = n;
+    }
+
+  // Contiguous ranges with about the same weight and at least one index
+  const unsigned int maxThreads = std::min(num, n);
+  if(i >= maxThreads)
+    return maxThreads;
+  unsigned int begin = 0;
+  unsigned int end = 0;
+  double cumulatedWeight = 0.;
+  for(unsigned int t=1; t<=i+1; t++)
+    {
+    begin = end;
+    const double target = total * t / maxThreads;
+    while(end < n && (end == begin || cumulatedWeight < target))
+      cumulatedWeight += weights[end++];
+    while(end > n-maxThreads+t)
+      cumulatedWeight -= weights[--end];
+    }
+  if(i+1 == maxThreads)
+    end = n;
+
+  splitRegion = requested;
+  splitRegion.SetIndex(splitDim, first+begin);
+  splitRegion.SetSize(splitDim, end-begin);
+  return maxThreads;
+}
+
+template <class TInputImage, class  TOutputImage>
+void
+ForwardProjectionImageFilter<TInputImage,TOutputImage>
+::CullRays(const OutputImageRegionType &outputRegionForThread,
+           std::vector<OutputImageRegionType> &regions)
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  if(this->GetInput() != this->GetOutput())
+    {
+    itk::ImageRegionConstIterator<TInputImage> itIn(this->GetInput(), outputRegionForThread);
+    itk::ImageRegionIterator<TOutputImage> itOut(this->GetOutput(), outputRegionForThread);
+    for(; !itOut.IsAtEnd(); ++itIn, ++itOut)
+      itOut.Set( itIn.Get() );
+    }
+
+  regions.clear();
+  const int iFirstProj = this->GetOutput()->GetRequestedRegion().GetIndex(Dimension-1);
+  for(unsigned int k=0; k<outputRegionForThread.GetSize(Dimension-1); k++)
+    {
+    const int iProj = outputRegionForThread.GetIndex(Dimension-1) + k;
+    OutputImageRegionType region = outputRegionForThread;
+    region.SetIndex(Dimension-1, iProj);
+    region.SetSize(Dimension-1, 1);
+    if(iProj-iFirstProj >= (int)m_ProjectedVolumeRegions.size())
+      {
+      regions.push_back(region);
+      continue;
+      }
+    const OutputImageRegionType &rectangle = m_ProjectedVolumeRegions[iProj-iFirstProj];
+    if(rectangle.GetNumberOfPixels() != 0 && region.Crop(rectangle))
+      regions.push_back(region);
+    }
+}
+
 } // end namespace rtk
 
 #endif
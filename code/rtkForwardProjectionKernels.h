@@ -0,0 +1,64 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkForwardProjectionKernels_h
+#define rtkForwardProjectionKernels_h
+
+#include "rtkBackProjectionKernels.h"
+
+namespace rtk
+{
+
+/** Number of rays traced simultaneously by the SIMD forward projection kernels. */
+const unsigned int ForwardProjectionPacketSize = 8;
+
+#ifdef RTK_USE_AVX2
+//--------------------------------------------------------------------
+/** \brief AVX2 bilinear interpolation along a packet of 8 rays of the Joseph
+ * forward projection.
+ *
+ * The rays share the same main direction. At step s, the slice of the volume
+ * starting at pSlice+s*sliceStride is interpolated for lane l at continuous
+ * index (x[l]+s*dx[l], y[l]+s*dy[l]) in the two other directions, whose
+ * strides in memory are ox and oy. The integer parts of the indices are
+ * clamped to [xMin,xMax] and [yMin,yMax] so that the four neighbors are
+ * always read inside the volume. The nSteps interpolated values of lane l
+ * are added to sum[l]. Must only be called if IsAVX2BackProjectionAvailable()
+ * returns true.
+ *
+ * \ingroup Functions
+ */
+RTK_EXPORT void ForwardProjectBilinearPacketAVX2(const float *pSlice,
+                                                 const std::ptrdiff_t sliceStride,
+                                                 const unsigned int nSteps,
+                                                 const int ox,
+                                                 const int oy,
+                                                 const int xMin,
+                                                 const int xMax,
+                                                 const int yMin,
+                                                 const int yMax,
+                                                 const float *x,
+                                                 const float *dx,
+                                                 const float *y,
+                                                 const float *dy,
+                                                 float *sum);
+#endif
+
+} // end namespace rtk
+
+#endif
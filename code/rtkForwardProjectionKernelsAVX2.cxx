@@ -0,0 +1,83 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// This file is compiled with the AVX2 and FMA instruction sets enabled. It
+// must only contain code which is called after a successful runtime check,
+// see rtk::IsAVX2BackProjectionAvailable().
+
+#include "rtkForwardProjectionKernels.h"
+
+#include <immintrin.h>
+
+void
+rtk::ForwardProjectBilinearPacketAVX2(const float *pSlice,
+                                      const std::ptrdiff_t sliceStride,
+                                      const unsigned int nSteps,
+                                      const int ox,
+                                      const int oy,
+                                      const int xMin,
+                                      const int xMax,
+                                      const int yMin,
+                                      const int yMax,
+                                      const float *x,
+                                      const float *dx,
+                                      const float *y,
+                                      const float *dy,
+                                      float *sum)
+{
+  const __m256  x0 = _mm256_loadu_ps(x);
+  const __m256  dxs = _mm256_loadu_ps(dx);
+  const __m256  y0 = _mm256_loadu_ps(y);
+  const __m256  dys = _mm256_loadu_ps(dy);
+  const __m256  one = _mm256_set1_ps(1.f);
+  const __m256i oxs = _mm256_set1_epi32(ox);
+  const __m256i oys = _mm256_set1_epi32(oy);
+  const __m256i xMins = _mm256_set1_epi32(xMin);
+  const __m256i xMaxs = _mm256_set1_epi32(xMax);
+  const __m256i yMins = _mm256_set1_epi32(yMin);
+  const __m256i yMaxs = _mm256_set1_epi32(yMax);
+  __m256 acc = _mm256_setzero_ps();
+
+  for(unsigned int s=0; s<nSteps; s++, pSlice += sliceStride)
+    {
+    // Continuous indices, computed from the packet origin to avoid the
+    // accumulation of rounding errors in single precision
+    const __m256  ss = _mm256_set1_ps( (float)s );
+    const __m256  xs = _mm256_fmadd_ps(ss, dxs, x0);
+    const __m256  ys = _mm256_fmadd_ps(ss, dys, y0);
+    const __m256i ix = _mm256_min_epi32(_mm256_max_epi32(_mm256_cvttps_epi32(_mm256_floor_ps(xs)), xMins), xMaxs);
+    const __m256i iy = _mm256_min_epi32(_mm256_max_epi32(_mm256_cvttps_epi32(_mm256_floor_ps(ys)), yMins), yMaxs);
+    const __m256  lx = _mm256_sub_ps(xs, _mm256_cvtepi32_ps(ix));
+    const __m256  ly = _mm256_sub_ps(ys, _mm256_cvtepi32_ps(iy));
+    const __m256  lxc = _mm256_sub_ps(one, lx);
+    const __m256  lyc = _mm256_sub_ps(one, ly);
+
+    // Gathers of the four neighbors
+    const __m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(ix, oxs), _mm256_mullo_epi32(iy, oys) );
+    const __m256  pxiyi = _mm256_i32gather_ps(pSlice,       idx, 4);
+    const __m256  pxsyi = _mm256_i32gather_ps(pSlice+ox,    idx, 4);
+    const __m256  pxiys = _mm256_i32gather_ps(pSlice+oy,    idx, 4);
+    const __m256  pxsys = _mm256_i32gather_ps(pSlice+ox+oy, idx, 4);
+
+    const __m256 rowInf = _mm256_fmadd_ps(lx, pxsyi, _mm256_mul_ps(lxc, pxiyi) );
+    const __m256 rowSup = _mm256_fmadd_ps(lx, pxsys, _mm256_mul_ps(lxc, pxiys) );
+    acc = _mm256_add_ps(acc, _mm256_fmadd_ps(ly, rowSup, _mm256_mul_ps(lyc, rowInf) ) );
+    }
+
+  _mm256_storeu_ps(sum, _mm256_add_ps(_mm256_loadu_ps(sum), acc) );
+}
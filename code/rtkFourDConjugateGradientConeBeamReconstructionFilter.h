@@ -132,7 +132,20 @@ public:
   itkGetMacro(NumberOfIterations, unsigned int)
   itkSetMacro(NumberOfIterations, unsigned int)
 
-  /** Get / Set whether conjugate gradient should be performed on GPU */
+  /** Get / Set the stopping criteria of the conjugate gradient, see
+   * ConjugateGradientImageFilter. Both are disabled by default (0). */
+  itkGetMacro(Tolerance, double)
+  itkSetMacro(Tolerance, double)
+  itkGetMacro(StagnationTolerance, double)
+  itkSetMacro(StagnationTolerance, double)
+
+  /** Get the norms of the residuals of the conjugate gradient. An
+   * itk::IterationEvent is invoked after each iteration. */
+  const std::vector<double> &GetResidualNorms();
+
+  /** Get / Set whether conjugate gradient should be performed on GPU. The
+   * conjugate gradient on GPU does not support the stopping criteria, it is
+   * replaced by the one on CPU with a warning when either is set. */
   itkGetMacro(CudaConjugateGradient, bool)
   itkSetMacro(CudaConjugateGradient, bool)
 
@@ -169,6 +182,10 @@ protected:
 
   void GenerateData() ITK_OVERRIDE;
 
+  /** Invokes an itk::IterationEvent after each iteration of
+   * m_ConjugateGradientFilter */
+  void ReportIteration();
+
   /** The two inputs should not be in the same space so there is nothing
    * to verify. */
   void VerifyInputInformation() ITK_OVERRIDE {}
@@ -197,6 +214,10 @@ private:
   /** Number of conjugate gradient descent iterations */
   unsigned int m_NumberOfIterations;
 
+  /** Stopping criteria of the conjugate gradient */
+  double m_Tolerance;
+  double m_StagnationTolerance;
+
 }; // end of class
 
 } // end namespace rtk
@@ -26,6 +26,7 @@
 #include <algorithm>
 
 #include <itkImageFileWriter.h>
+#include <itkCommand.h>
 
 namespace rtk
 {
@@ -38,6 +39,8 @@ FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionS
 
   // Set the default values of member parameters
   m_NumberOfIterations=3;
+  m_Tolerance=0.;
+  m_StagnationTolerance=0.;
   m_CudaConjugateGradient = false; // 4D volumes of usual size only fit on the largest GPUs
 
   // Create the filters
@@ -148,16 +151,45 @@ FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionS
   this->Modified();
 }
 
+template<class VolumeSeriesType, class ProjectionStackType>
+const std::vector<double> &
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+::GetResidualNorms()
+{
+  return m_ConjugateGradientFilter->GetResidualNorms();
+}
+
+template<class VolumeSeriesType, class ProjectionStackType>
+void
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+::ReportIteration()
+{
+  this->InvokeEvent( itk::IterationEvent() );
+}
+
 template<class VolumeSeriesType, class ProjectionStackType>
 void
 FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
 ::GenerateOutputInformation()
 {
   // Set the Conjugate Gradient filter (either on CPU or GPU depending on user's choice)
+  m_ConjugateGradientFilter = ConjugateGradientFilterType::New();
 #ifdef RTK_USE_CUDA
   if (m_CudaConjugateGradient)
-    m_ConjugateGradientFilter = rtk::CudaConjugateGradientImageFilter_4f::New();
+    {
+    // The conjugate gradient on GPU has no stopping criteria
+    if (m_Tolerance > 0. || m_StagnationTolerance > 0.)
+      itkWarningMacro(<< "The conjugate gradient on GPU does not support the stopping criteria, reverting to the conjugate gradient on CPU")
+    else
+      m_ConjugateGradientFilter = rtk::CudaConjugateGradientImageFilter_4f::New();
+    }
 #endif
+
+  // Forward the iteration events of the conjugate gradient
+  typedef itk::SimpleMemberCommand<Self> IterationCommandType;
+  typename IterationCommandType::Pointer iterationCommand = IterationCommandType::New();
+  iterationCommand->SetCallbackFunction(this, &Self::ReportIteration);
+  m_ConjugateGradientFilter->AddObserver(itk::IterationEvent(), iterationCommand);
   m_ConjugateGradientFilter->SetA(m_CGOperator.GetPointer());
 
   // Set runtime connections
@@ -178,6 +210,8 @@ FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionS
 
   // Set runtime parameters
   m_ConjugateGradientFilter->SetNumberOfIterations(this->m_NumberOfIterations);
+  m_ConjugateGradientFilter->SetTolerance(this->m_Tolerance);
+  m_ConjugateGradientFilter->SetStagnationTolerance(this->m_StagnationTolerance);
   m_DisplacedDetectorFilter->SetDisable(m_DisableDisplacedDetectorFilter);
   m_CGOperator->SetDisableDisplacedDetectorFilter(m_DisableDisplacedDetectorFilter);
 
@@ -207,7 +241,7 @@ FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionS
 {
   m_ProjStackToFourDFilter->Update();
 
-  if (!m_CudaConjugateGradient)
+  if (!m_CudaConjugateGradient || m_Tolerance > 0. || m_StagnationTolerance > 0.)
     this->m_ProjStackToFourDFilter->GetOutput()->GetBufferPointer();
 
   m_ConjugateGradientFilter->Update();
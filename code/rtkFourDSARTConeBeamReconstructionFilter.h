@@ -68,7 +68,7 @@ namespace rtk
  * Divide [ label="itk::DivideOrZeroOutImageFilter" URL="\ref itk::DivideOrZeroOutImageFilter"];
  * Displaced [ label="rtk::DisplacedDetectorImageFilter" URL="\ref rtk::DisplacedDetectorImageFilter"];
  * ConstantProjectionStack [ label="rtk::ConstantImageSource" URL="\ref rtk::ConstantImageSource"];
- * ExtractConstantProjection [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter"];
+ * ExtractRayBox [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter"];
  * RayBox [ label="rtk::RayBoxIntersectionImageFilter" URL="\ref rtk::RayBoxIntersectionImageFilter"];
  * ConstantVolume [ label="rtk::ConstantImageSource" URL="\ref rtk::ConstantImageSource"];
  * ProjectionStackToFourD [ label="rtk::ProjectionStackToFourDImageFilter" URL="\ref rtk::ProjectionStackToFourDImageFilter"];
@@ -94,9 +94,9 @@ namespace rtk
  * FourDToProjectionStack -> Subtract;
  * Subtract -> MultiplyByLambda;
  * MultiplyByLambda -> Divide;
- * ConstantProjectionStack -> ExtractConstantProjection;
- * ExtractConstantProjection -> RayBox;
- * RayBox -> Divide;
+ * ConstantProjectionStack -> RayBox;
+ * RayBox -> ExtractRayBox;
+ * ExtractRayBox -> Divide;
  * Divide -> Displaced;
  * Displaced -> ProjectionStackToFourD;
  * ProjectionStackToFourD -> Add;
@@ -68,10 +68,10 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   m_MultiplyFilter->SetInput1( itk::NumericTraits<typename InputImageType::PixelType>::ZeroValue() );
   m_MultiplyFilter->SetInput2( m_SubtractFilter->GetOutput() );
 
-  m_ExtractFilterRayBox->SetInput(m_ConstantProjectionStackSource->GetOutput());
-  m_RayBoxFilter->SetInput(m_ExtractFilterRayBox->GetOutput());
+  m_RayBoxFilter->SetInput(m_ConstantProjectionStackSource->GetOutput());
+  m_ExtractFilterRayBox->SetInput(m_RayBoxFilter->GetOutput());
   m_DivideFilter->SetInput1(m_MultiplyFilter->GetOutput());
-  m_DivideFilter->SetInput2(m_RayBoxFilter->GetOutput());
+  m_DivideFilter->SetInput2(m_ExtractFilterRayBox->GetOutput());
   m_DisplacedDetectorFilter->SetInput(m_DivideFilter->GetOutput());
 
   // Default parameters
@@ -271,6 +271,12 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   m_RayBoxFilter->SetBoxMin(Corner1);
   m_RayBoxFilter->SetBoxMax(Corner2);
 
+  // The ray box intersection of all projections is computed once and reused
+  // in all iterations. It is recomputed only if the geometry, the volume
+  // information or the projection information have changed.
+  if(this->GetGeometry()->GetMTime() > m_RayBoxFilter->GetOutput()->GetUpdateMTime())
+    m_RayBoxFilter->Modified();
+
   m_RayBoxFilter->UpdateOutputInformation();
   m_ExtractFilter->UpdateOutputInformation();
   m_ZeroMultiplyFilter->UpdateOutputInformation();
@@ -307,7 +313,6 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   m_FourDToProjectionStackFilter->ReleaseDataFlagOn();
   m_SubtractFilter->ReleaseDataFlagOn();
   m_MultiplyFilter->ReleaseDataFlagOn();
-  m_RayBoxFilter->ReleaseDataFlagOn();
   m_DivideFilter->ReleaseDataFlagOn();
 }
 
@@ -325,8 +330,10 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
 
   m_MultiplyFilter->SetInput1( (const float) m_Lambda/(double)m_NumberOfProjectionsPerSubset  );
   
-  // Create the zero projection stack used as input by RayBoxIntersectionFilter
-  m_ConstantProjectionStackSource->Update();
+  // Compute the ray box intersection of all projections, if required
+  m_RayBoxProbe.Start();
+  m_RayBoxFilter->UpdateLargestPossibleRegion();
+  m_RayBoxProbe.Stop();
 
   // Declare the image used in the main loop
   typename VolumeSeriesType::Pointer pimg;
@@ -405,10 +412,6 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
       m_MultiplyFilter->Update();
       m_MultiplyProbe.Stop();
 
-      m_RayBoxProbe.Start();
-      m_RayBoxFilter->Update();
-      m_RayBoxProbe.Stop();
-
       m_DivideProbe.Start();
       m_DivideFilter->Update();
       m_DivideProbe.Stop();
@@ -23,9 +23,14 @@
 #include "rtkConfiguration.h"
 #include "rtkRayCastInterpolatorForwardProjectionImageFilter.h"
 #include "rtkJosephForwardProjectionImageFilter.h"
+#include "rtkSiddonForwardProjectionImageFilter.h"
+#include "rtkRayCastForwardProjectionImageFilter.h"
+#include "rtkMipMapForwardProjectionImageFilter.h"
 // Back projection filters
 #include "rtkJosephBackProjectionImageFilter.h"
 #include "rtkNormalizedJosephBackProjectionImageFilter.h"
+#include "rtkSiddonBackProjectionImageFilter.h"
+#include "rtkRayCastBackProjectionImageFilter.h"
 
 #ifdef RTK_USE_CUDA
   #include "rtkCudaForwardProjectionImageFilter.h"
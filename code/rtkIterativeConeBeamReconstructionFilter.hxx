@@ -49,9 +49,15 @@ namespace rtk
       #ifdef RTK_USE_CUDA
         fw = rtk::CudaForwardProjectionImageFilter<VolumeType, ProjectionStackType>::New();
       #else
-        itkGenericExceptionMacro(<< "The program has not been compiled with cuda option");
+        fw = rtk::RayCastForwardProjectionImageFilter<VolumeType, ProjectionStackType>::New();
       #endif
       break;
+      case(3):
+        fw = rtk::SiddonForwardProjectionImageFilter<VolumeType, ProjectionStackType>::New();
+      break;
+      case(4):
+        fw = rtk::MipMapForwardProjectionImageFilter<VolumeType, ProjectionStackType>::New();
+      break;
 
       default:
         itkGenericExceptionMacro(<< "Unhandled --fp value.");
@@ -86,9 +92,12 @@ namespace rtk
       #ifdef RTK_USE_CUDA
         bp = rtk::CudaRayCastBackProjectionImageFilter::New();
       #else
-        itkGenericExceptionMacro(<< "The program has not been compiled with cuda option");
+        bp = rtk::RayCastBackProjectionImageFilter<ProjectionStackType, VolumeType>::New();
       #endif
         break;
+      case(5):
+        bp = rtk::SiddonBackProjectionImageFilter<ProjectionStackType, VolumeType>::New();
+        break;
       default:
         itkGenericExceptionMacro(<< "Unhandled --bp value.");
       }
@@ -69,6 +69,11 @@ public:
  * using [Joseph, IEEE TMI, 1982]. The back projector is the adjoint operator of the 
  * forward projector
  *
+ * The volume is split in slabs, one per thread. Each thread traces all the
+ * rays but only splats in the voxels of its slab, in the order of the
+ * projection pixels. The result is therefore the same as with a single thread
+ * and there is no concurrent write.
+ *
  * \test rtkbackprojectiontest.cxx
  *
  * \author Cyril Mory
@@ -119,7 +124,13 @@ protected:
   JosephBackProjectionImageFilter() {}
   ~JosephBackProjectionImageFilter() {}
 
-  void GenerateData() ITK_OVERRIDE;
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
+
+  /** Each thread traces all rays, the requested region is always split in
+      slabs whatever the brick size. */
+  bool SupportsBricks() const ITK_OVERRIDE { return false; }
 
   /** The two inputs should not be in the same space so there is nothing
    * to verify. */
@@ -153,6 +164,36 @@ protected:
                                      const CoordRepType maxx,
                                      const CoordRepType maxy);
 
+  /** Same as BilinearSplatOnBorders, pxiyi is the first voxel of the slice
+   * and only the voxels with indices in [ownMinx,ownMaxx]x[ownMiny,ownMaxy]
+   * are updated. */
+  inline void BilinearSplatInRegion(const InputPixelType rayValue,
+                                    const double stepLengthInVoxel,
+                                    const double voxelSize,
+                                    OutputPixelType *pxiyi,
+                                    const double x,
+                                    const double y,
+                                    const int ox,
+                                    const int oy,
+                                    const CoordRepType minx,
+                                    const CoordRepType miny,
+                                    const CoordRepType maxx,
+                                    const CoordRepType maxy,
+                                    const int ownMinx,
+                                    const int ownMiny,
+                                    const int ownMaxx,
+                                    const int ownMaxy);
+
+  /** Restricts [first,last] to the steps i of a ray for which the coordinate
+   * c0+(i-ns)*step is close enough to [ownMin,ownMax] for splatting in it. */
+  static inline void ClipStepRange(const CoordRepType c0,
+                                   const CoordRepType step,
+                                   const int ownMin,
+                                   const int ownMax,
+                                   const int ns,
+                                   int &first,
+                                   int &last);
+
 
 private:
   JosephBackProjectionImageFilter(const Self&); //purposely not implemented
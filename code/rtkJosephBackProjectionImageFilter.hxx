@@ -37,11 +37,26 @@ void
 JosephBackProjectionImageFilter<TInputImage,
                                 TOutputImage,
                                 TSplatWeightMultiplication>
-::GenerateData()
+::BeforeThreadedGenerateData()
 {
-  // Allocate the output image
-  this->AllocateOutputs();
+  // The checks of the voxel-based back projection do not apply, rays are
+  // computed for any detector by the ray-based projection iterator
+  if( !dynamic_cast<GeometryType*>(this->GetGeometry().GetPointer()) )
+    {
+    itkGenericExceptionMacro(<< "Error, ThreeDCircularProjectionGeometry expected");
+    }
+}
 
+template <class TInputImage,
+          class TOutputImage,
+          class TSplatWeightMultiplication>
+void
+JosephBackProjectionImageFilter<TInputImage,
+                                TOutputImage,
+                                TSplatWeightMultiplication>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId))
+{
   const unsigned int Dimension = TInputImage::ImageDimension;
   typename TInputImage::RegionType buffReg = this->GetInput(1)->GetBufferedRegion();
   int offsets[3];
@@ -50,10 +65,6 @@ JosephBackProjectionImageFilter<TInputImage,
   offsets[2] = this->GetInput(0)->GetBufferedRegion().GetSize()[0] * this->GetInput(0)->GetBufferedRegion().GetSize()[1];
 
   GeometryType *geometry = dynamic_cast<GeometryType*>(this->GetGeometry().GetPointer());
-  if( !geometry )
-    {
-    itkGenericExceptionMacro(<< "Error, ThreeDCircularProjectionGeometry expected");
-    }
 
   // beginBuffer is pointing at point with index (0,0,0) in memory, even if
   // it is not in the allocated memory
@@ -74,10 +85,10 @@ JosephBackProjectionImageFilter<TInputImage,
     {
     // Iterators on volume input and output
     typedef itk::ImageRegionConstIterator<TInputImage> InputRegionIterator;
-    InputRegionIterator itVolIn(this->GetInput(0), this->GetInput()->GetBufferedRegion());
+    InputRegionIterator itVolIn(this->GetInput(0), outputRegionForThread);
 
     typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
-    OutputRegionIterator itVolOut(this->GetOutput(), this->GetInput()->GetBufferedRegion());
+    OutputRegionIterator itVolOut(this->GetOutput(), outputRegionForThread);
 
     while(!itVolIn.IsAtEnd() )
       {
@@ -87,6 +98,14 @@ JosephBackProjectionImageFilter<TInputImage,
       }
     }
 
+  // Voxels of the thread, which are the only ones it updates
+  int ownMin[3], ownMax[3];
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    ownMin[i] = outputRegionForThread.GetIndex()[i];
+    ownMax[i] = outputRegionForThread.GetIndex()[i] + outputRegionForThread.GetSize()[i] - 1;
+    }
+
   // Iterators on projections input
   typedef ProjectionsRegionConstIteratorRayBased<TInputImage> InputRegionIterator;
   InputRegionIterator *itIn;
@@ -158,18 +177,7 @@ JosephBackProjectionImageFilter<TInputImage,
       const CoordRepType maxx = rbi->GetBoxMax()[notMainDirInf];
       const CoordRepType maxy = rbi->GetBoxMax()[notMainDirSup];
 
-      // Init data pointers to first pixel of slice ns (i)nferior and (s)uperior (x|y) corner
-      const int offsetx = offsets[notMainDirInf];
-      const int offsety = offsets[notMainDirSup];
-      const int offsetz = offsets[mainDir];
-      OutputPixelType *pxiyi, *pxsyi, *pxiys, *pxsys;
-
-      pxiyi = beginBuffer + ns * offsetz;
-      pxsyi = pxiyi + offsetx;
-      pxiys = pxiyi + offsety;
-      pxsys = pxsyi + offsety;
-
-      // Compute step size and go to first voxel
+      // Compute step size
       const CoordRepType residual = ns - np[mainDir];
       const CoordRepType norm = 1/dirVox[mainDir];
       const CoordRepType stepx = dirVox[notMainDirInf] * norm;
@@ -177,50 +185,69 @@ JosephBackProjectionImageFilter<TInputImage,
       CoordRepType currentx = np[notMainDirInf] + residual * stepx;
       CoordRepType currenty = np[notMainDirSup] + residual * stepy;
 
+      // Steps of the ray which may splat in the voxels of the thread
+      int first = std::max(ns, ownMin[mainDir]);
+      int last  = std::min(fs, ownMax[mainDir]);
+      ClipStepRange(currentx, stepx, ownMin[notMainDirInf], ownMax[notMainDirInf], ns, first, last);
+      ClipStepRange(currenty, stepy, ownMin[notMainDirSup], ownMax[notMainDirSup], ns, first, last);
+      if(first>last)
+        continue;
+
       // Compute voxel to millimeters conversion
       stepMM[notMainDirInf] = this->GetInput(0)->GetSpacing()[notMainDirInf] * stepx;
       stepMM[notMainDirSup] = this->GetInput(0)->GetSpacing()[notMainDirSup] * stepy;
       stepMM[mainDir]       = this->GetInput(0)->GetSpacing()[mainDir];
+      const double voxelSize = stepMM.GetNorm();
 
-      if (fs == ns) //If the voxel is a corner, we can skip most steps
-        {
-          BilinearSplatOnBorders(itIn->Get(), fp[mainDir] - np[mainDir], stepMM.GetNorm(),
-                                  pxiyi, pxsyi, pxiys, pxsys, currentx, currenty,
-                                  offsetx, offsety, minx, miny, maxx, maxy);
-        }
-      else
+      // Init data pointer to first pixel of the first slice and go to the
+      // first step
+      const int offsetx = offsets[notMainDirInf];
+      const int offsety = offsets[notMainDirSup];
+      const int offsetz = offsets[mainDir];
+      OutputPixelType *pxiyi = beginBuffer + first * offsetz;
+      currentx += (first-ns) * stepx;
+      currenty += (first-ns) * stepy;
+
+      const InputPixelType rayValue = itIn->Get();
+      for(int i=first; i<=last; i++)
         {
-        // First step
-        BilinearSplatOnBorders(itIn->Get(), residual + 0.5, stepMM.GetNorm(),
-                               pxiyi, pxsyi, pxiys, pxsys, currentx, currenty,
-                               offsetx, offsety, minx, miny, maxx, maxy);
+        // The first and last slices are partially crossed. If the voxel is a
+        // corner, there is a single step.
+        double stepLengthInVoxel = 1.0;
+        bool onBorders = true;
+        if(i==ns)
+          stepLengthInVoxel = (fs == ns)?fp[mainDir] - np[mainDir]:residual + 0.5;
+        else if(i==fs)
+          stepLengthInVoxel = fp[mainDir] - fs + 0.5;
+        else
+          onBorders = false;
+
+        // Only the steps close to the limits of the voxels of the thread need
+        // to check each voxel
+        const int ix = vnl_math_floor(currentx);
+        const int iy = vnl_math_floor(currenty);
+        if(ix >= ownMin[notMainDirInf] && ix < ownMax[notMainDirInf] &&
+           iy >= ownMin[notMainDirSup] && iy < ownMax[notMainDirSup])
+          {
+          if(onBorders)
+            BilinearSplatOnBorders(rayValue, stepLengthInVoxel, voxelSize,
+                                   pxiyi, pxiyi+offsetx, pxiyi+offsety, pxiyi+offsetx+offsety,
+                                   currentx, currenty, offsetx, offsety, minx, miny, maxx, maxy);
+          else
+            BilinearSplat(rayValue, stepLengthInVoxel, voxelSize,
+                          pxiyi, pxiyi+offsetx, pxiyi+offsety, pxiyi+offsetx+offsety,
+                          currentx, currenty, offsetx, offsety);
+          }
+        else
+          BilinearSplatInRegion(rayValue, stepLengthInVoxel, voxelSize, pxiyi,
+                                currentx, currenty, offsetx, offsety, minx, miny, maxx, maxy,
+                                ownMin[notMainDirInf], ownMin[notMainDirSup],
+                                ownMax[notMainDirInf], ownMax[notMainDirSup]);
 
         // Move to next main direction slice
         pxiyi += offsetz;
-        pxsyi += offsetz;
-        pxiys += offsetz;
-        pxsys += offsetz;
         currentx += stepx;
         currenty += stepy;
-
-        // Middle steps
-        for(int i=ns+1; i<fs; i++)
-          {
-          BilinearSplat(itIn->Get(), 1.0, stepMM.GetNorm(), pxiyi, pxsyi, pxiys, pxsys, currentx, currenty, offsetx, offsety);
-
-          // Move to next main direction slice
-          pxiyi += offsetz;
-          pxsyi += offsetz;
-          pxiys += offsetz;
-          pxsys += offsetz;
-          currentx += stepx;
-          currenty += stepy;
-          }
-
-        // Last step
-        BilinearSplatOnBorders(itIn->Get(), fp[mainDir] - fs + 0.5, stepMM.GetNorm(),
-                               pxiyi, pxsyi, pxiys, pxsys, currentx, currenty,
-                               offsetx, offsety, minx, miny, maxx, maxy);
         }
       }
     }
@@ -309,6 +336,97 @@ JosephBackProjectionImageFilter<TInputImage,
 
 }
 
+template <class TInputImage,
+          class TOutputImage,
+          class TSplatWeightMultiplication>
+void
+JosephBackProjectionImageFilter<TInputImage,
+                                   TOutputImage,
+                                   TSplatWeightMultiplication>
+::BilinearSplatInRegion(const InputPixelType rayValue,
+                                              const double stepLengthInVoxel,
+                                              const double voxelSize,
+                                              OutputPixelType *pxiyi,
+                                              const double x,
+                                              const double y,
+                                              const int ox,
+                                              const int oy,
+                                              const CoordRepType minx,
+                                              const CoordRepType miny,
+                                              const CoordRepType maxx,
+                                              const CoordRepType maxy,
+                                              const int ownMinx,
+                                              const int ownMiny,
+                                              const int ownMaxx,
+                                              const int ownMaxy)
+{
+  int ix = vnl_math_floor(x);
+  int iy = vnl_math_floor(y);
+  CoordRepType lx = x - ix;
+  CoordRepType ly = y - iy;
+  CoordRepType lxc = 1.-lx;
+  CoordRepType lyc = 1.-ly;
+
+  // Indices of the (i)nferior and (s)uperior voxels, moved inside the volume
+  // on its borders
+  const int xi = (ix < minx)?ix+1:ix;
+  const int yi = (iy < miny)?iy+1:iy;
+  const int xs = (ix >= maxx)?ix:ix+1;
+  const int ys = (iy >= maxy)?iy:iy+1;
+  const bool xiIn = (xi >= ownMinx && xi <= ownMaxx);
+  const bool yiIn = (yi >= ownMiny && yi <= ownMaxy);
+  const bool xsIn = (xs >= ownMinx && xs <= ownMaxx);
+  const bool ysIn = (ys >= ownMiny && ys <= ownMaxy);
+
+  if(xiIn && yiIn)
+    pxiyi[xi*ox + yi*oy] += m_SplatWeightMultiplication(rayValue, stepLengthInVoxel, voxelSize, lxc * lyc);
+  if(xiIn && ysIn)
+    pxiyi[xi*ox + ys*oy] += m_SplatWeightMultiplication(rayValue, stepLengthInVoxel, voxelSize, lxc * ly);
+  if(xsIn && yiIn)
+    pxiyi[xs*ox + yi*oy] += m_SplatWeightMultiplication(rayValue, stepLengthInVoxel, voxelSize, lx * lyc);
+  if(xsIn && ysIn)
+    pxiyi[xs*ox + ys*oy] += m_SplatWeightMultiplication(rayValue, stepLengthInVoxel, voxelSize, lx * ly);
+}
+
+template <class TInputImage,
+          class TOutputImage,
+          class TSplatWeightMultiplication>
+void
+JosephBackProjectionImageFilter<TInputImage,
+                                   TOutputImage,
+                                   TSplatWeightMultiplication>
+::ClipStepRange(const CoordRepType c0,
+                const CoordRepType step,
+                const int ownMin,
+                const int ownMax,
+                const int ns,
+                int &first,
+                int &last)
+{
+  // A step splats in the voxels [floor(c), floor(c)+1], possibly moved by one
+  // voxel on the borders of the volume. Keep a margin around the voxels of
+  // the thread to be robust to rounding.
+  const CoordRepType lo = ownMin - 1.5;
+  const CoordRepType hi = ownMax + 1.5;
+  if(first > last)
+    return;
+  if(vnl_math_abs(step) < 1e-10)
+    {
+    if(c0 < lo || c0 > hi)
+      last = first - 1;
+    return;
+    }
+
+  CoordRepType t1 = (lo - c0) / step;
+  CoordRepType t2 = (hi - c0) / step;
+  if(t1 > t2)
+    std::swap(t1, t2);
+  t1 = std::max(t1, CoordRepType(first - ns - 1));
+  t2 = std::min(t2, CoordRepType(last - ns + 1));
+  first = std::max(first, ns + vnl_math_floor(t1));
+  last  = std::min(last,  ns + vnl_math_ceil(t2));
+}
+
 
 } // end namespace rtk
 
@@ -22,6 +22,7 @@
 #include "rtkConfiguration.h"
 #include "rtkForwardProjectionImageFilter.h"
 #include "rtkMacro.h"
+#include "rtkForwardProjectionKernels.h"
 
 namespace rtk
 {
@@ -59,6 +60,65 @@ public:
   }
 };
 
+/** \brief Bilinear interpolation along a packet of ForwardProjectionPacketSize
+ * rays of the Joseph forward projection with the fastest SIMD kernel
+ * available, see ForwardProjectBilinearPacketAVX2 for the description of the
+ * parameters. Returns false if there is no SIMD kernel for this interpolation
+ * weight multiplication and this pixel type, in which case nothing is done
+ * and the rays must be traced with the scalar code. Only the default
+ * InterpolationWeightMultiplication of float volumes has one.
+ *
+ * \ingroup Functions
+ */
+template< class TInterpolationWeightMultiplication, class TInputPixel >
+inline bool
+InterpolateBilinearPacket(const TInterpolationWeightMultiplication &,
+                          const TInputPixel *,
+                          const std::ptrdiff_t,
+                          const unsigned int,
+                          const int,
+                          const int,
+                          const int,
+                          const int,
+                          const int,
+                          const int,
+                          const float *,
+                          const float *,
+                          const float *,
+                          const float *,
+                          float *)
+{
+  return false;
+}
+
+inline bool
+InterpolateBilinearPacket(const InterpolationWeightMultiplication<float, double> &,
+                          const float *pSlice,
+                          const std::ptrdiff_t sliceStride,
+                          const unsigned int nSteps,
+                          const int ox,
+                          const int oy,
+                          const int xMin,
+                          const int xMax,
+                          const int yMin,
+                          const int yMax,
+                          const float *x,
+                          const float *dx,
+                          const float *y,
+                          const float *dy,
+                          float *sum)
+{
+#ifdef RTK_USE_AVX2
+  if( IsAVX2BackProjectionAvailable() )
+    {
+    ForwardProjectBilinearPacketAVX2(pSlice, sliceStride, nSteps, ox, oy, xMin, xMax, yMin, yMax,
+                                     x, dx, y, dy, sum);
+    return true;
+    }
+#endif
+  return false;
+}
+
 /** \class ProjectedValueAccumulation
  * \brief Function to accumulate the ray casting on the projection.
  *
@@ -97,6 +157,27 @@ public:
     }
 };
 
+/** \brief Returns true if the accumulation functor is ProjectedValueAccumulation,
+ * which sets the pixels whose rays miss the volume to the input value. Used
+ * to check whether ray culling is possible, see
+ * ForwardProjectionImageFilter::CanCullRays.
+ *
+ * \ingroup Functions
+ */
+template< class TProjectedValueAccumulation >
+inline bool
+IsDefaultProjectedValueAccumulation(const TProjectedValueAccumulation &)
+{
+  return false;
+}
+
+template< class TInput, class TOutput >
+inline bool
+IsDefaultProjectedValueAccumulation(const ProjectedValueAccumulation<TInput, TOutput> &)
+{
+  return true;
+}
+
 } // end namespace Functor
 
 
@@ -108,6 +189,13 @@ public:
  * has been placed after the source and the volume. If the detector is in the volume
  * the ray tracing is performed only until that point.
  *
+ * The rays are traced by packets of ForwardProjectionPacketSize adjacent
+ * detector pixels. When the rays of a packet have the same main direction,
+ * the slices crossed by all of them are interpolated simultaneously with SIMD
+ * instructions if available for the functor and the pixel type, see
+ * Functor::InterpolateBilinearPacket. The first and last slices of each ray
+ * and the rays of incomplete packets are traced one at a time.
+ *
  * \test rtkforwardprojectiontest.cxx
  *
  * \author Simon Rit
@@ -176,6 +264,13 @@ protected:
    * to verify. */
   void VerifyInputInformation() ITK_OVERRIDE {}
 
+  /** Other accumulation functors may change the pixels whose rays miss the
+   * volume, which are then traced. */
+  bool CanCullRays() const ITK_OVERRIDE
+    {
+    return Functor::IsDefaultProjectedValueAccumulation(m_ProjectedValueAccumulation);
+    }
+
   inline OutputPixelType BilinearInterpolation(const ThreadIdType threadId,
                                                const double stepLengthInVoxel,
                                                const InputPixelType *pxiyi,
@@ -203,6 +298,29 @@ protected:
                                                const double maxy);
 
 private:
+  /** Ray crossing the volume, see ThreadedGenerateData */
+  struct RayType
+    {
+    VectorType       source;
+    VectorType       sourceToPixel;
+    VectorType       np;
+    VectorType       fp;
+    VectorType       stepMM;
+    bool             intersect;
+    unsigned int     mainDir;
+    unsigned int     notMainDirInf;
+    unsigned int     notMainDirSup;
+    int              ns;
+    int              fs;
+    CoordRepType     residual;
+    CoordRepType     stepx;
+    CoordRepType     stepy;
+    CoordRepType     currentx;
+    CoordRepType     currenty;
+    InputPixelType   input;
+    OutputPixelType *output;
+    };
+
   JosephForwardProjectionImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&);                     //purposely not implemented
 
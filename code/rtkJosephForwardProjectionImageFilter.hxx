@@ -62,16 +62,6 @@ JosephForwardProjectionImageFilter<TInputImage,
   typename Superclass::GeometryType::ThreeDHomogeneousMatrixType volPPToIndex;
   volPPToIndex = GetPhysicalPointToIndexMatrix( this->GetInput(1) );
 
-  // Iterators on input and output projections
-  typedef ProjectionsRegionConstIteratorRayBased<TInputImage> InputRegionIterator;
-  InputRegionIterator *itIn;
-  itIn = InputRegionIterator::New(this->GetInput(),
-                                  outputRegionForThread,
-                                  geometry,
-                                  volPPToIndex);
-  typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
-  OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
-
   // Create intersection functions, one for each possible main direction
   typedef rtk::RayBoxIntersectionFunction<CoordRepType, Dimension> RBIFunctionType;
   typename RBIFunctionType::Pointer rbi = RBIFunctionType::New();
@@ -85,151 +75,307 @@ JosephForwardProjectionImageFilter<TInputImage,
   rbi->SetBoxMin(boxMin);
   rbi->SetBoxMax(boxMax);
 
-  // Go over each pixel of the projection
-  typename RBIFunctionType::VectorType stepMM, np, fp;
-  for(unsigned int pix=0; pix<outputRegionForThread.GetNumberOfPixels(); pix++, itIn->Next(), ++itOut)
-    {
-    typename InputRegionIterator::PointType sourcePosition = itIn->GetSourcePosition();
-    typename InputRegionIterator::PointType dirVox = itIn->GetSourceToPixel();
+  // Projection of the minimum and maximum indices of the volume
+  const CoordRepType minmax[2][3] = {{rbi->GetBoxMin()[0], rbi->GetBoxMin()[1], rbi->GetBoxMin()[2]},
+                                     {rbi->GetBoxMax()[0], rbi->GetBoxMax()[1], rbi->GetBoxMax()[2]}};
 
-    //Set source
-    rbi->SetRayOrigin( sourcePosition );
+  // Only the rays of the pixels in the bounding rectangle of the projection
+  // of the volume are traced, one region per projection
+  std::vector<OutputImageRegionType> regions;
+  this->CullRays(outputRegionForThread, regions);
 
-    // Select main direction
-    unsigned int mainDir = 0;
-    typename RBIFunctionType::VectorType dirVoxAbs;
-    for(unsigned int i=0; i<Dimension; i++)
+  // Iterators on input and output projections
+  typedef ProjectionsRegionConstIteratorRayBased<TInputImage> InputRegionIterator;
+  typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
+  const typename Superclass::EmptySpaceGridType *grid = this->GetEmptySpaceGrid();
+  RayType rays[ForwardProjectionPacketSize];
+  for(unsigned int iRegion=0; iRegion<regions.size(); iRegion++)
+    {
+    InputRegionIterator *itIn;
+    itIn = InputRegionIterator::New(this->GetInput(),
+                                    regions[iRegion],
+                                    geometry,
+                                    volPPToIndex);
+    OutputRegionIterator itOut(this->GetOutput(), regions[iRegion]);
+
+    // Go over each pixel of the projection by packets of rays. The rays of a
+    // packet are first intersected with the volume. If they all cross it with
+    // the same main direction, the middle steps which are common to all rays
+    // are interpolated simultaneously with SIMD instructions, if available.
+    // The other steps are traced one ray at a time, skipping the empty bricks
+    // if an empty space grid is used, which does not change the result.
+    const unsigned int nPixels = regions[iRegion].GetNumberOfPixels();
+    for(unsigned int pix=0; pix<nPixels; pix+=ForwardProjectionPacketSize)
       {
-      dirVoxAbs[i] = vnl_math_abs( dirVox[i] );
-      if(dirVoxAbs[i]>dirVoxAbs[mainDir])
-        mainDir = i;
-      }
+      const unsigned int nRays = std::min(ForwardProjectionPacketSize, nPixels-pix);
+      bool packet = (nRays == ForwardProjectionPacketSize);
+      for(unsigned int r=0; r<nRays; r++, itIn->Next(), ++itOut)
+        {
+        RayType &ray = rays[r];
+        ray.source = itIn->GetSourcePosition();
+        ray.sourceToPixel = itIn->GetSourceToPixel();
+        ray.input = itIn->Get();
+        ray.output = &(itOut.Value());
+
+        //Set source
+        rbi->SetRayOrigin( ray.source );
+
+        // Select main direction
+        ray.mainDir = 0;
+        typename RBIFunctionType::VectorType dirVoxAbs;
+        for(unsigned int i=0; i<Dimension; i++)
+          {
+          dirVoxAbs[i] = vnl_math_abs( ray.sourceToPixel[i] );
+          if(dirVoxAbs[i]>dirVoxAbs[ray.mainDir])
+            ray.mainDir = i;
+          }
 
-    // Test if there is an intersection
-    if( rbi->Evaluate(&dirVox[0]) &&
-        rbi->GetFarthestDistance()>=0. && // check if detector after the source
-        rbi->GetNearestDistance()<=1.)    // check if detector after or in the volume
-      {
-      // Clip the casting between source and pixel of the detector
-      rbi->SetNearestDistance ( std::max(rbi->GetNearestDistance() , 0.) );
-      rbi->SetFarthestDistance( std::min(rbi->GetFarthestDistance(), 1.) );
-
-      // Compute and sort intersections: (n)earest and (f)arthest (p)points
-      np = rbi->GetNearestPoint();
-      fp = rbi->GetFarthestPoint();
-      if(np[mainDir]>fp[mainDir])
-        std::swap(np, fp);
-
-      // Compute main nearest and farthest slice indices
-      const int ns = vnl_math_rnd( np[mainDir]);
-      const int fs = vnl_math_rnd( fp[mainDir]);
-
-      // Determine the other two directions
-      unsigned int notMainDirInf = (mainDir+1)%Dimension;
-      unsigned int notMainDirSup = (mainDir+2)%Dimension;
-      if(notMainDirInf>notMainDirSup)
-        std::swap(notMainDirInf, notMainDirSup);
-
-      const CoordRepType minx = rbi->GetBoxMin()[notMainDirInf];
-      const CoordRepType miny = rbi->GetBoxMin()[notMainDirSup];
-      const CoordRepType maxx = rbi->GetBoxMax()[notMainDirInf];
-      const CoordRepType maxy = rbi->GetBoxMax()[notMainDirSup];
-
-      // Init data pointers to first pixel of slice ns (i)nferior and (s)uperior (x|y) corner
-      const int offsetx = offsets[notMainDirInf];
-      const int offsety = offsets[notMainDirSup];
-      const int offsetz = offsets[mainDir];
-      const typename TInputImage::PixelType *pxiyi, *pxsyi, *pxiys, *pxsys;
-
-      pxiyi = beginBuffer + ns * offsetz;
-      pxsyi = pxiyi + offsetx;
-      pxiys = pxiyi + offsety;
-      pxsys = pxsyi + offsety;
-
-      // Compute step size and go to first voxel
-      const CoordRepType residual = ns - np[mainDir];
-      const CoordRepType norm = 1/dirVox[mainDir];
-      const CoordRepType stepx = dirVox[notMainDirInf] * norm;
-      const CoordRepType stepy = dirVox[notMainDirSup] * norm;
-      CoordRepType currentx = np[notMainDirInf] + residual * stepx;
-      CoordRepType currenty = np[notMainDirSup] + residual * stepy;
-
-      // Initialize the accumulation
-      typename TOutputImage::PixelType sum = 0;
-
-      if (fs == ns) //If the voxel is a corner, we can skip most steps
+        // Test if there is an intersection
+        ray.intersect = rbi->Evaluate(&ray.sourceToPixel[0]) &&
+                        rbi->GetFarthestDistance()>=0. && // check if detector after the source
+                        rbi->GetNearestDistance()<=1.;    // check if detector after or in the volume
+        if(!ray.intersect)
+          {
+          packet = false;
+          continue;
+          }
+
+        // Clip the casting between source and pixel of the detector
+        rbi->SetNearestDistance ( std::max(rbi->GetNearestDistance() , 0.) );
+        rbi->SetFarthestDistance( std::min(rbi->GetFarthestDistance(), 1.) );
+
+        // Compute and sort intersections: (n)earest and (f)arthest (p)points
+        ray.np = rbi->GetNearestPoint();
+        ray.fp = rbi->GetFarthestPoint();
+        if(ray.np[ray.mainDir]>ray.fp[ray.mainDir])
+          std::swap(ray.np, ray.fp);
+
+        // Compute main nearest and farthest slice indices
+        ray.ns = vnl_math_rnd( ray.np[ray.mainDir]);
+        ray.fs = vnl_math_rnd( ray.fp[ray.mainDir]);
+
+        // Determine the other two directions
+        ray.notMainDirInf = (ray.mainDir+1)%Dimension;
+        ray.notMainDirSup = (ray.mainDir+2)%Dimension;
+        if(ray.notMainDirInf>ray.notMainDirSup)
+          std::swap(ray.notMainDirInf, ray.notMainDirSup);
+
+        // Compute step size and first voxel
+        ray.residual = ray.ns - ray.np[ray.mainDir];
+        const CoordRepType norm = 1/ray.sourceToPixel[ray.mainDir];
+        ray.stepx = ray.sourceToPixel[ray.notMainDirInf] * norm;
+        ray.stepy = ray.sourceToPixel[ray.notMainDirSup] * norm;
+        ray.currentx = ray.np[ray.notMainDirInf] + ray.residual * ray.stepx;
+        ray.currenty = ray.np[ray.notMainDirSup] + ray.residual * ray.stepy;
+
+        // Compute voxel to millimeters conversion
+        ray.stepMM[ray.notMainDirInf] = this->GetInput(1)->GetSpacing()[ray.notMainDirInf] * ray.stepx;
+        ray.stepMM[ray.notMainDirSup] = this->GetInput(1)->GetSpacing()[ray.notMainDirSup] * ray.stepy;
+        ray.stepMM[ray.mainDir]       = this->GetInput(1)->GetSpacing()[ray.mainDir];
+
+        if(ray.mainDir != rays[0].mainDir)
+          packet = false;
+        }
+
+      // Middle steps common to all the rays of the packet, i.e., the slices
+      // crossed by all rays except their first and last ones
+      bool packetInterpolated = false;
+      int packetFirst = 0;
+      int packetLast = 0;
+      OutputPixelType packetSums[ForwardProjectionPacketSize];
+      if(packet)
         {
-          sum += BilinearInterpolationOnBorders(threadId, fp[mainDir] - np[mainDir],
-                                                pxiyi, pxsyi, pxiys, pxsys,
-                                                currentx, currenty, offsetx, offsety,
-                                                minx, miny, maxx, maxy);
+        const unsigned int mainDir = rays[0].mainDir;
+        const unsigned int notMainDirInf = rays[0].notMainDirInf;
+        const unsigned int notMainDirSup = rays[0].notMainDirSup;
+        packetFirst = itk::NumericTraits<int>::NonpositiveMin();
+        packetLast = itk::NumericTraits<int>::max();
+        for(unsigned int r=0; r<nRays; r++)
+          {
+          packetFirst = std::max(packetFirst, rays[r].ns+1);
+          packetLast = std::min(packetLast, rays[r].fs-1);
+          }
+
+        // The clamping of the indices in the SIMD kernel requires two slices
+        // in both directions
+        const int minx = vnl_math_rnd(minmax[0][notMainDirInf]);
+        const int miny = vnl_math_rnd(minmax[0][notMainDirSup]);
+        const int maxx = vnl_math_rnd(minmax[1][notMainDirInf]);
+        const int maxy = vnl_math_rnd(minmax[1][notMainDirSup]);
+        if(packetFirst<=packetLast && minx<maxx && miny<maxy)
+          {
+          float x[ForwardProjectionPacketSize], dx[ForwardProjectionPacketSize];
+          float y[ForwardProjectionPacketSize], dy[ForwardProjectionPacketSize];
+          float sums[ForwardProjectionPacketSize];
+          for(unsigned int r=0; r<nRays; r++)
+            {
+            x[r] = rays[r].currentx + (packetFirst-rays[r].ns) * rays[r].stepx;
+            y[r] = rays[r].currenty + (packetFirst-rays[r].ns) * rays[r].stepy;
+            dx[r] = rays[r].stepx;
+            dy[r] = rays[r].stepy;
+            sums[r] = 0.f;
+            }
+          if( Functor::InterpolateBilinearPacket(m_InterpolationWeightMultiplication,
+                                                 beginBuffer + packetFirst * offsets[mainDir],
+                                                 offsets[mainDir],
+                                                 packetLast-packetFirst+1,
+                                                 offsets[notMainDirInf],
+                                                 offsets[notMainDirSup],
+                                                 minx, maxx-1, miny, maxy-1,
+                                                 x, dx, y, dy, sums) )
+            {
+            packetInterpolated = true;
+            for(unsigned int r=0; r<nRays; r++)
+              packetSums[r] = sums[r];
+            }
+          }
         }
-      else
+
+      // Trace the remaining steps of each ray
+      for(unsigned int r=0; r<nRays; r++)
         {
-        // First step
-        sum += BilinearInterpolationOnBorders(threadId, residual + 0.5,
-                                              pxiyi, pxsyi, pxiys, pxsys,
-                                              currentx, currenty, offsetx, offsety,
-                                              minx, miny, maxx, maxy);
-
-        // Move to next main direction slice
-        pxiyi += offsetz;
-        pxsyi += offsetz;
-        pxiys += offsetz;
-        pxsys += offsetz;
-        currentx += stepx;
-        currenty += stepy;
-
-        // Middle steps
-        for(int i=ns+1; i<fs; i++)
+        RayType &ray = rays[r];
+        if(!ray.intersect)
           {
-          sum += BilinearInterpolation(threadId, 1.0,
-                                       pxiyi, pxsyi, pxiys, pxsys,
-                                       currentx, currenty, offsetx, offsety);
+          m_ProjectedValueAccumulation(threadId,
+                                       ray.input,
+                                       *ray.output,
+                                       0.,
+                                       ray.source,
+                                       ray.source,
+                                       ray.sourceToPixel,
+                                       ray.source,
+                                       ray.source);
+          continue;
+          }
+
+        const CoordRepType minx = minmax[0][ray.notMainDirInf];
+        const CoordRepType miny = minmax[0][ray.notMainDirSup];
+        const CoordRepType maxx = minmax[1][ray.notMainDirInf];
+        const CoordRepType maxy = minmax[1][ray.notMainDirSup];
+
+        // Init data pointers to first pixel of slice ns (i)nferior and (s)uperior (x|y) corner
+        const int offsetx = offsets[ray.notMainDirInf];
+        const int offsety = offsets[ray.notMainDirSup];
+        const int offsetz = offsets[ray.mainDir];
+        const typename TInputImage::PixelType *pxiyi, *pxsyi, *pxiys, *pxsys;
+
+        pxiyi = beginBuffer + ray.ns * offsetz;
+        pxsyi = pxiyi + offsetx;
+        pxiys = pxiyi + offsety;
+        pxsys = pxsyi + offsety;
+        CoordRepType currentx = ray.currentx;
+        CoordRepType currenty = ray.currenty;
+
+        // Initialize the accumulation
+        typename TOutputImage::PixelType sum = 0;
+
+        if (ray.fs == ray.ns) //If the voxel is a corner, we can skip most steps
+          {
+            sum += BilinearInterpolationOnBorders(threadId, ray.fp[ray.mainDir] - ray.np[ray.mainDir],
+                                                  pxiyi, pxsyi, pxiys, pxsys,
+                                                  currentx, currenty, offsetx, offsety,
+                                                  minx, miny, maxx, maxy);
+          }
+        else
+          {
+          // First step
+          sum += BilinearInterpolationOnBorders(threadId, ray.residual + 0.5,
+                                                pxiyi, pxsyi, pxiys, pxsys,
+                                                currentx, currenty, offsetx, offsety,
+                                                minx, miny, maxx, maxy);
 
           // Move to next main direction slice
           pxiyi += offsetz;
           pxsyi += offsetz;
           pxiys += offsetz;
           pxsys += offsetz;
-          currentx += stepx;
-          currenty += stepy;
+          currentx += ray.stepx;
+          currenty += ray.stepy;
+
+          // Middle steps, skipping those which have been interpolated with the
+          // packet
+          for(int i=ray.ns+1; i<ray.fs; i++)
+            {
+            if(packetInterpolated && i == packetFirst)
+              {
+              const int nSkipped = packetLast-packetFirst+1;
+              sum += packetSums[r];
+              pxiyi += nSkipped * offsetz;
+              pxsyi += nSkipped * offsetz;
+              pxiys += nSkipped * offsetz;
+              pxsys += nSkipped * offsetz;
+              currentx += nSkipped * ray.stepx;
+              currenty += nSkipped * ray.stepy;
+              i = packetLast;
+              continue;
+              }
+
+            // Skip the steps in empty bricks, which interpolate 0. The number
+            // of steps in the brick is conservative and the steps are moved
+            // one by one for the same rounding as without skipping. The skip
+            // stops at the first step of the packet, if any.
+            if(grid)
+              {
+              int index[3];
+              index[ray.mainDir] = i;
+              index[ray.notMainDirInf] = vnl_math_floor(currentx);
+              index[ray.notMainDirSup] = vnl_math_floor(currenty);
+              if(grid->IsEmpty(index))
+                {
+                int nSkipped = std::min(ray.fs-i, grid->GetNumberOfStepsInBrick(ray.mainDir, i, 1.));
+                nSkipped = std::min(nSkipped, grid->GetNumberOfStepsInBrick(ray.notMainDirInf, currentx, ray.stepx));
+                nSkipped = std::min(nSkipped, grid->GetNumberOfStepsInBrick(ray.notMainDirSup, currenty, ray.stepy));
+                if(packetInterpolated && i < packetFirst)
+                  nSkipped = std::min(nSkipped, packetFirst-i);
+                for(int n=0; n<nSkipped; n++)
+                  {
+                  currentx += ray.stepx;
+                  currenty += ray.stepy;
+                  }
+                pxiyi += nSkipped * offsetz;
+                pxsyi += nSkipped * offsetz;
+                pxiys += nSkipped * offsetz;
+                pxsys += nSkipped * offsetz;
+                i += nSkipped-1;
+                continue;
+                }
+              }
+
+            sum += BilinearInterpolation(threadId, 1.0,
+                                         pxiyi, pxsyi, pxiys, pxsys,
+                                         currentx, currenty, offsetx, offsety);
+
+            // Move to next main direction slice
+            pxiyi += offsetz;
+            pxsyi += offsetz;
+            pxiys += offsetz;
+            pxsys += offsetz;
+            currentx += ray.stepx;
+            currenty += ray.stepy;
+            }
+
+          // Last step
+          sum += BilinearInterpolationOnBorders(threadId, ray.fp[ray.mainDir] - ray.fs + 0.5,
+                                                pxiyi, pxsyi, pxiys, pxsys,
+                                                currentx, currenty, offsetx, offsety,
+                                                minx, miny, maxx, maxy);
           }
 
-        // Last step
-        sum += BilinearInterpolationOnBorders(threadId,fp[mainDir] - fs + 0.5,
-                                              pxiyi, pxsyi, pxiys, pxsys,
-                                              currentx, currenty, offsetx, offsety,
-                                              minx, miny, maxx, maxy);
+        // Accumulate
+        m_ProjectedValueAccumulation(threadId,
+                                     ray.input,
+                                     *ray.output,
+                                     sum,
+                                     ray.stepMM,
+                                     ray.source,
+                                     ray.sourceToPixel,
+                                     ray.np,
+                                     ray.fp);
         }
-      // Compute voxel to millimeters conversion
-      stepMM[notMainDirInf] = this->GetInput(1)->GetSpacing()[notMainDirInf] * stepx;
-      stepMM[notMainDirSup] = this->GetInput(1)->GetSpacing()[notMainDirSup] * stepy;
-      stepMM[mainDir]       = this->GetInput(1)->GetSpacing()[mainDir];
-
-      // Accumulate
-      m_ProjectedValueAccumulation(threadId,
-                                   itIn->Get(),
-                                   itOut.Value(),
-                                   sum,
-                                   stepMM,
-                                   sourcePosition,
-                                   dirVox,
-                                   np,
-                                   fp);
       }
-    else
-      m_ProjectedValueAccumulation(threadId,
-                                   itIn->Get(),
-                                   itOut.Value(),
-                                   0.,
-                                   sourcePosition,
-                                   sourcePosition,
-                                   dirVox,
-                                   sourcePosition,
-                                   sourcePosition);
+    delete itIn;
     }
-  delete itIn;
 }
 
 template <class TInputImage,
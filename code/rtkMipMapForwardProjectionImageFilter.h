@@ -0,0 +1,123 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkMipMapForwardProjectionImageFilter_h
+#define rtkMipMapForwardProjectionImageFilter_h
+
+#include "rtkConfiguration.h"
+#include "rtkForwardProjectionImageFilter.h"
+
+#include <vector>
+
+namespace rtk
+{
+
+/** \class MipMapForwardProjectionImageFilter
+ * \brief Level-of-detail forward projection in a mip pyramid of the volume.
+ *
+ * A pyramid of the input volume is computed with itk::BinShrinkImageFilter,
+ * each level averaging the voxels of the previous one by bins of 2x2x2
+ * voxels. Levels with an odd number of voxels along a dimension are padded
+ * with a slab of zeros before the binning so that the last slab of voxels is
+ * kept. The pyramid is kept between updates and only recomputed when the
+ * volume or NumberOfLevels change. Each ray is traced in the level whose voxel size best matches the
+ * footprint of the detector pixel in the volume, i.e., the largest level with
+ * voxels smaller than the pixel size scaled to the middle of the intersection
+ * of the ray with the volume. The rays are sampled every StepSize mm times
+ * the bin size of the level with trilinear interpolation, see
+ * RayCastSampling. With fine detectors, all rays use the full resolution
+ * volume and the result is that of RayCastForwardProjectionImageFilter.
+ *
+ * This is faster and less aliased than the other forward projectors when the
+ * detector pixels are large compared to the voxels, e.g., with binned
+ * projections or coarse iterations of a multiresolution reconstruction.
+ *
+ * \test rtkforwardprojectiontest.cxx
+ *
+ * \ingroup Projector
+ */
+
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT MipMapForwardProjectionImageFilter :
+  public ForwardProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef MipMapForwardProjectionImageFilter                     Self;
+  typedef ForwardProjectionImageFilter<TInputImage,TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                                Pointer;
+  typedef itk::SmartPointer<const Self>                          ConstPointer;
+
+  /** Useful typedefs. */
+  typedef typename TInputImage::PixelType                        InputPixelType;
+  typedef typename TOutputImage::RegionType                      OutputImageRegionType;
+  typedef typename TInputImage::Pointer                          LevelPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MipMapForwardProjectionImageFilter, ForwardProjectionImageFilter);
+
+  /** Set step size along ray (in mm) in the full resolution volume. It is
+   * multiplied by the bin size in the other levels. Default is 1 mm. */
+  itkGetConstMacro(StepSize, double);
+  itkSetMacro(StepSize, double);
+
+  /** Get / Set the maximum number of levels of the pyramid, including the
+   * full resolution volume. Levels with less than 2 voxels along one
+   * dimension are not computed. Default is 4. */
+  itkGetConstMacro(NumberOfLevels, unsigned int);
+  itkSetMacro(NumberOfLevels, unsigned int);
+
+protected:
+  MipMapForwardProjectionImageFilter();
+  ~MipMapForwardProjectionImageFilter() {}
+
+  /** Computes the pyramid of the input volume if it is not up to date. */
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+  void VerifyInputInformation() ITK_OVERRIDE {}
+
+private:
+  MipMapForwardProjectionImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                     //purposely not implemented
+
+  double                           m_StepSize;
+  unsigned int                     m_NumberOfLevels;
+  std::vector<LevelPointer>        m_Levels;
+
+  /** Volume and number of levels used for the last computation of the pyramid */
+  const TInputImage               *m_LevelsVolume;
+  const void                      *m_LevelsBuffer;
+  typename TInputImage::RegionType m_LevelsRegion;
+  unsigned int                     m_LevelsNumberOfLevels;
+  itk::TimeStamp                   m_LevelsComputationTime;
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkMipMapForwardProjectionImageFilter.hxx"
+#endif
+
+#endif
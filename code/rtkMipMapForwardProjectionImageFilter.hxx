@@ -0,0 +1,261 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkMipMapForwardProjectionImageFilter_hxx
+#define rtkMipMapForwardProjectionImageFilter_hxx
+
+#include "rtkHomogeneousMatrix.h"
+#include "rtkProjectionsRegionConstIteratorRayBased.h"
+#include "rtkRayCastSampling.h"
+
+#include <itkBinShrinkImageFilter.h>
+#include <itkConstantPadImageFilter.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <limits>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+MipMapForwardProjectionImageFilter<TInputImage,TOutputImage>
+::MipMapForwardProjectionImageFilter():
+  m_StepSize(1.),
+  m_NumberOfLevels(4),
+  m_LevelsVolume(ITK_NULLPTR),
+  m_LevelsBuffer(ITK_NULLPTR),
+  m_LevelsNumberOfLevels(0)
+{
+}
+
+template <class TInputImage, class TOutputImage>
+void
+MipMapForwardProjectionImageFilter<TInputImage,TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  // Check if the pyramid is up to date, e.g., for each streamed region of
+  // the projections
+  const TInputImage *volume = this->GetInput(1);
+  if(volume == m_LevelsVolume &&
+     volume->GetBufferPointer() == m_LevelsBuffer &&
+     volume->GetBufferedRegion() == m_LevelsRegion &&
+     m_NumberOfLevels == m_LevelsNumberOfLevels &&
+     volume->GetMTime() < m_LevelsComputationTime.GetMTime() &&
+     volume->GetUpdateMTime() < m_LevelsComputationTime.GetMTime())
+    return;
+
+  // The first level is a shallow copy of the volume to run the binning
+  // outside of the pipeline of the input
+  m_Levels.clear();
+  LevelPointer level = TInputImage::New();
+  level->Graft( volume );
+  m_Levels.push_back(level);
+
+  typedef itk::ConstantPadImageFilter<TInputImage, TInputImage> PadType;
+  typedef itk::BinShrinkImageFilter<TInputImage, TInputImage> BinType;
+  typename BinType::ShrinkFactorsType factors;
+  factors.Fill(2);
+  while(m_Levels.size() < m_NumberOfLevels)
+    {
+    bool tooSmall = false;
+    typename TInputImage::SizeType padding;
+    for(unsigned int i=0; i<TInputImage::ImageDimension; i++)
+      {
+      tooSmall |= (m_Levels.back()->GetBufferedRegion().GetSize(i) < 4);
+      padding[i] = m_Levels.back()->GetBufferedRegion().GetSize(i) % 2;
+      }
+    if(tooSmall)
+      break;
+
+    // BinShrinkImageFilter drops the last slab of odd dimensions, which is
+    // binned with a slab of zeros instead
+    typename PadType::Pointer pad = PadType::New();
+    pad->SetInput( m_Levels.back() );
+    pad->SetPadUpperBound( padding );
+    pad->SetConstant( itk::NumericTraits<InputPixelType>::ZeroValue() );
+
+    typename BinType::Pointer bin = BinType::New();
+    bin->SetInput( pad->GetOutput() );
+    bin->SetShrinkFactors( factors );
+    bin->Update();
+    level = bin->GetOutput();
+    level->DisconnectPipeline();
+    m_Levels.push_back(level);
+    }
+
+  m_LevelsVolume = volume;
+  m_LevelsBuffer = volume->GetBufferPointer();
+  m_LevelsRegion = volume->GetBufferedRegion();
+  m_LevelsNumberOfLevels = m_NumberOfLevels;
+  m_LevelsComputationTime.Modified();
+}
+
+template <class TInputImage, class TOutputImage>
+void
+MipMapForwardProjectionImageFilter<TInputImage,TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId) )
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const typename Superclass::GeometryPointer geometry = this->GetGeometry();
+  const unsigned int nLevels = m_Levels.size();
+
+  // Sampling of each level in its buffered region. The offsets are relative
+  // to the voxel of index (0,0,0), which may not be in the buffer. The ray is
+  // converted from the indices of the first level to the indices of each
+  // level with levelMatrices.
+  std::vector<RayCastSampling> samplings;
+  std::vector<const InputPixelType *> beginBuffers;
+  typedef itk::Matrix<double, Dimension+1, Dimension+1> LevelMatrixType;
+  std::vector<LevelMatrixType> levelMatrices;
+  double maxSpacing = 0.;
+  for(unsigned int l=0; l<nLevels; l++)
+    {
+    const TInputImage *volume = m_Levels[l];
+    const typename TInputImage::RegionType &volRegion = volume->GetBufferedRegion();
+    int boxMin[3], boxMax[3];
+    std::ptrdiff_t offsets[3];
+    double spacing[3];
+    offsets[0] = 1;
+    offsets[1] = volRegion.GetSize(0);
+    offsets[2] = volRegion.GetSize(0) * volRegion.GetSize(1);
+    const InputPixelType *beginBuffer = volume->GetBufferPointer();
+    for(unsigned int i=0; i<Dimension; i++)
+      {
+      boxMin[i] = volRegion.GetIndex(i);
+      boxMax[i] = volRegion.GetIndex(i) + volRegion.GetSize(i) - 1;
+      spacing[i] = volume->GetSpacing()[i];
+      beginBuffer -= offsets[i] * volRegion.GetIndex(i);
+      if(l==0)
+        maxSpacing = std::max(maxSpacing, spacing[i]);
+      }
+    samplings.push_back( RayCastSampling(boxMin, boxMax, offsets, spacing, m_StepSize * (1<<l)) );
+    beginBuffers.push_back(beginBuffer);
+    levelMatrices.push_back( LevelMatrixType( GetPhysicalPointToIndexMatrix( volume ).GetVnlMatrix() *
+                                              GetIndexToPhysicalPointMatrix( m_Levels[0].GetPointer() ).GetVnlMatrix() ) );
+    }
+
+  // Box of the first level, voxel borders included, to compute the middle
+  // of the intersection of each ray with the volume
+  double volMin[3], volMax[3];
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    volMin[i] = m_Levels[0]->GetBufferedRegion().GetIndex(i) - 0.5;
+    volMax[i] = volMin[i] + m_Levels[0]->GetBufferedRegion().GetSize(i);
+    }
+  const double pixelSize = std::max(this->GetInput()->GetSpacing()[0],
+                                    this->GetInput()->GetSpacing()[1]);
+
+  // volPPToIndex maps the physical 3D coordinates of a point (in mm) to the
+  // corresponding 3D volume index
+  typename Superclass::GeometryType::ThreeDHomogeneousMatrixType volPPToIndex;
+  volPPToIndex = GetPhysicalPointToIndexMatrix( m_Levels[0].GetPointer() );
+
+  // Only the rays of the pixels in the bounding rectangle of the projection
+  // of the volume are traced, one region per projection
+  std::vector<OutputImageRegionType> regions;
+  this->CullRays(outputRegionForThread, regions);
+
+  // Iterators on input and output projections
+  typedef ProjectionsRegionConstIteratorRayBased<TInputImage> InputRegionIterator;
+  typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
+  double weights[8];
+  std::ptrdiff_t voxelOffsets[8];
+  int voxelIndices[8][3];
+  for(unsigned int iRegion=0; iRegion<regions.size(); iRegion++)
+    {
+    InputRegionIterator *itIn;
+    itIn = InputRegionIterator::New(this->GetInput(),
+                                    regions[iRegion],
+                                    geometry,
+                                    volPPToIndex);
+    OutputRegionIterator itOut(this->GetOutput(), regions[iRegion]);
+    const bool parallel = (geometry->GetSourceToDetectorDistances()[ regions[iRegion].GetIndex(2) ] == 0.);
+
+    // Go over each projection pixel
+    for(unsigned int pix=0; pix<regions[iRegion].GetNumberOfPixels(); pix++, itIn->Next(), ++itOut)
+      {
+      const typename InputRegionIterator::PointType source = itIn->GetSourcePosition();
+      const typename InputRegionIterator::PointType sourceToPixel = itIn->GetSourceToPixel();
+
+      // Footprint of the pixel in the middle of the ray in the volume. The
+      // source to pixel vector has length 1 in alpha.
+      double alphaMin = 0.;
+      double alphaMax = std::numeric_limits<double>::max();
+      for(unsigned int i=0; i<Dimension; i++)
+        {
+        if(sourceToPixel[i] != 0.)
+          {
+          const double a0 = (volMin[i] - source[i]) / sourceToPixel[i];
+          const double a1 = (volMax[i] - source[i]) / sourceToPixel[i];
+          alphaMin = std::max(alphaMin, std::min(a0, a1));
+          alphaMax = std::min(alphaMax, std::max(a0, a1));
+          }
+        }
+      if(alphaMin >= alphaMax)
+        {
+        itOut.Set( itIn->Get() );
+        continue;
+        }
+      double footprint = pixelSize;
+      if(!parallel)
+        footprint *= 0.5 * (alphaMin + alphaMax);
+
+      // Largest level with voxels smaller than the footprint
+      unsigned int l = 0;
+      while(l+1 < nLevels && (1<<(l+1)) * maxSpacing <= footprint)
+        l++;
+
+      // Ray in the indices of the level
+      const LevelMatrixType &m = levelMatrices[l];
+      double levelSource[3], levelSourceToPixel[3];
+      for(unsigned int i=0; i<Dimension; i++)
+        {
+        levelSource[i] = m[i][Dimension];
+        levelSourceToPixel[i] = 0.;
+        for(unsigned int j=0; j<Dimension; j++)
+          {
+          levelSource[i] += m[i][j] * source[j];
+          levelSourceToPixel[i] += m[i][j] * sourceToPixel[j];
+          }
+        }
+
+      RayCastSampling &sampling = samplings[l];
+      const InputPixelType *beginBuffer = beginBuffers[l];
+      const unsigned int nSamples = sampling.SetRay(levelSource, levelSourceToPixel);
+      double sum = 0.;
+      for(unsigned int k=0; k<nSamples; k++)
+        {
+        sampling.Interpolation(k, weights, voxelOffsets, voxelIndices);
+        double sample = 0.;
+        for(unsigned int c=0; c<8; c++)
+          sample += weights[c] * beginBuffer[voxelOffsets[c]];
+        sum += sampling.GetWeight(k) * sample;
+        }
+      itOut.Set( itIn->Get() + sum );
+      }
+
+    delete itIn;
+    }
+}
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,144 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkMultiResolutionConeBeamReconstructionFilter_h
+#define rtkMultiResolutionConeBeamReconstructionFilter_h
+
+#include <itkImageToImageFilter.h>
+#include <itkBinShrinkImageFilter.h>
+#include <itkResampleImageFilter.h>
+#include <itkLinearInterpolateImageFunction.h>
+#include <itkTimeProbe.h>
+
+#include <vector>
+
+namespace rtk
+{
+
+/** \class MultiResolutionConeBeamReconstructionFilter
+ * \brief Coarse-to-fine driver of iterative reconstruction filters
+ *
+ * The reconstruction is computed at NumberOfLevels resolutions. Level l uses
+ * a volume and projections binned by a factor 2^l with
+ * itk::BinShrinkImageFilter, along the three dimensions of the volume and
+ * along the two dimensions of each projection, level 0 being the full
+ * resolution. The levels are reconstructed from the coarsest to the finest
+ * one, each one with its own reconstruction filter set with
+ * SetReconstructionFilter. The coarsest level starts from the binned input
+ * volume and each of the other levels starts from the result of the previous
+ * level, upsampled to the grid of the level with itk::ResampleImageFilter and
+ * linear interpolation.
+ *
+ * The early iterations, which mostly correct the low frequencies, are then
+ * computed on smaller volumes with less projection pixels and fewer
+ * iterations are required at full resolution for the same final quality.
+ * The geometry is in physical coordinates and can be shared by the
+ * reconstruction filters of all levels. The reconstruction filters may be of
+ * different types but must have the volume in input 0 and the projections in
+ * input 1. All other inputs of this filter, e.g., the weights of
+ * ConjugateGradientConeBeamReconstructionFilter in input 2, are considered
+ * as projection stacks, binned and passed to the same input of the
+ * reconstruction filters. Named inputs, e.g., support masks, are not
+ * handled and must be set directly on the reconstruction filters.
+ *
+ * \test rtkmultiresolutiontest.cxx
+ *
+ * \ingroup ReconstructionAlgorithm
+ */
+template<class TImage>
+class ITK_EXPORT MultiResolutionConeBeamReconstructionFilter :
+  public itk::ImageToImageFilter<TImage, TImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiResolutionConeBeamReconstructionFilter Self;
+  typedef itk::ImageToImageFilter<TImage, TImage>     Superclass;
+  typedef itk::SmartPointer<Self>                     Pointer;
+  typedef itk::SmartPointer<const Self>               ConstPointer;
+
+  /** Typedefs of the reconstruction filters and of the subfilters */
+  typedef itk::ImageToImageFilter<TImage, TImage>                    ReconstructionFilterType;
+  typedef typename ReconstructionFilterType::Pointer                 ReconstructionFilterPointer;
+  typedef itk::BinShrinkImageFilter<TImage, TImage>                  BinFilterType;
+  typedef itk::ResampleImageFilter<TImage, TImage>                   ResampleFilterType;
+  typedef itk::LinearInterpolateImageFunction<TImage, double>        InterpolatorType;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(MultiResolutionConeBeamReconstructionFilter, itk::ImageToImageFilter);
+
+  /** Get / Set the number of resolution levels, including the full
+   * resolution. It is clamped to [1,16]. Default is 1. The levels whose
+   * binning factor is larger than the largest dimension of the volume are
+   * not reconstructed. */
+  itkGetMacro(NumberOfLevels, unsigned int);
+  void SetNumberOfLevels(unsigned int n);
+
+  /** Get / Set the reconstruction filter of level l, 0 being the full
+   * resolution */
+  ReconstructionFilterType * GetReconstructionFilter(unsigned int l);
+  void SetReconstructionFilter(unsigned int l, ReconstructionFilterType *filter);
+
+  /** The reconstruction filters of the levels are part of the pipeline
+   * of this filter, their modifications must trigger a new execution. */
+  itk::ModifiedTimeType GetMTime() const ITK_OVERRIDE;
+
+  /** Prints the timing of the binning, of the upsampling and of each level.
+   * The timing of the steps of each reconstruction filter is printed by the
+   * PrintTiming method of the filter, if any. */
+  void PrintTiming(std::ostream& os) const;
+
+protected:
+  MultiResolutionConeBeamReconstructionFilter();
+  ~MultiResolutionConeBeamReconstructionFilter() {}
+
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  void GenerateData() ITK_OVERRIDE;
+
+  /** The inputs should not be in the same space so there is nothing
+   * to verify. */
+  void VerifyInputInformation() ITK_OVERRIDE {}
+
+  /** Binning of an image by a factor along the first dimensions, reduced
+   * along each dimension to the size of the image */
+  typename TImage::Pointer Bin(const TImage *image, unsigned int factor, unsigned int dimensions);
+
+private:
+  //purposely not implemented
+  MultiResolutionConeBeamReconstructionFilter(const Self&);
+  void operator=(const Self&);
+
+  unsigned int                             m_NumberOfLevels;
+  std::vector<ReconstructionFilterPointer> m_ReconstructionFilters;
+
+  /** Time probes */
+  itk::TimeProbe m_BinProbe;
+  itk::TimeProbe m_ResampleProbe;
+  std::vector<itk::TimeProbe> m_LevelProbes;
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkMultiResolutionConeBeamReconstructionFilter.hxx"
+#endif
+
+#endif
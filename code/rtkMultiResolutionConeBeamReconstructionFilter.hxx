@@ -0,0 +1,224 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkMultiResolutionConeBeamReconstructionFilter_hxx
+#define rtkMultiResolutionConeBeamReconstructionFilter_hxx
+
+#include "rtkMultiResolutionConeBeamReconstructionFilter.h"
+
+#include <algorithm>
+
+namespace rtk
+{
+
+template<class TImage>
+MultiResolutionConeBeamReconstructionFilter<TImage>
+::MultiResolutionConeBeamReconstructionFilter():
+  m_NumberOfLevels(1),
+  m_ReconstructionFilters(1),
+  m_LevelProbes(1)
+{
+  this->SetNumberOfRequiredInputs(2);
+}
+
+template<class TImage>
+void
+MultiResolutionConeBeamReconstructionFilter<TImage>
+::SetNumberOfLevels(unsigned int n)
+{
+  // The binning factor 2^(n-1) of the coarsest level must be representable
+  n = std::min(std::max(n, 1u), 16u);
+  if(n != m_NumberOfLevels)
+    {
+    m_NumberOfLevels = n;
+    m_ReconstructionFilters.resize(n);
+    m_LevelProbes.resize(n);
+    this->Modified();
+    }
+}
+
+template<class TImage>
+typename MultiResolutionConeBeamReconstructionFilter<TImage>::ReconstructionFilterType *
+MultiResolutionConeBeamReconstructionFilter<TImage>
+::GetReconstructionFilter(unsigned int l)
+{
+  if(l >= m_NumberOfLevels)
+    itkExceptionMacro(<< "Level " << l << " is not in [0," << m_NumberOfLevels << ")");
+  return m_ReconstructionFilters[l].GetPointer();
+}
+
+template<class TImage>
+void
+MultiResolutionConeBeamReconstructionFilter<TImage>
+::SetReconstructionFilter(unsigned int l, ReconstructionFilterType *filter)
+{
+  if(l >= m_NumberOfLevels)
+    itkExceptionMacro(<< "Level " << l << " is not in [0," << m_NumberOfLevels << ")");
+  if(m_ReconstructionFilters[l] != filter)
+    {
+    m_ReconstructionFilters[l] = filter;
+    this->Modified();
+    }
+}
+
+template<class TImage>
+itk::ModifiedTimeType
+MultiResolutionConeBeamReconstructionFilter<TImage>
+::GetMTime() const
+{
+  itk::ModifiedTimeType mtime = Superclass::GetMTime();
+  for(unsigned int l=0; l<m_NumberOfLevels; l++)
+    {
+    if(m_ReconstructionFilters[l].IsNotNull())
+      mtime = std::max(mtime, m_ReconstructionFilters[l]->GetMTime());
+    }
+  return mtime;
+}
+
+template<class TImage>
+void
+MultiResolutionConeBeamReconstructionFilter<TImage>
+::GenerateInputRequestedRegion()
+{
+  // All inputs are binned and fully processed
+  for(unsigned int i=0; i<this->GetNumberOfIndexedInputs(); i++)
+    {
+    TImage *inputPtr = const_cast< TImage * >( this->GetInput(i) );
+    if ( inputPtr )
+      inputPtr->SetRequestedRegion( inputPtr->GetLargestPossibleRegion() );
+    }
+}
+
+template<class TImage>
+typename TImage::Pointer
+MultiResolutionConeBeamReconstructionFilter<TImage>
+::Bin(const TImage *image, unsigned int factor, unsigned int dimensions)
+{
+  typename BinFilterType::ShrinkFactorsType factors;
+  factors.Fill(1);
+  for(unsigned int i=0; i<dimensions; i++)
+    factors[i] = std::min(factor, (unsigned int) image->GetLargestPossibleRegion().GetSize(i));
+
+  typename BinFilterType::Pointer bin = BinFilterType::New();
+  bin->SetInput( image );
+  bin->SetShrinkFactors( factors );
+  bin->Update();
+  typename TImage::Pointer binned = bin->GetOutput();
+  binned->DisconnectPipeline();
+  return binned;
+}
+
+template<class TImage>
+void
+MultiResolutionConeBeamReconstructionFilter<TImage>
+::GenerateData()
+{
+  const unsigned int Dimension = TImage::ImageDimension;
+
+  // Coarser levels than a volume of one voxel along its largest dimension
+  // would all be identical
+  unsigned int maxSize = 1;
+  for(unsigned int i=0; i<Dimension; i++)
+    maxSize = std::max(maxSize, (unsigned int) this->GetInput(0)->GetLargestPossibleRegion().GetSize(i));
+  unsigned int nLevels = m_NumberOfLevels;
+  while(nLevels > 1 && (1u<<(nLevels-1)) > maxSize)
+    nLevels--;
+
+  for(unsigned int l=0; l<nLevels; l++)
+    {
+    if(m_ReconstructionFilters[l].IsNull())
+      itkExceptionMacro(<< "The reconstruction filter of level " << l << " has not been set");
+    }
+
+  // Result of the previous level
+  typename TImage::Pointer pimg;
+
+  for(int l=nLevels-1; l>=0; l--)
+    {
+    ReconstructionFilterType *recon = m_ReconstructionFilters[l];
+    const unsigned int factor = 1<<l;
+
+    // Grid of the volume and projections of the level. The volume is binned
+    // along all dimensions and the projections along their two first
+    // dimensions only.
+    m_BinProbe.Start();
+    typename TImage::Pointer volume = TImage::New();
+    if(l>0)
+      volume = Bin(this->GetInput(0), factor, Dimension);
+    else
+      volume->Graft( this->GetInput(0) );
+    for(unsigned int i=1; i<this->GetNumberOfIndexedInputs(); i++)
+      {
+      if( this->GetInput(i) == ITK_NULLPTR )
+        continue;
+      typename TImage::Pointer projections = TImage::New();
+      if(l>0)
+        projections = Bin(this->GetInput(i), factor, Dimension-1);
+      else
+        projections->Graft( this->GetInput(i) );
+      recon->SetInput(i, projections);
+      }
+    m_BinProbe.Stop();
+
+    // Initial volume of the level
+    if(pimg.IsNull())
+      recon->SetInput(0, volume);
+    else
+      {
+      m_ResampleProbe.Start();
+      typename ResampleFilterType::Pointer resample = ResampleFilterType::New();
+      resample->SetInput( pimg );
+      resample->SetInterpolator( InterpolatorType::New() );
+      resample->SetOutputParametersFromImage( volume );
+      resample->SetDefaultPixelValue( 0 );
+      resample->Update();
+      typename TImage::Pointer upsampled = resample->GetOutput();
+      upsampled->DisconnectPipeline();
+      recon->SetInput(0, upsampled);
+      m_ResampleProbe.Stop();
+      }
+
+    m_LevelProbes[l].Start();
+    recon->Update();
+    m_LevelProbes[l].Stop();
+    pimg = recon->GetOutput();
+    pimg->DisconnectPipeline();
+    }
+  this->GraftOutput( pimg );
+}
+
+template<class TImage>
+void
+MultiResolutionConeBeamReconstructionFilter<TImage>
+::PrintTiming(std::ostream & os) const
+{
+  os << "MultiResolutionConeBeamReconstructionFilter timing:" << std::endl;
+  os << "  Binning: " << m_BinProbe.GetTotal()
+     << ' ' << m_BinProbe.GetUnit() << std::endl;
+  os << "  Upsampling: " << m_ResampleProbe.GetTotal()
+     << ' ' << m_ResampleProbe.GetUnit() << std::endl;
+  for(int l=m_NumberOfLevels-1; l>=0; l--)
+    {
+    os << "  Reconstruction at level " << l << ": " << m_LevelProbes[l].GetTotal()
+       << ' ' << m_LevelProbes[l].GetUnit() << std::endl;
+    }
+}
+
+} // end namespace rtk
+
+#endif // rtkMultiResolutionConeBeamReconstructionFilter_hxx
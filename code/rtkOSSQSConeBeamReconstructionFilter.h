@@ -0,0 +1,295 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkOSSQSConeBeamReconstructionFilter_h
+#define rtkOSSQSConeBeamReconstructionFilter_h
+
+#include "rtkBackProjectionImageFilter.h"
+#include "rtkForwardProjectionImageFilter.h"
+
+#include <itkMultiplyImageFilter.h>
+#include <itkDivideOrZeroOutImageFilter.h>
+#include <itkTimeProbe.h>
+
+#include "rtkRayBoxIntersectionImageFilter.h"
+#include "rtkConstantImageSource.h"
+#include "rtkIterativeConeBeamReconstructionFilter.h"
+#include "rtkSubSelectFromListImageFilter.h"
+#include "rtkTotalVariationDenoisingBPDQImageFilter.h"
+#include "rtkExpressionImageFilter.h"
+
+#ifdef RTK_USE_CUDA
+  #include <itkCudaImage.h>
+#endif
+
+namespace rtk
+{
+
+/** \class OSSQSConeBeamReconstructionFilter
+ * \brief Implements the ordered subsets separable quadratic surrogate
+ * (OS-SQS) reconstruction [Erdogan and Fessler, PMB, 1999]
+ *
+ * OSSQSConeBeamReconstructionFilter minimizes the least squares cost
+ * 0.5 * || R f - p ||^2, where R is the forward projection, f the volume and
+ * p the projections. The projections are divided in NumberOfSubsets subsets,
+ * subset s containing the projections of index s, s+NumberOfSubsets, etc. so
+ * that each subset covers the whole angular range. The projections of a
+ * subset are gathered in a stack with SubSelectFromListImageFilter and each
+ * subset updates the volume with
+ * f = f + (nProj / nProjInSubset) * R_s^T (p_s - R_s f) / d,
+ * where R_s is the forward projection of the subset and d = R^T R 1 are the
+ * SQS denominators. The denominators are the backprojection of the lengths of
+ * the intersections of the rays with the volume box, computed once with
+ * RayBoxIntersectionImageFilter and reused in all iterations until the
+ * geometry or the volume information change.
+ *
+ * With NesterovMomentum, the forward projection of each subset is computed
+ * at an extrapolation z = f_k + (t_{k-1}-1)/t_k * (f_k - f_{k-1}) of the last
+ * two updates as in [Kim, Ramani and Fessler, IEEE TMI, 2015]. This
+ * accelerates the convergence of the first iterations, typically a usable
+ * image is obtained in 3 to 5 iterations instead of 20 to 30 without
+ * momentum. Ordered subsets with momentum do not converge to the exact
+ * minimizer and the iterations may become unstable with many subsets.
+ *
+ * With PerformTVSpatialDenoising, TotalVariationDenoisingBPDQImageFilter is
+ * applied to the volume after each iteration, i.e., after each pass over all
+ * subsets, and the momentum starts again from the denoised volume.
+ *
+ * \dot
+ * digraph OSSQSConeBeamReconstructionFilter {
+ *
+ * Input0 [ label="Input 0 (Volume)"];
+ * Input0 [shape=Mdiamond];
+ * Input1 [label="Input 1 (Projections)"];
+ * Input1 [shape=Mdiamond];
+ * Output [label="Output (Reconstruction)"];
+ * Output [shape=Mdiamond];
+ *
+ * node [shape=box];
+ * SubSelect [ label="rtk::SubSelectFromListImageFilter" URL="\ref rtk::SubSelectFromListImageFilter"];
+ * AfterSubSelect [label="", fixedsize="false", width=0, height=0, shape=none];
+ * MultiplyByZero [ label="itk::MultiplyImageFilter (by zero)" URL="\ref itk::MultiplyImageFilter"];
+ * ForwardProject [ label="rtk::ForwardProjectionImageFilter" URL="\ref rtk::ForwardProjectionImageFilter"];
+ * Subtract [ label="rtk::ExpressionImageFilter ((p - x) * nProj / nProjInSubset)" URL="\ref rtk::ExpressionImageFilter"];
+ * ConstantVolume [ label="rtk::ConstantImageSource" URL="\ref rtk::ConstantImageSource"];
+ * BackProjection [ label="rtk::BackProjectionImageFilter" URL="\ref rtk::BackProjectionImageFilter"];
+ * ConstantVolumeDenominator [ label="rtk::ConstantImageSource" URL="\ref rtk::ConstantImageSource"];
+ * ConstantProjectionStack [ label="rtk::ConstantImageSource" URL="\ref rtk::ConstantImageSource"];
+ * RayBox [ label="rtk::RayBoxIntersectionImageFilter" URL="\ref rtk::RayBoxIntersectionImageFilter"];
+ * BackProjectionDenominator [ label="rtk::BackProjectionImageFilter" URL="\ref rtk::BackProjectionImageFilter"];
+ * InverseDenominator [ label="itk::DivideOrZeroOutImageFilter (1 / x)" URL="\ref itk::DivideOrZeroOutImageFilter"];
+ * Update [ label="rtk::ExpressionImageFilter (max(f + x / d, 0 or -inf))" URL="\ref rtk::ExpressionImageFilter"];
+ * Momentum [ label="rtk::ExpressionImageFilter (Nesterov momentum)" URL="\ref rtk::ExpressionImageFilter" style=dashed];
+ * TV [ label="rtk::TotalVariationDenoisingBPDQImageFilter" URL="\ref rtk::TotalVariationDenoisingBPDQImageFilter" style=dashed];
+ * OutofInput0 [label="", fixedsize="false", width=0, height=0, shape=none];
+ *
+ * Input0 -> OutofInput0 [arrowhead=none];
+ * OutofInput0 -> ForwardProject;
+ * OutofInput0 -> Update;
+ * Input1 -> SubSelect;
+ * SubSelect -> AfterSubSelect [arrowhead=none];
+ * AfterSubSelect -> MultiplyByZero;
+ * AfterSubSelect -> Subtract;
+ * MultiplyByZero -> ForwardProject;
+ * ForwardProject -> Subtract;
+ * Subtract -> BackProjection;
+ * ConstantVolume -> BackProjection;
+ * BackProjection -> Update;
+ * ConstantProjectionStack -> RayBox;
+ * RayBox -> BackProjectionDenominator;
+ * ConstantVolumeDenominator -> BackProjectionDenominator;
+ * BackProjectionDenominator -> InverseDenominator;
+ * InverseDenominator -> Update;
+ * Update -> Momentum;
+ * Momentum -> OutofInput0 [style=dashed];
+ * Update -> TV;
+ * TV -> Output;
+ * }
+ * \enddot
+ *
+ * \test rtkossqstest.cxx
+ *
+ * \ingroup ReconstructionAlgorithm
+ */
+template<class TInputImage, class TOutputImage=TInputImage>
+class ITK_EXPORT OSSQSConeBeamReconstructionFilter :
+  public rtk::IterativeConeBeamReconstructionFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef OSSQSConeBeamReconstructionFilter                                Self;
+  typedef IterativeConeBeamReconstructionFilter<TInputImage, TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                                          Pointer;
+  typedef itk::SmartPointer<const Self>                                    ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TInputImage  InputImageType;
+  typedef TOutputImage OutputImageType;
+  typedef itk::CovariantVector< typename TOutputImage::ValueType, TOutputImage::ImageDimension> CovariantVectorForSpatialGradient;
+
+#ifdef RTK_USE_CUDA
+  typedef itk::CudaImage<CovariantVectorForSpatialGradient, TOutputImage::ImageDimension>     GradientImageType;
+#else
+  typedef itk::Image<CovariantVectorForSpatialGradient, TOutputImage::ImageDimension>         GradientImageType;
+#endif
+
+  /** Typedefs of each subfilter of this composite filter */
+  typedef itk::MultiplyImageFilter< OutputImageType, OutputImageType, OutputImageType >      MultiplyFilterType;
+  typedef rtk::ForwardProjectionImageFilter< OutputImageType, OutputImageType >              ForwardProjectionFilterType;
+  typedef rtk::BackProjectionImageFilter< OutputImageType, OutputImageType >                 BackProjectionFilterType;
+  typedef rtk::RayBoxIntersectionImageFilter<OutputImageType, OutputImageType>               RayBoxIntersectionFilterType;
+  typedef itk::DivideOrZeroOutImageFilter<OutputImageType, OutputImageType, OutputImageType> DivideFilterType;
+  typedef rtk::ConstantImageSource<OutputImageType>                                          ConstantImageSourceType;
+  typedef rtk::SubSelectFromListImageFilter<InputImageType>                                  SubSelectFilterType;
+  typedef rtk::TotalVariationDenoisingBPDQImageFilter<OutputImageType, GradientImageType>    TVDenoisingFilterType;
+
+  /** Expressions of the subset correction, (p - Rf) * nProj / nProjInSubset,
+   * of the volume update, max(R^T c / d + f, threshold), and of the Nesterov
+   * extrapolation, f + (t-1)/t' * (f - f_previous) */
+  typedef Expression::Product< Expression::Difference< Expression::Input<0>, Expression::Input<1> >,
+                               Expression::Parameter<0> >                                    CorrectionExpressionType;
+  typedef Expression::Maximum< Expression::Sum< Expression::Product< Expression::Input<0>,
+                                                                     Expression::Input<1> >,
+                                                Expression::Input<2> >,
+                               Expression::Parameter<0> >                                    UpdateExpressionType;
+  typedef Expression::Sum< Expression::Input<0>,
+                           Expression::Product< Expression::Parameter<0>,
+                                                Expression::Difference< Expression::Input<0>,
+                                                                        Expression::Input<1> > > > MomentumExpressionType;
+  typedef rtk::ExpressionImageFilter<OutputImageType, CorrectionExpressionType>              CorrectionFilterType;
+  typedef rtk::ExpressionImageFilter<OutputImageType, UpdateExpressionType>                  UpdateFilterType;
+  typedef rtk::ExpressionImageFilter<OutputImageType, MomentumExpressionType>                MomentumFilterType;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(OSSQSConeBeamReconstructionFilter, IterativeConeBeamReconstructionFilter);
+
+  /** Get / Set the object pointer to projection geometry */
+  itkGetMacro(Geometry, ThreeDCircularProjectionGeometry::Pointer);
+  itkSetMacro(Geometry, ThreeDCircularProjectionGeometry::Pointer);
+
+  void PrintTiming(std::ostream& os) const;
+
+  /** Get / Set the number of iterations, i.e., of passes over all subsets.
+   * Default is 3. */
+  itkGetMacro(NumberOfIterations, unsigned int);
+  itkSetMacro(NumberOfIterations, unsigned int);
+
+  /** Get / Set the number of subsets. It is reduced to the number of
+   * projections if there are less projections. Default is 10. */
+  itkGetMacro(NumberOfSubsets, unsigned int);
+  itkSetMacro(NumberOfSubsets, unsigned int);
+
+  /** Get / Set the positivity enforcement behaviour */
+  itkGetMacro(EnforcePositivity, bool);
+  itkSetMacro(EnforcePositivity, bool);
+
+  /** Get / Set whether Nesterov's momentum is used. Default is false. */
+  itkGetMacro(NesterovMomentum, bool);
+  itkSetMacro(NesterovMomentum, bool);
+
+  /** Get / Set whether the volume is denoised with total variation after
+   * each iteration. Default is false. */
+  itkGetMacro(PerformTVSpatialDenoising, bool);
+  itkSetMacro(PerformTVSpatialDenoising, bool);
+
+  /** Get / Set the regularization parameter of the TV denoising. Default is 0.1. */
+  itkGetMacro(GammaTV, double);
+  itkSetMacro(GammaTV, double);
+
+  /** Get / Set the number of iterations of the TV denoising. Default is 10. */
+  itkGetMacro(TV_iterations, int);
+  itkSetMacro(TV_iterations, int);
+
+  /** Select the ForwardProjection filter */
+  void SetForwardProjectionFilter (int _arg) ITK_OVERRIDE;
+
+  /** Select the backprojection filter */
+  void SetBackProjectionFilter (int _arg) ITK_OVERRIDE;
+
+protected:
+  OSSQSConeBeamReconstructionFilter();
+  ~OSSQSConeBeamReconstructionFilter() {}
+
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  void GenerateOutputInformation() ITK_OVERRIDE;
+
+  void GenerateData() ITK_OVERRIDE;
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+  void VerifyInputInformation() ITK_OVERRIDE {}
+
+  /** Pointers to each subfilter of this composite filter */
+  typename SubSelectFilterType::Pointer          m_SubSelectFilter;
+  typename MultiplyFilterType::Pointer           m_ZeroMultiplyFilter;
+  typename ForwardProjectionFilterType::Pointer  m_ForwardProjectionFilter;
+  typename CorrectionFilterType::Pointer         m_CorrectionFilter;
+  typename BackProjectionFilterType::Pointer     m_BackProjectionFilter;
+  typename ConstantImageSourceType::Pointer      m_ConstantVolumeSource;
+  typename ConstantImageSourceType::Pointer      m_ConstantProjectionStackSource;
+  typename ConstantImageSourceType::Pointer      m_ConstantVolumeSourceForDenominator;
+  typename RayBoxIntersectionFilterType::Pointer m_RayBoxFilter;
+  typename BackProjectionFilterType::Pointer     m_BackProjectionFilterForDenominator;
+  typename DivideFilterType::Pointer             m_InverseDenominatorFilter;
+  typename UpdateFilterType::Pointer             m_UpdateFilter;
+  typename MomentumFilterType::Pointer           m_MomentumFilter;
+  typename TVDenoisingFilterType::Pointer        m_TVDenoising;
+
+  bool   m_EnforcePositivity;
+  bool   m_NesterovMomentum;
+  bool   m_PerformTVSpatialDenoising;
+  double m_GammaTV;
+  int    m_TV_iterations;
+
+private:
+  //purposely not implemented
+  OSSQSConeBeamReconstructionFilter(const Self&);
+  void operator=(const Self&);
+
+  /** Geometry object */
+  ThreeDCircularProjectionGeometry::Pointer m_Geometry;
+
+  /** Number of iterations */
+  unsigned int m_NumberOfIterations;
+
+  /** Number of subsets */
+  unsigned int m_NumberOfSubsets;
+
+  /** Time probes */
+  itk::TimeProbe m_ExtractProbe;
+  itk::TimeProbe m_ForwardProjectionProbe;
+  itk::TimeProbe m_CorrectionProbe;
+  itk::TimeProbe m_DenominatorProbe;
+  itk::TimeProbe m_BackProjectionProbe;
+  itk::TimeProbe m_UpdateProbe;
+  itk::TimeProbe m_MomentumProbe;
+  itk::TimeProbe m_TVProbe;
+
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkOSSQSConeBeamReconstructionFilter.hxx"
+#endif
+
+#endif
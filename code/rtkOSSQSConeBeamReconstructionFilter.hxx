@@ -0,0 +1,360 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkOSSQSConeBeamReconstructionFilter_hxx
+#define rtkOSSQSConeBeamReconstructionFilter_hxx
+
+#include "rtkOSSQSConeBeamReconstructionFilter.h"
+
+#include <algorithm>
+#include <itkTimeProbe.h>
+
+namespace rtk
+{
+template<class TInputImage, class TOutputImage>
+OSSQSConeBeamReconstructionFilter<TInputImage, TOutputImage>
+::OSSQSConeBeamReconstructionFilter()
+{
+  this->SetNumberOfRequiredInputs(2);
+
+  // Set default parameters
+  m_EnforcePositivity = false;
+  m_NesterovMomentum = false;
+  m_PerformTVSpatialDenoising = false;
+  m_GammaTV = 0.1;
+  m_TV_iterations = 10;
+  m_NumberOfIterations = 3;
+  m_NumberOfSubsets = 10;
+
+  // Create each filter of the composite filter
+  m_SubSelectFilter = SubSelectFilterType::New();
+  m_ZeroMultiplyFilter = MultiplyFilterType::New();
+  m_CorrectionFilter = CorrectionFilterType::New();
+  m_ConstantVolumeSource = ConstantImageSourceType::New();
+  m_UpdateFilter = UpdateFilterType::New();
+
+  // Create the filters computing the SQS denominators
+  m_ConstantProjectionStackSource = ConstantImageSourceType::New();
+  m_ConstantVolumeSourceForDenominator = ConstantImageSourceType::New();
+  m_RayBoxFilter = RayBoxIntersectionFilterType::New();
+  m_InverseDenominatorFilter = DivideFilterType::New();
+
+  // Create the filters of the momentum and of the regularization
+  m_MomentumFilter = MomentumFilterType::New();
+  m_TVDenoising = TVDenoisingFilterType::New();
+
+  //Permanent internal connections
+  m_ZeroMultiplyFilter->SetInput1( itk::NumericTraits<typename InputImageType::PixelType>::ZeroValue() );
+  m_ZeroMultiplyFilter->SetInput2( m_SubSelectFilter->GetOutput() );
+
+  m_CorrectionFilter->SetInput(0, m_SubSelectFilter->GetOutput() );
+  m_CorrectionFilter->SetParameter(0, 1.);
+
+  m_RayBoxFilter->SetInput(m_ConstantProjectionStackSource->GetOutput());
+  m_InverseDenominatorFilter->SetConstant1(1.);
+
+  // The volume update overwrites the backprojection of the subset, which is
+  // not reused
+  m_UpdateFilter->SetInPlace(true);
+}
+
+template<class TInputImage, class TOutputImage>
+void
+OSSQSConeBeamReconstructionFilter<TInputImage, TOutputImage>
+::SetForwardProjectionFilter (int _arg)
+{
+  if( _arg != this->GetForwardProjectionFilter() )
+    {
+    Superclass::SetForwardProjectionFilter( _arg );
+    m_ForwardProjectionFilter = this->InstantiateForwardProjectionFilter( _arg );
+    }
+}
+
+template<class TInputImage, class TOutputImage>
+void
+OSSQSConeBeamReconstructionFilter<TInputImage, TOutputImage>
+::SetBackProjectionFilter (int _arg)
+{
+  if( _arg != this->GetBackProjectionFilter() )
+    {
+    Superclass::SetBackProjectionFilter( _arg );
+    m_BackProjectionFilter = this->InstantiateBackProjectionFilter( _arg );
+    m_BackProjectionFilterForDenominator = this->InstantiateBackProjectionFilter( _arg );
+    }
+}
+
+template<class TInputImage, class TOutputImage>
+void
+OSSQSConeBeamReconstructionFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  // Input 0 is the volume we update
+  typename Superclass::InputImagePointer inputPtr0 =
+    const_cast< TInputImage * >( this->GetInput(0) );
+  if ( !inputPtr0 )
+    return;
+  inputPtr0->SetRequestedRegion( inputPtr0->GetLargestPossibleRegion() );
+
+  // Input 1 is the stack of projections
+  typename Superclass::InputImagePointer inputPtr1 =
+    const_cast< TInputImage * >( this->GetInput(1) );
+  if ( !inputPtr1 )
+    return;
+  inputPtr1->SetRequestedRegion( inputPtr1->GetLargestPossibleRegion() );
+}
+
+template<class TInputImage, class TOutputImage>
+void
+OSSQSConeBeamReconstructionFilter<TInputImage, TOutputImage>
+::GenerateOutputInformation()
+{
+  // Check and set geometry
+  if(this->GetGeometry().GetPointer() == ITK_NULLPTR)
+    {
+    itkGenericExceptionMacro(<< "The geometry of the reconstruction has not been set");
+    }
+
+  // The projections of a subset are gathered in a stack with the
+  // corresponding geometry. Only the first subset is set at that point, the
+  // others are selected in the GenerateData function.
+  const unsigned int nProj = this->GetInput(1)->GetLargestPossibleRegion().GetSize(this->InputImageDimension-1);
+  const unsigned int nSubsets = std::max(1u, std::min(m_NumberOfSubsets, nProj));
+  std::vector<bool> selection(nProj, false);
+  for(unsigned int i=0; i<nProj; i+=nSubsets)
+    selection[i] = true;
+  m_SubSelectFilter->SetInputProjectionStack( this->GetInput(1) );
+  m_SubSelectFilter->SetInputGeometry( this->m_Geometry );
+  m_SubSelectFilter->SetSelectedProjections( selection );
+
+  // Links with the forward and back projection filters should be set here
+  // and not in the constructor, as these filters are set at runtime
+  m_ConstantVolumeSource->SetInformationFromImage(const_cast<TInputImage *>(this->GetInput(0)));
+  m_ConstantVolumeSource->SetConstant(0);
+  m_ConstantVolumeSource->UpdateOutputInformation();
+
+  m_ForwardProjectionFilter->SetInput( 0, m_ZeroMultiplyFilter->GetOutput() );
+  m_ForwardProjectionFilter->SetInput( 1, this->GetInput(0) );
+  m_ForwardProjectionFilter->SetGeometry( m_SubSelectFilter->GetOutputGeometry() );
+  m_CorrectionFilter->SetInput(1, m_ForwardProjectionFilter->GetOutput() );
+
+  m_BackProjectionFilter->SetInput(0, m_ConstantVolumeSource->GetOutput() );
+  m_BackProjectionFilter->SetInput(1, m_CorrectionFilter->GetOutput() );
+  m_BackProjectionFilter->SetGeometry( m_SubSelectFilter->GetOutputGeometry().GetPointer() );
+  m_BackProjectionFilter->SetTranspose(false);
+
+  // SQS denominators, backprojection of the ray lengths in the volume box
+  m_ConstantProjectionStackSource->SetInformationFromImage(const_cast<TInputImage *>(this->GetInput(1)));
+  m_ConstantProjectionStackSource->SetConstant(0);
+  m_RayBoxFilter->SetGeometry(this->m_Geometry.GetPointer());
+  typename RayBoxIntersectionFilterType::VectorType boxMin, boxMax;
+  for(unsigned int i=0; i<3; i++)
+    {
+    boxMin[i] = this->GetInput(0)->GetOrigin()[i] - 0.5 * this->GetInput(0)->GetSpacing()[i];
+    boxMax[i] = boxMin[i] + this->GetInput(0)->GetLargestPossibleRegion().GetSize()[i] * this->GetInput(0)->GetSpacing()[i];
+    }
+  m_RayBoxFilter->SetBoxMin(boxMin);
+  m_RayBoxFilter->SetBoxMax(boxMax);
+
+  // The denominators are computed once and reused in all iterations. They
+  // are recomputed only if the geometry, the volume information or the
+  // projection information have changed. The backprojection of the
+  // denominators has its own constant volume: the main backprojection runs
+  // in place and releases the output of m_ConstantVolumeSource, which would
+  // otherwise trigger a new backprojection of the denominators at each
+  // update.
+  if(this->m_Geometry->GetMTime() > m_RayBoxFilter->GetOutput()->GetUpdateMTime())
+    m_RayBoxFilter->Modified();
+  m_ConstantVolumeSourceForDenominator->SetInformationFromImage(const_cast<TInputImage *>(this->GetInput(0)));
+  m_ConstantVolumeSourceForDenominator->SetConstant(0);
+  m_BackProjectionFilterForDenominator->SetInput(0, m_ConstantVolumeSourceForDenominator->GetOutput() );
+  m_BackProjectionFilterForDenominator->SetInput(1, m_RayBoxFilter->GetOutput() );
+  m_BackProjectionFilterForDenominator->SetGeometry(this->m_Geometry.GetPointer());
+  m_InverseDenominatorFilter->SetInput2(m_BackProjectionFilterForDenominator->GetOutput());
+
+  // Volume update
+  m_UpdateFilter->SetInput(0, m_BackProjectionFilter->GetOutput());
+  m_UpdateFilter->SetInput(1, m_InverseDenominatorFilter->GetOutput());
+  m_UpdateFilter->SetInput(2, this->GetInput(0));
+  if (m_EnforcePositivity)
+    m_UpdateFilter->SetParameter(0, 0.);
+  else
+    m_UpdateFilter->SetParameter(0, -itk::NumericTraits<double>::max());
+
+  m_TVDenoising->SetNumberOfIterations(m_TV_iterations);
+  m_TVDenoising->SetGamma(m_GammaTV);
+
+  // Update output information
+  m_UpdateFilter->UpdateOutputInformation();
+  this->GetOutput()->SetOrigin( m_UpdateFilter->GetOutput()->GetOrigin() );
+  this->GetOutput()->SetSpacing( m_UpdateFilter->GetOutput()->GetSpacing() );
+  this->GetOutput()->SetDirection( m_UpdateFilter->GetOutput()->GetDirection() );
+  this->GetOutput()->SetLargestPossibleRegion( m_UpdateFilter->GetOutput()->GetLargestPossibleRegion() );
+
+  // Set memory management flags
+  m_ZeroMultiplyFilter->ReleaseDataFlagOn();
+  m_ForwardProjectionFilter->ReleaseDataFlagOn();
+  m_CorrectionFilter->ReleaseDataFlagOn();
+  m_BackProjectionFilter->ReleaseDataFlagOn();
+  m_BackProjectionFilterForDenominator->ReleaseDataFlagOn();
+}
+
+template<class TInputImage, class TOutputImage>
+void
+OSSQSConeBeamReconstructionFilter<TInputImage, TOutputImage>
+::GenerateData()
+{
+  const unsigned int Dimension = this->InputImageDimension;
+
+  // Projections of each subset, interleaved to cover the whole angular range
+  const unsigned int nProj = this->GetInput(1)->GetLargestPossibleRegion().GetSize(Dimension-1);
+  const unsigned int nSubsets = std::max(1u, std::min(m_NumberOfSubsets, nProj));
+  std::vector< std::vector<bool> > selections(nSubsets, std::vector<bool>(nProj, false));
+  std::vector< unsigned int > nProjInSubset(nSubsets, 0);
+  for(unsigned int i = 0; i < nProj; i++)
+    {
+    selections[i%nSubsets][i] = true;
+    nProjInSubset[i%nSubsets]++;
+    }
+
+  // Fill and shuffle randomly the subset order.
+  std::vector< unsigned int > subsetOrder(nSubsets);
+  for(unsigned int i = 0; i < nSubsets; i++)
+    subsetOrder[i] = i;
+  std::random_shuffle( subsetOrder.begin(), subsetOrder.end() );
+
+  // Compute the SQS denominators, if required
+  m_DenominatorProbe.Start();
+  m_InverseDenominatorFilter->Update();
+  m_DenominatorProbe.Stop();
+
+  // Declare the images used in the main loop: the current volume, the
+  // previous one and the volume where the next subset is forward projected
+  typename TOutputImage::Pointer pimg;
+  typename TOutputImage::ConstPointer previous = this->GetInput(0);
+  double t = 1.;
+
+  for(unsigned int iter = 0; iter < m_NumberOfIterations; iter++)
+    {
+    for(unsigned int s = 0; s < nSubsets; s++)
+      {
+      // Change projection subset
+      m_SubSelectFilter->SetSelectedProjections( selections[ subsetOrder[s] ] );
+      m_CorrectionFilter->SetParameter(0, nProj / (double) nProjInSubset[ subsetOrder[s] ] );
+
+      // This is required to reset the full pipeline
+      m_BackProjectionFilter->GetOutput()->UpdateOutputInformation();
+      m_BackProjectionFilter->GetOutput()->PropagateRequestedRegion();
+
+      m_ExtractProbe.Start();
+      m_SubSelectFilter->Update();
+      m_ExtractProbe.Stop();
+
+      m_ForwardProjectionProbe.Start();
+      m_ForwardProjectionFilter->Update();
+      m_ForwardProjectionProbe.Stop();
+
+      m_CorrectionProbe.Start();
+      m_CorrectionFilter->Update();
+      m_CorrectionProbe.Stop();
+
+      m_BackProjectionProbe.Start();
+      m_BackProjectionFilter->Update();
+      m_BackProjectionProbe.Stop();
+
+      m_UpdateProbe.Start();
+      m_UpdateFilter->Update();
+      pimg = m_UpdateFilter->GetOutput();
+      pimg->DisconnectPipeline();
+      m_UpdateProbe.Stop();
+
+      // The next subset is forward projected and added to the extrapolation
+      // of the last two volumes
+      typename TOutputImage::Pointer extrapolated = pimg;
+      if (m_NesterovMomentum)
+        {
+        m_MomentumProbe.Start();
+        const double tNext = 0.5 * (1. + vcl_sqrt(1. + 4. * t * t));
+        m_MomentumFilter->SetInput(0, pimg);
+        m_MomentumFilter->SetInput(1, previous);
+        m_MomentumFilter->SetParameter(0, (t - 1.) / tNext);
+        m_MomentumFilter->Update();
+        extrapolated = m_MomentumFilter->GetOutput();
+        extrapolated->DisconnectPipeline();
+        t = tNext;
+        m_MomentumProbe.Stop();
+        }
+      previous = pimg.GetPointer();
+
+      m_ForwardProjectionFilter->SetInput(1, extrapolated );
+      m_UpdateFilter->SetInput(2, extrapolated);
+      }
+
+    // Regularization of the volume, the momentum starts again from the
+    // denoised volume: the extrapolation of the next subset is the denoised
+    // volume itself and t is reset
+    if (m_PerformTVSpatialDenoising)
+      {
+      m_TVProbe.Start();
+      m_TVDenoising->SetInput(pimg);
+      m_TVDenoising->Update();
+      pimg = m_TVDenoising->GetOutput();
+      pimg->DisconnectPipeline();
+      m_TVProbe.Stop();
+
+      previous = pimg.GetPointer();
+      t = 1.;
+      m_ForwardProjectionFilter->SetInput(1, pimg );
+      m_UpdateFilter->SetInput(2, pimg);
+      }
+    }
+  this->GraftOutput( pimg );
+}
+
+template<class TInputImage, class TOutputImage>
+void
+OSSQSConeBeamReconstructionFilter<TInputImage, TOutputImage>
+::PrintTiming(std::ostream & os) const
+{
+  os << "OSSQSConeBeamReconstructionFilter timing:" << std::endl;
+  os << "  Selection of projection subsets: " << m_ExtractProbe.GetTotal()
+     << ' ' << m_ExtractProbe.GetUnit() << std::endl;
+  os << "  SQS denominators: " << m_DenominatorProbe.GetTotal()
+     << ' ' << m_DenominatorProbe.GetUnit() << std::endl;
+  os << "  Forward projection: " << m_ForwardProjectionProbe.GetTotal()
+     << ' ' << m_ForwardProjectionProbe.GetUnit() << std::endl;
+  os << "  Correction: " << m_CorrectionProbe.GetTotal()
+     << ' ' << m_CorrectionProbe.GetUnit() << std::endl;
+  os << "  Back projection: " << m_BackProjectionProbe.GetTotal()
+     << ' ' << m_BackProjectionProbe.GetUnit() << std::endl;
+  os << "  Volume update: " << m_UpdateProbe.GetTotal()
+     << ' ' << m_UpdateProbe.GetUnit() << std::endl;
+  if (m_NesterovMomentum)
+    {
+    os << "  Nesterov momentum: " << m_MomentumProbe.GetTotal()
+       << ' ' << m_MomentumProbe.GetUnit() << std::endl;
+    }
+  if (m_PerformTVSpatialDenoising)
+    {
+    os << "  TV denoising: " << m_TVProbe.GetTotal()
+       << ' ' << m_TVProbe.GetUnit() << std::endl;
+    }
+}
+
+} // end namespace rtk
+
+#endif // rtkOSSQSConeBeamReconstructionFilter_hxx
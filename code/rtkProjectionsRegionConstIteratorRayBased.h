@@ -37,7 +37,15 @@ namespace rtk
  * voxel coordinates. The iterator only works with the
  * ThreeDCircularProjectionGeometry is purely virtual because this geometry
  * can handle parallel geometry with flat panels and cone-beam geometries with
- * flat and curved detectors. */
+ * flat and curved detectors.
+ *
+ * The position of the pixel on the panel, before accounting for the curvature
+ * of curved detectors, is an affine function of the pixel index. The
+ * subclasses compute it once per projection and the iterator then advances
+ * it with precomputed column and row increments, which costs three additions
+ * per pixel instead of a matrix-vector product. For flat panels, it is
+ * directly the pixel position and the increment does not involve any virtual
+ * call. */
 template< typename TImage >
 class ProjectionsRegionConstIteratorRayBased:
     public itk::ImageConstIteratorWithIndex< TImage >
@@ -133,14 +141,43 @@ protected:
   /** Init the parameters common to a new 2D projection in the 3D stack. */
   virtual void NewProjection() = 0;
 
-  /** Init a new pixel position in a 2D projection, assuming that the
-   * NewProjection method has already been called. */
+  /** Init a new pixel position in a 2D projection from m_PanelPosition,
+   * assuming that the NewProjection method has already been called. Not
+   * called for flat panels where the panel position is the pixel position. */
   virtual void NewPixel() = 0;
 
+  /** Set the affine transform from the projection index to the position on
+   * the panel, i.e., the first 3 rows of a matrix with ImageDimension+1
+   * columns, and the position of the current pixel which must be at the
+   * beginning of a row. Must be called by NewProjection. */
+  template <class TMatrix>
+  void SetPanelIndexTransform(const TMatrix &matrix)
+    {
+    for(unsigned int i=0; i<3; i++)
+      {
+      m_ColumnIncrement[i] = matrix[i][0];
+      m_RowIncrement[i] = matrix[i][1];
+      m_RowPosition[i] = matrix[i][TImage::ImageDimension];
+      for(unsigned int j=0; j<TImage::ImageDimension; j++)
+        m_RowPosition[i] += matrix[i][j] * this->m_PositionIndex[j];
+      }
+    m_PanelPosition = m_RowPosition;
+    }
+
   ThreeDCircularProjectionGeometry * m_Geometry;
   MatrixType                         m_PostMultiplyMatrix;
   PointType                          m_SourcePosition;
   PointType                          m_PixelPosition;
+
+  /** Position of the current pixel and of the pixel at the beginning of its
+   * row in the panel coordinates, and increments of one column and one row. */
+  PointType                          m_PanelPosition;
+  PointType                          m_RowPosition;
+  PointType                          m_ColumnIncrement;
+  PointType                          m_RowIncrement;
+
+  /** The panel position is the pixel position and NewPixel is not called */
+  bool                               m_FlatPanel;
 };
 } // end namespace itk
 
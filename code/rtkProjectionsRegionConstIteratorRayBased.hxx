@@ -34,7 +34,8 @@ ProjectionsRegionConstIteratorRayBased< TImage >
                                          const MatrixType &postMat):
   itk::ImageConstIteratorWithIndex< TImage >(ptr, region),
   m_Geometry(geometry),
-  m_PostMultiplyMatrix(postMat)
+  m_PostMultiplyMatrix(postMat),
+  m_FlatPanel(false)
 {
 }
 
@@ -70,11 +71,26 @@ ProjectionsRegionConstIteratorRayBased< TImage >
     return *this;
     }
 
-  if(in == 2)
+  // Advance the position on the panel with the precomputed increments. The
+  // beginning of the row is recomputed only when changing projection.
+  if(in == 0)
+    {
+    m_PanelPosition += m_ColumnIncrement;
+    }
+  else if(in == 1)
+    {
+    m_RowPosition += m_RowIncrement;
+    m_PanelPosition = m_RowPosition;
+    }
+  else
     {
     NewProjection();
     }
-  NewPixel();
+
+  if(m_FlatPanel)
+    m_PixelPosition = m_PanelPosition;
+  else
+    NewPixel();
 
   return *this;
 }
@@ -58,6 +58,7 @@ ProjectionsRegionConstIteratorRayBasedWithCylindricalPanel< TImage >
   m_ProjectionIndexTransformMatrix =
       this->m_Geometry->GetProjectionCoordinatesToDetectorSystemMatrix(iProj).GetVnlMatrix() *
       GetIndexToPhysicalPointMatrix( this->m_Image.GetPointer() ).GetVnlMatrix();
+  this->SetPanelIndexTransform(m_ProjectionIndexTransformMatrix);
 
   // Get transformation from coordinate in the (u,v,u^v) coordinate system to
   // the tomography (fixed) coordinate system
@@ -72,15 +73,7 @@ ProjectionsRegionConstIteratorRayBasedWithCylindricalPanel< TImage >
 ::NewPixel()
 {
   // Position on the projection before applying rotations and m_PostMultiplyMatrix
-  PointType posProj;
-
-  // Compute point coordinate in volume depending on projection index
-  for(unsigned int i=0; i<this->GetImageDimension(); i++)
-    {
-    posProj[i] = m_ProjectionIndexTransformMatrix[i][this->GetImageDimension()];
-    for(unsigned int j=0; j<this->GetImageDimension(); j++)
-      posProj[i] += m_ProjectionIndexTransformMatrix[i][j] * this->m_PositionIndex[j];
-    }
+  PointType posProj = this->m_PanelPosition;
 
   // Convert cylindrical angle to coordinates in the (u,v,u^v) coordinate system
   double a = m_InverseRadius * posProj[0];
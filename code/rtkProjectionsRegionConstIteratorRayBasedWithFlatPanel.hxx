@@ -32,6 +32,7 @@ ProjectionsRegionConstIteratorRayBasedWithFlatPanel< TImage >
                                          const MatrixType &postMat):
   ProjectionsRegionConstIteratorRayBased< TImage >(ptr, region, geometry, postMat)
 {
+  this->m_FlatPanel = true;
   NewProjection();
   NewPixel();
 }
@@ -54,6 +55,7 @@ ProjectionsRegionConstIteratorRayBasedWithFlatPanel< TImage >
       this->m_PostMultiplyMatrix.GetVnlMatrix() *
       this->m_Geometry->GetProjectionCoordinatesToFixedSystemMatrix(this->m_PositionIndex[2]).GetVnlMatrix() *
       GetIndexToPhysicalPointMatrix( this->m_Image.GetPointer() ).GetVnlMatrix();
+  this->SetPanelIndexTransform(m_ProjectionIndexTransformMatrix);
 }
 
 template< typename TImage >
@@ -61,13 +63,8 @@ void
 ProjectionsRegionConstIteratorRayBasedWithFlatPanel< TImage >
 ::NewPixel()
 {
-  // Compute point coordinate in volume depending on projection index
-  for(unsigned int i=0; i<this->GetImageDimension(); i++)
-    {
-    this->m_PixelPosition[i] = m_ProjectionIndexTransformMatrix[i][this->GetImageDimension()];
-    for(unsigned int j=0; j<this->GetImageDimension(); j++)
-      this->m_PixelPosition[i] += m_ProjectionIndexTransformMatrix[i][j] * this->m_PositionIndex[j];
-    }
+  // The position on the panel is already in volume coordinates
+  this->m_PixelPosition = this->m_PanelPosition;
 }
 
 } // end namespace itk
@@ -42,8 +42,11 @@ void
 RayBoxIntersectionImageFilter<TInputImage,TOutputImage>
 ::SetBoxMin(VectorType _boxMin)
 {
-  m_RBIFunctor->SetBoxMin(_boxMin);
-  this->Modified();
+  if(m_RBIFunctor->GetBoxMin() != _boxMin)
+    {
+    m_RBIFunctor->SetBoxMin(_boxMin);
+    this->Modified();
+    }
 }
 
 template <class TInputImage, class TOutputImage>
@@ -51,8 +54,11 @@ void
 RayBoxIntersectionImageFilter<TInputImage,TOutputImage>
 ::SetBoxMax(VectorType _boxMax)
 {
-  m_RBIFunctor->SetBoxMax(_boxMax);
-  this->Modified();
+  if(m_RBIFunctor->GetBoxMax() != _boxMax)
+    {
+    m_RBIFunctor->SetBoxMax(_boxMax);
+    this->Modified();
+    }
 }
 
 template <class TInputImage, class TOutputImage>
@@ -0,0 +1,119 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkRayCastBackProjectionImageFilter_h
+#define rtkRayCastBackProjectionImageFilter_h
+
+#include "rtkConfiguration.h"
+#include "rtkBackProjectionImageFilter.h"
+#include "rtkThreeDCircularProjectionGeometry.h"
+
+#include <vector>
+
+namespace rtk
+{
+
+/** \class RayCastBackProjectionImageFilter
+ * \brief Ray-driven back projection with trilinear splatting, CPU version of
+ * CudaRayCastBackProjectionImageFilter.
+ *
+ * Each ray is sampled every StepSize mm and the projection value is splat
+ * trilinearly at each sample, see RayCastSampling. Without normalization,
+ * the back projector is the adjoint operator of
+ * RayCastForwardProjectionImageFilter. With normalization, the default as in
+ * the CUDA version, the back projection is divided by the sum of the splat
+ * weights in each voxel.
+ *
+ * The volume is split in slabs, one per thread. Each thread traces all the
+ * rays but only splats in the voxels of its slab, in the order of the
+ * projection pixels. The result is therefore the same as with a single thread
+ * and there is no concurrent write.
+ *
+ * \test rtkadjointoperatorstest.cxx
+ *
+ * \ingroup Projector
+ */
+
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT RayCastBackProjectionImageFilter :
+  public BackProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef RayCastBackProjectionImageFilter                       Self;
+  typedef BackProjectionImageFilter<TInputImage,TOutputImage>    Superclass;
+  typedef itk::SmartPointer<Self>                                Pointer;
+  typedef itk::SmartPointer<const Self>                          ConstPointer;
+  typedef typename TInputImage::PixelType                        InputPixelType;
+  typedef typename TOutputImage::PixelType                       OutputPixelType;
+  typedef typename TOutputImage::RegionType                      OutputImageRegionType;
+  typedef rtk::ThreeDCircularProjectionGeometry                  GeometryType;
+  typedef typename GeometryType::Pointer                         GeometryPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(RayCastBackProjectionImageFilter, BackProjectionImageFilter);
+
+  /** Set step size along ray (in mm). Default is 1 mm. */
+  itkGetConstMacro(StepSize, double);
+  itkSetMacro(StepSize, double);
+
+  /** Set whether the back projection should be divided by the sum of splat
+   * weights. Default is true. */
+  itkGetMacro(Normalize, bool);
+  itkSetMacro(Normalize, bool);
+
+protected:
+  RayCastBackProjectionImageFilter() : m_StepSize(1.), m_Normalize(true) {}
+  ~RayCastBackProjectionImageFilter() {}
+
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
+
+  void AfterThreadedGenerateData() ITK_OVERRIDE;
+
+  /** The requested region is split in slabs, see the class description. */
+  bool SupportsBricks() const ITK_OVERRIDE { return false; }
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+  void VerifyInputInformation() ITK_OVERRIDE {}
+
+private:
+  RayCastBackProjectionImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                   //purposely not implemented
+
+  double m_StepSize;
+  bool   m_Normalize;
+
+  /** Splat values and weights over the output buffer, used for the
+   * normalization only */
+  std::vector<double> m_SplatValues;
+  std::vector<double> m_SplatWeights;
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkRayCastBackProjectionImageFilter.hxx"
+#endif
+
+#endif
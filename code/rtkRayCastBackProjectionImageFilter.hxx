@@ -0,0 +1,181 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkRayCastBackProjectionImageFilter_hxx
+#define rtkRayCastBackProjectionImageFilter_hxx
+
+#include "rtkHomogeneousMatrix.h"
+#include "rtkProjectionsRegionConstIteratorRayBased.h"
+#include "rtkRayCastSampling.h"
+
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+void
+RayCastBackProjectionImageFilter<TInputImage,TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  // The checks of the voxel-based back projection do not apply, rays are
+  // computed for any detector by the ray-based projection iterator
+  if( !dynamic_cast<GeometryType*>(this->GetGeometry().GetPointer()) )
+    {
+    itkGenericExceptionMacro(<< "Error, ThreeDCircularProjectionGeometry expected");
+    }
+
+  // The splats are accumulated separately from the input volume for the
+  // normalization
+  if(m_Normalize)
+    {
+    const unsigned int n = this->GetOutput()->GetBufferedRegion().GetNumberOfPixels();
+    m_SplatValues.assign(n, 0.);
+    m_SplatWeights.assign(n, 0.);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+RayCastBackProjectionImageFilter<TInputImage,TOutputImage>
+::AfterThreadedGenerateData()
+{
+  std::vector<double>().swap(m_SplatValues);
+  std::vector<double>().swap(m_SplatWeights);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+RayCastBackProjectionImageFilter<TInputImage,TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId))
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const typename TInputImage::RegionType buffReg = this->GetInput(1)->GetBufferedRegion();
+  GeometryType *geometry = dynamic_cast<GeometryType*>(this->GetGeometry().GetPointer());
+
+  // Initialize output region with input region in case the filter is not in
+  // place
+  if(this->GetInput() != this->GetOutput() )
+    {
+    itk::ImageRegionConstIterator<TInputImage> itVolIn(this->GetInput(0), outputRegionForThread);
+    itk::ImageRegionIterator<TOutputImage> itVolOut(this->GetOutput(), outputRegionForThread);
+    for(; !itVolOut.IsAtEnd(); ++itVolIn, ++itVolOut)
+      itVolOut.Set( itVolIn.Get() );
+    }
+
+  // Sampling in the requested region. The offsets are relative to the voxel
+  // of index (0,0,0), which may not be in the buffer.
+  const typename TOutputImage::RegionType &volRegion = this->GetOutput()->GetBufferedRegion();
+  int boxMin[3], boxMax[3], ownMin[3], ownMax[3];
+  std::ptrdiff_t offsets[3];
+  double spacing[3];
+  offsets[0] = 1;
+  offsets[1] = volRegion.GetSize(0);
+  offsets[2] = volRegion.GetSize(0) * volRegion.GetSize(1);
+  std::ptrdiff_t beginOffset = 0;
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    boxMin[i] = this->GetOutput()->GetRequestedRegion().GetIndex(i);
+    boxMax[i] = boxMin[i] + this->GetOutput()->GetRequestedRegion().GetSize(i) - 1;
+    ownMin[i] = outputRegionForThread.GetIndex(i);
+    ownMax[i] = ownMin[i] + outputRegionForThread.GetSize(i) - 1;
+    spacing[i] = this->GetOutput()->GetSpacing()[i];
+    beginOffset -= offsets[i] * volRegion.GetIndex(i);
+    }
+  RayCastSampling sampling(boxMin, boxMax, offsets, spacing, m_StepSize);
+
+  // Splat destinations
+  OutputPixelType *beginBuffer = this->GetOutput()->GetBufferPointer() + beginOffset;
+  double *beginValues = ITK_NULLPTR;
+  double *beginWeights = ITK_NULLPTR;
+  if(m_Normalize)
+    {
+    beginValues = &(m_SplatValues[0]) + beginOffset;
+    beginWeights = &(m_SplatWeights[0]) + beginOffset;
+    }
+
+  // volPPToIndex maps the physical 3D coordinates of a point (in mm) to the
+  // corresponding 3D volume index
+  typename GeometryType::ThreeDHomogeneousMatrixType volPPToIndex;
+  volPPToIndex = GetPhysicalPointToIndexMatrix( this->GetInput(0) );
+
+  // Iterators on projections input
+  typedef ProjectionsRegionConstIteratorRayBased<TInputImage> InputRegionIterator;
+  InputRegionIterator *itIn;
+  itIn = InputRegionIterator::New(this->GetInput(1),
+                                  buffReg,
+                                  geometry,
+                                  volPPToIndex);
+
+  // Go over each pixel of the projection
+  double weights[8];
+  std::ptrdiff_t voxelOffsets[8];
+  int voxelIndices[8][3];
+  for(unsigned int pix=0; pix<buffReg.GetNumberOfPixels(); pix++, itIn->Next())
+    {
+    const typename InputRegionIterator::PointType source = itIn->GetSourcePosition();
+    const typename InputRegionIterator::PointType sourceToPixel = itIn->GetSourceToPixel();
+    if(sampling.SetRay(&source[0], &sourceToPixel[0]) == 0)
+      continue;
+
+    // Samples which may splat in the voxels of the thread
+    unsigned int first, end;
+    sampling.ClipToBox(ownMin, ownMax, first, end);
+    const double rayValue = itIn->Get();
+    for(unsigned int k=first; k<end; k++)
+      {
+      sampling.Interpolation(k, weights, voxelOffsets, voxelIndices);
+      const double sampleWeight = sampling.GetWeight(k);
+      for(unsigned int c=0; c<8; c++)
+        {
+        if(voxelIndices[c][0] < ownMin[0] || voxelIndices[c][0] > ownMax[0] ||
+           voxelIndices[c][1] < ownMin[1] || voxelIndices[c][1] > ownMax[1] ||
+           voxelIndices[c][2] < ownMin[2] || voxelIndices[c][2] > ownMax[2])
+          continue;
+        if(m_Normalize)
+          {
+          beginValues[voxelOffsets[c]] += rayValue * sampleWeight * weights[c];
+          beginWeights[voxelOffsets[c]] += weights[c];
+          }
+        else
+          beginBuffer[voxelOffsets[c]] += rayValue * sampleWeight * weights[c];
+        }
+      }
+    }
+  delete itIn;
+
+  // Normalization of the voxels of the thread
+  if(m_Normalize)
+    {
+    itk::ImageRegionIterator<TOutputImage> itVolOut(this->GetOutput(), outputRegionForThread);
+    for(; !itVolOut.IsAtEnd(); ++itVolOut)
+      {
+      std::ptrdiff_t offset = 0;
+      for(unsigned int i=0; i<Dimension; i++)
+        offset += itVolOut.GetIndex()[i] * offsets[i];
+      if(vnl_math_abs(beginWeights[offset]) > 1e-6)
+        itVolOut.Set( itVolOut.Get() + beginValues[offset] / beginWeights[offset] );
+      }
+    }
+}
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,89 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkRayCastForwardProjectionImageFilter_h
+#define rtkRayCastForwardProjectionImageFilter_h
+
+#include "rtkConfiguration.h"
+#include "rtkForwardProjectionImageFilter.h"
+
+namespace rtk
+{
+
+/** \class RayCastForwardProjectionImageFilter
+ * \brief Trilinear interpolation forward projection, CPU version of
+ * CudaForwardProjectionImageFilter.
+ *
+ * Each ray is sampled every StepSize mm and the volume is interpolated
+ * trilinearly at each sample, see RayCastSampling.
+ * RayCastBackProjectionImageFilter is the adjoint operator.
+ *
+ * \test rtkadjointoperatorstest.cxx
+ *
+ * \ingroup Projector
+ */
+
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT RayCastForwardProjectionImageFilter :
+  public ForwardProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef RayCastForwardProjectionImageFilter                    Self;
+  typedef ForwardProjectionImageFilter<TInputImage,TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                                Pointer;
+  typedef itk::SmartPointer<const Self>                          ConstPointer;
+
+  /** Useful typedefs. */
+  typedef typename TInputImage::PixelType                        InputPixelType;
+  typedef typename TOutputImage::RegionType                      OutputImageRegionType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(RayCastForwardProjectionImageFilter, ForwardProjectionImageFilter);
+
+  /** Set step size along ray (in mm). Default is 1 mm. */
+  itkGetConstMacro(StepSize, double);
+  itkSetMacro(StepSize, double);
+
+protected:
+  RayCastForwardProjectionImageFilter() : m_StepSize(1.) {}
+  ~RayCastForwardProjectionImageFilter() {}
+
+  void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+  void VerifyInputInformation() ITK_OVERRIDE {}
+
+private:
+  RayCastForwardProjectionImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                      //purposely not implemented
+
+  double m_StepSize;
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkRayCastForwardProjectionImageFilter.hxx"
+#endif
+
+#endif
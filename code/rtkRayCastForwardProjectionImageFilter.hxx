@@ -0,0 +1,109 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkRayCastForwardProjectionImageFilter_hxx
+#define rtkRayCastForwardProjectionImageFilter_hxx
+
+#include "rtkHomogeneousMatrix.h"
+#include "rtkProjectionsRegionConstIteratorRayBased.h"
+#include "rtkRayCastSampling.h"
+
+#include <itkImageRegionIteratorWithIndex.h>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+void
+RayCastForwardProjectionImageFilter<TInputImage,TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId) )
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const typename Superclass::GeometryPointer geometry = this->GetGeometry();
+  const TInputImage *volume = this->GetInput(1);
+
+  // Sampling in the buffered region. The offsets are relative to the voxel of
+  // index (0,0,0), which may not be in the buffer.
+  const typename TInputImage::RegionType &volRegion = volume->GetBufferedRegion();
+  int boxMin[3], boxMax[3];
+  std::ptrdiff_t offsets[3];
+  double spacing[3];
+  offsets[0] = 1;
+  offsets[1] = volRegion.GetSize(0);
+  offsets[2] = volRegion.GetSize(0) * volRegion.GetSize(1);
+  const InputPixelType *beginBuffer = volume->GetBufferPointer();
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    boxMin[i] = volRegion.GetIndex(i);
+    boxMax[i] = volRegion.GetIndex(i) + volRegion.GetSize(i) - 1;
+    spacing[i] = volume->GetSpacing()[i];
+    beginBuffer -= offsets[i] * volRegion.GetIndex(i);
+    }
+  RayCastSampling sampling(boxMin, boxMax, offsets, spacing, m_StepSize);
+
+  // volPPToIndex maps the physical 3D coordinates of a point (in mm) to the
+  // corresponding 3D volume index
+  typename Superclass::GeometryType::ThreeDHomogeneousMatrixType volPPToIndex;
+  volPPToIndex = GetPhysicalPointToIndexMatrix( volume );
+
+  // Only the rays of the pixels in the bounding rectangle of the projection
+  // of the volume are traced, one region per projection
+  std::vector<OutputImageRegionType> regions;
+  this->CullRays(outputRegionForThread, regions);
+
+  // Iterators on input and output projections
+  typedef ProjectionsRegionConstIteratorRayBased<TInputImage> InputRegionIterator;
+  typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
+  double weights[8];
+  std::ptrdiff_t voxelOffsets[8];
+  int voxelIndices[8][3];
+  for(unsigned int iRegion=0; iRegion<regions.size(); iRegion++)
+    {
+    InputRegionIterator *itIn;
+    itIn = InputRegionIterator::New(this->GetInput(),
+                                    regions[iRegion],
+                                    geometry,
+                                    volPPToIndex);
+    OutputRegionIterator itOut(this->GetOutput(), regions[iRegion]);
+
+    // Go over each projection pixel
+    for(unsigned int pix=0; pix<regions[iRegion].GetNumberOfPixels(); pix++, itIn->Next(), ++itOut)
+      {
+      const typename InputRegionIterator::PointType source = itIn->GetSourcePosition();
+      const typename InputRegionIterator::PointType sourceToPixel = itIn->GetSourceToPixel();
+      const unsigned int nSamples = sampling.SetRay(&source[0], &sourceToPixel[0]);
+      double sum = 0.;
+      for(unsigned int k=0; k<nSamples; k++)
+        {
+        sampling.Interpolation(k, weights, voxelOffsets, voxelIndices);
+        double sample = 0.;
+        for(unsigned int c=0; c<8; c++)
+          sample += weights[c] * beginBuffer[voxelOffsets[c]];
+        sum += sampling.GetWeight(k) * sample;
+        }
+      itOut.Set( itIn->Get() + sum );
+      }
+
+    delete itIn;
+    }
+}
+
+} // end namespace rtk
+
+#endif
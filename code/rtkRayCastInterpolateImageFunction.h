@@ -39,6 +39,8 @@ PURPOSE.  See the above copyright notices for more information.
 #include <itkTransform.h>
 #include <itkVector.h>
 
+#include "rtkBrickMaximumGrid.h"
+
 namespace rtk
 {
 
@@ -168,6 +170,14 @@ public:
   /** Get a pointer to the Transform.  */
   itkGetConstMacro( Threshold, double );
  
+  /** Set the grid of empty bricks of the image, if any. The interpolations
+   * in empty bricks are skipped, which does not change the result if the
+   * threshold of the grid is 0. The grid must be up to date. */
+  void SetEmptySpaceGrid(const BrickMaximumGrid<TInputImage> *grid)
+    {
+    m_EmptySpaceGrid = grid;
+    }
+
   /** Check if a point is inside the image buffer.
    * \warning For efficiency, no validity checking of
    * the input image pointer is done. */
@@ -207,6 +217,9 @@ protected:
   /// Pointer to the interpolator
   InterpolatorPointer m_Interpolator;
 
+  /// Grid of empty bricks of the image
+  const BrickMaximumGrid<TInputImage> *m_EmptySpaceGrid;
+
 
 private:
   RayCastInterpolateImageFunction( const Self& ); //purposely not implemented
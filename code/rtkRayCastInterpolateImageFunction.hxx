@@ -86,6 +86,15 @@ public:
     m_Image = input;
     }
 
+  /**
+   * Set the grid of empty bricks of the image, if any. The interpolations in
+   * empty bricks are skipped.
+   */
+  void SetEmptySpaceGrid(const BrickMaximumGrid<TInputImage> *grid)
+    {
+    m_EmptySpaceGrid = grid;
+    }
+
   /**
    *  Initialise the ray using the position and direction of a line.
    *
@@ -239,6 +248,9 @@ protected:
   // call to Evaluate()
   const InputImageType *m_Image;
 
+  // Grid of empty bricks of the image, ITK_NULLPTR if not used
+  const BrickMaximumGrid<TInputImage> *m_EmptySpaceGrid;
+
   /// Flag indicating whether the current ray is valid
   bool m_ValidRay;
 
@@ -1422,6 +1434,13 @@ RayCastHelper<TInputImage, TCoordRep>
        m_NumVoxelPlanesTraversed<m_TotalRayVoxelPlanes;
        m_NumVoxelPlanesTraversed++)
     {
+    // The four voxels are zero in empty bricks (or below a threshold)
+    if(m_EmptySpaceGrid && m_EmptySpaceGrid->IsEmpty(m_RayIntersectionVoxelIndex))
+      {
+      this->IncrementVoxelPointers();
+      continue;
+      }
+
     intensity = this->GetCurrentIntensity();
 
     if (intensity > threshold)
@@ -1452,6 +1471,7 @@ RayCastHelper<TInputImage, TCoordRep>
   int i;
 
   m_ValidRay = false;
+  m_EmptySpaceGrid = ITK_NULLPTR;
 
   m_NumberOfVoxelsInX = 0;
   m_NumberOfVoxelsInY = 0;
@@ -1523,6 +1543,8 @@ RayCastInterpolateImageFunction< TInputImage, TCoordRep >
   m_FocalPoint[0] = 0.;
   m_FocalPoint[1] = 0.;
   m_FocalPoint[2] = 0.;
+
+  m_EmptySpaceGrid = ITK_NULLPTR;
 }
 
 
@@ -1564,6 +1586,7 @@ RayCastInterpolateImageFunction< TInputImage, TCoordRep >
   RayCastHelper<TInputImage, TCoordRep> ray;
   ray.SetImage( this->m_Image );
   ray.ZeroState();
+  ray.SetEmptySpaceGrid( m_EmptySpaceGrid );
   ray.Initialise();
 
   ray.SetRay(point, direction);
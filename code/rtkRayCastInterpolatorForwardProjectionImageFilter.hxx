@@ -46,6 +46,7 @@ RayCastInterpolatorForwardProjectionImageFilter<TInputImage,TOutputImage>
   interpolator->SetThreshold( itk::NumericTraits< double >::NonpositiveMin() );
   interpolator->SetInputImage( this->GetInput(1) );
   interpolator->SetTransform(itk::IdentityTransform<double,3>::New());
+  interpolator->SetEmptySpaceGrid( this->GetEmptySpaceGrid() );
 
   // Get inverse volume direction in an homogeneous matrix
   itk::Matrix<double, Dimension, Dimension> volDirInvNotHom;
@@ -75,26 +76,34 @@ RayCastInterpolatorForwardProjectionImageFilter<TInputImage,TOutputImage>
   typename Superclass::GeometryType::ThreeDHomogeneousMatrixType volMatrix;
   volMatrix = volRayCastOrigin * volDirectionInv * volOriginInv;
 
+  // Only the rays of the pixels in the bounding rectangle of the projection
+  // of the volume are traced, one region per projection
+  std::vector<OutputImageRegionType> regions;
+  this->CullRays(outputRegionForThread, regions);
+
   // Iterators on volume input and output
   typedef ProjectionsRegionConstIteratorRayBased<TInputImage> InputRegionIterator;
-  InputRegionIterator *itIn;
-  itIn = InputRegionIterator::New(this->GetInput(),
-                                  outputRegionForThread,
-                                  geometry,
-                                  volMatrix);
   typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
-  OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
-
-  // Go over each projection pixel
-  for(unsigned int pix=0; pix<outputRegionForThread.GetNumberOfPixels(); pix++, itIn->Next(), ++itOut)
+  for(unsigned int iRegion=0; iRegion<regions.size(); iRegion++)
     {
-    // Compute source position and change coordinate system
-    interpolator->SetFocalPoint( &(itIn->GetSourcePosition()[0]) );
-
-    itOut.Set( itIn->Get() + interpolator->Evaluate( &(itIn->GetPixelPosition()[0]) ) );
+    InputRegionIterator *itIn;
+    itIn = InputRegionIterator::New(this->GetInput(),
+                                    regions[iRegion],
+                                    geometry,
+                                    volMatrix);
+    OutputRegionIterator itOut(this->GetOutput(), regions[iRegion]);
+
+    // Go over each projection pixel
+    for(unsigned int pix=0; pix<regions[iRegion].GetNumberOfPixels(); pix++, itIn->Next(), ++itOut)
+      {
+      // Compute source position and change coordinate system
+      interpolator->SetFocalPoint( &(itIn->GetSourcePosition()[0]) );
+
+      itOut.Set( itIn->Get() + interpolator->Evaluate( &(itIn->GetPixelPosition()[0]) ) );
+      }
+
+    delete itIn;
     }
-
-  delete itIn;
 }
 
 } // end namespace rtk
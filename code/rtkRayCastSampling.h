@@ -0,0 +1,189 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkRayCastSampling_h
+#define rtkRayCastSampling_h
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace rtk
+{
+
+/** \class RayCastSampling
+ * \brief Regular sampling of a ray with trilinear interpolation, as in the
+ * CUDA ray cast projectors.
+ *
+ * The ray source+alpha*sourceToPixel, alpha>=0, is intersected with the box of
+ * voxel centers [BoxMin, BoxMax] in continuous volume indices. It is sampled
+ * every StepSize mm, with a first sample half a step after the entrance in
+ * the box. Each sample has a weight equal to StepSize, except the last one
+ * which accounts for the remaining length of the ray in the box. The
+ * trilinear interpolation is clamped to the box.
+ *
+ * This is the common part of CudaForwardProjectionImageFilter and
+ * CudaRayCastBackProjectionImageFilter and their CPU counterparts,
+ * RayCastForwardProjectionImageFilter and RayCastBackProjectionImageFilter.
+ *
+ * \ingroup Functions
+ */
+class RayCastSampling
+{
+public:
+  RayCastSampling(const int boxMin[3], const int boxMax[3], const std::ptrdiff_t offsets[3],
+                  const double spacing[3], const double stepSize):
+    m_StepSize(stepSize)
+  {
+    for(unsigned int i=0; i<3; i++)
+      {
+      m_BoxMin[i] = boxMin[i];
+      m_BoxMax[i] = boxMax[i];
+      m_Offsets[i] = offsets[i];
+      m_Spacing[i] = spacing[i];
+      }
+  }
+
+  /** Sets the ray and returns its number of samples */
+  unsigned int SetRay(const double source[3], const double sourceToPixel[3])
+  {
+    m_NumberOfSamples = 0;
+    double norm = 0.;
+    for(unsigned int i=0; i<3; i++)
+      norm += sourceToPixel[i] * sourceToPixel[i];
+    if(norm == 0.)
+      return 0;
+    norm = 1./std::sqrt(norm);
+
+    // Unit direction in voxels and intersection with the box
+    double tNear = 0.;
+    double tFar = std::numeric_limits<double>::max();
+    double normMM = 0.;
+    for(unsigned int i=0; i<3; i++)
+      {
+      m_Source[i] = source[i];
+      m_Direction[i] = sourceToPixel[i] * norm;
+      normMM += m_Direction[i] * m_Direction[i] * m_Spacing[i] * m_Spacing[i];
+      if(m_Direction[i] != 0.)
+        {
+        const double t0 = (m_BoxMin[i] - source[i]) / m_Direction[i];
+        const double t1 = (m_BoxMax[i] - source[i]) / m_Direction[i];
+        tNear = std::max(tNear, std::min(t0, t1));
+        tFar = std::min(tFar, std::max(t0, t1));
+        }
+      else if(source[i] < m_BoxMin[i] || source[i] > m_BoxMax[i])
+        return 0;
+      }
+
+    // Samples
+    m_Step = m_StepSize / std::sqrt(normMM);
+    m_First = tNear + 0.5 * m_Step;
+    if(tNear > tFar || m_First > tFar)
+      return 0;
+    m_NumberOfSamples = (unsigned int)std::floor((tFar - m_First) / m_Step) + 1;
+    m_LastWeight = m_StepSize * (1. + (tFar - m_First - m_NumberOfSamples * m_Step + 0.5 * m_Step) / m_Step);
+    return m_NumberOfSamples;
+  }
+
+  /** Restricts the range [first, end) of samples to the ones whose
+   * interpolation may involve the voxels of the box [min, max] */
+  void ClipToBox(const int min[3], const int max[3], unsigned int &first, unsigned int &end) const
+  {
+    double tNear = 0.;
+    double tFar = std::numeric_limits<double>::max();
+    for(unsigned int i=0; i<3; i++)
+      {
+      if(m_Direction[i] != 0.)
+        {
+        const double t0 = (min[i] - 1 - m_Source[i]) / m_Direction[i];
+        const double t1 = (max[i] + 1 - m_Source[i]) / m_Direction[i];
+        tNear = std::max(tNear, std::min(t0, t1));
+        tFar = std::min(tFar, std::max(t0, t1));
+        }
+      else if(m_Source[i] < min[i] - 1 || m_Source[i] > max[i] + 1)
+        {
+        first = end = 0;
+        return;
+        }
+      }
+    if(tNear > tFar)
+      {
+      first = end = 0;
+      return;
+      }
+    const double kFirst = std::floor((tNear - m_First) / m_Step);
+    const double kEnd = std::floor((tFar - m_First) / m_Step) + 2.;
+    first = (unsigned int)std::min(std::max(kFirst, 0.), (double)m_NumberOfSamples);
+    end = (unsigned int)std::min(std::max(kEnd, (double)first), (double)m_NumberOfSamples);
+  }
+
+  /** Weight of sample k in mm */
+  double GetWeight(const unsigned int k) const
+  {
+    return (k+1 == m_NumberOfSamples)?m_LastWeight:m_StepSize;
+  }
+
+  /** Interpolation weights and offsets of the 8 neighbours of sample k. The
+   * offsets are relative to the voxel of index (0,0,0). The indices of the
+   * neighbours are returned in index[8][3]. */
+  void Interpolation(const unsigned int k, double weights[8], std::ptrdiff_t offsets[8], int index[8][3]) const
+  {
+    const double t = m_First + k * m_Step;
+    int low[3], high[3];
+    double d[3];
+    for(unsigned int i=0; i<3; i++)
+      {
+      const double p = m_Source[i] + t * m_Direction[i];
+      const int f = (int)std::floor(p);
+      d[i] = p - f;
+      low[i] = std::min(std::max(f, m_BoxMin[i]), m_BoxMax[i]);
+      high[i] = std::min(std::max(f+1, m_BoxMin[i]), m_BoxMax[i]);
+      }
+    for(unsigned int c=0; c<8; c++)
+      {
+      weights[c] = 1.;
+      offsets[c] = 0;
+      for(unsigned int i=0; i<3; i++)
+        {
+        const bool up = (c >> (2-i)) & 1;
+        weights[c] *= (up)?d[i]:1.-d[i];
+        index[c][i] = (up)?high[i]:low[i];
+        offsets[c] += index[c][i] * m_Offsets[i];
+        }
+      }
+  }
+
+private:
+  int            m_BoxMin[3];
+  int            m_BoxMax[3];
+  std::ptrdiff_t m_Offsets[3];
+  double         m_Spacing[3];
+  double         m_StepSize;
+
+  double         m_Source[3];
+  double         m_Direction[3];
+  double         m_First;
+  double         m_Step;
+  double         m_LastWeight;
+  unsigned int   m_NumberOfSamples;
+};
+
+} // end namespace rtk
+
+#endif
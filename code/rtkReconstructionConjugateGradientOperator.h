@@ -20,7 +20,6 @@
 #define rtkReconstructionConjugateGradientOperator_h
 
 #include <itkMultiplyImageFilter.h>
-#include <itkAddImageFilter.h>
 
 #include "rtkConstantImageSource.h"
 
@@ -30,6 +29,7 @@
 
 #include "rtkThreeDCircularProjectionGeometry.h"
 #include "rtkLaplacianImageFilter.h"
+#include "rtkExpressionImageFilter.h"
 
 #ifdef RTK_USE_CUDA
   #include "rtkCudaConstantVolumeSource.h"
@@ -58,6 +58,15 @@ namespace rtk
    * This filter takes in input f and outputs R_t D R f + gamma Laplacian f
    * If m_Regularized is false (default), regularization is ignored, and gamma is considered null 
    *
+   * With a support mask M, the input is multiplied by M and so is the output.
+   * With regularization, the multiplication of the output by M is computed
+   * in the same pass as the regularization, see MaskedAddExpressionType.
+   *
+   * If a ProjectionsPreconditioner filter F is set, e.g., a ramp filter, the
+   * filter outputs R_t sqrt(D) F sqrt(D) R f + gamma Laplacian f instead, and
+   * input 2 must be sqrt(D). F must be symmetric positive, see
+   * ConjugateGradientConeBeamReconstructionFilter.
+   *
    * \dot
    * digraph ReconstructionConjugateGradientOperator {
    *
@@ -81,8 +90,8 @@ namespace rtk
    * MultiplyInput [ label="itk::MultiplyImageFilter" URL="\ref itk::MultiplyImageFilter"];
    * MultiplyOutput [ label="itk::MultiplyImageFilter" URL="\ref itk::MultiplyImageFilter"];
    * Laplacian [ label="rtk::LaplacianImageFilter" URL="\ref rtk::LaplacianImageFilter"];
-   * MultiplyLaplacian [ label="itk::MultiplyImageFilter (by gamma)" URL="\ref itk::MultiplyImageFilter"];
-   * Add [ label="itk::AddImageFilter" URL="\ref itk::AddImageFilter"];
+   * Add [ label="rtk::ExpressionImageFilter (+ -gamma x)" URL="\ref rtk::ExpressionImageFilter"];
+   * MaskedAdd [ label="rtk::ExpressionImageFilter (M (+ -gamma x))" URL="\ref rtk::ExpressionImageFilter" style=dashed];
    *
    * Input0 -> MultiplyInput;
    * Input3 -> MultiplyInput;
@@ -95,10 +104,13 @@ namespace rtk
    * BackProjection -> Add;
    * Input3 -> MultiplyOutput;
    * MultiplyInput -> Laplacian;
-   * Laplacian -> MultiplyLaplacian;
-   * MultiplyLaplacian -> Add;
+   * Laplacian -> Add;
    * Add -> MultiplyOutput;
    * MultiplyOutput -> Output;
+   * BackProjection -> MaskedAdd [style=dashed];
+   * Laplacian -> MaskedAdd [style=dashed];
+   * Input3 -> MaskedAdd [style=dashed];
+   * MaskedAdd -> Output [style=dashed];
    * }
    * \enddot
    *
@@ -137,7 +149,14 @@ public:
 
   typedef rtk::ConstantImageSource<TOutputImage>                          ConstantSourceType;
   typedef itk::MultiplyImageFilter<TOutputImage>                          MultiplyFilterType;
-  typedef itk::AddImageFilter<TOutputImage>                               AddFilterType;
+  typedef rtk::Expression::Sum< rtk::Expression::Input<0>,
+                                rtk::Expression::Product< rtk::Expression::Parameter<0>,
+                                                          rtk::Expression::Input<1> > > AddExpressionType;
+  typedef rtk::ExpressionImageFilter<TOutputImage, AddExpressionType>     AddFilterType;
+  typedef rtk::Expression::Product< rtk::Expression::Input<2>, AddExpressionType > MaskedAddExpressionType;
+  typedef rtk::ExpressionImageFilter<TOutputImage, MaskedAddExpressionType> MaskedAddFilterType;
+  typedef itk::ImageToImageFilter<TOutputImage, TOutputImage>             ProjectionsPreconditionerType;
+  typedef typename ProjectionsPreconditionerType::Pointer                 ProjectionsPreconditionerPointer;
 
   typedef rtk::LaplacianImageFilter<TOutputImage, GradientImageType>      LaplacianFilterType;
 
@@ -153,6 +172,10 @@ public:
   void SetSupportMask(const TOutputImage *SupportMask);
   typename TOutputImage::ConstPointer GetSupportMask();
 
+  /** Set the filter applied to the weighted forward projections before
+   * backprojection, if any. Default is none. */
+  void SetProjectionsPreconditioner (const ProjectionsPreconditionerPointer _arg);
+
   /** Set the geometry of both m_BackProjectionFilter and m_ForwardProjectionFilter */
   itkSetMacro(Geometry, ThreeDCircularProjectionGeometry::Pointer)
   
@@ -179,10 +202,12 @@ protected:
   typename MultiplyFilterType::Pointer              m_MultiplyProjectionsFilter;
   typename MultiplyFilterType::Pointer              m_MultiplyOutputVolumeFilter;
   typename MultiplyFilterType::Pointer              m_MultiplyInputVolumeFilter;
-  typename MultiplyFilterType::Pointer              m_MultiplyLaplacianFilter;
   typename AddFilterType::Pointer                   m_AddFilter;
+  typename MaskedAddFilterType::Pointer             m_MaskedAddFilter;
   typename LaplacianFilterType::Pointer             m_LaplacianFilter;
   typename MultiplyFilterType::Pointer              m_MultiplySupportMaskFilter;
+  ProjectionsPreconditionerPointer                  m_ProjectionsPreconditioner;
+  typename MultiplyFilterType::Pointer              m_MultiplyPreconditionedProjectionsFilter;
 
   /** Member attributes */
   rtk::ThreeDCircularProjectionGeometry::Pointer    m_Geometry;
@@ -44,11 +44,11 @@ ReconstructionConjugateGradientOperator<TOutputImage>
   m_LaplacianFilter = LaplacianFilterType::New();
 #endif
   m_MultiplyProjectionsFilter = MultiplyFilterType::New();
+  m_MultiplyPreconditionedProjectionsFilter = MultiplyFilterType::New();
   m_MultiplyOutputVolumeFilter = MultiplyFilterType::New();
   m_MultiplyInputVolumeFilter = MultiplyFilterType::New();
   m_AddFilter = AddFilterType::New();
-
-  m_MultiplyLaplacianFilter = MultiplyFilterType::New();
+  m_MaskedAddFilter = MaskedAddFilterType::New();
 
   // Set permanent parameters
   m_ConstantProjectionsSource->SetConstant(itk::NumericTraits<typename TOutputImage::PixelType>::ZeroValue());
@@ -58,7 +58,8 @@ ReconstructionConjugateGradientOperator<TOutputImage>
   m_ConstantProjectionsSource->ReleaseDataFlagOn();
   m_ConstantVolumeSource->ReleaseDataFlagOn();
   m_LaplacianFilter->ReleaseDataFlagOn();
-  m_MultiplyLaplacianFilter->ReleaseDataFlagOn();
+  m_AddFilter->SetInPlace(true);
+  m_MaskedAddFilter->SetInPlace(true);
 }
 
 template< typename TOutputImage>
@@ -94,6 +95,18 @@ ReconstructionConjugateGradientOperator<TOutputImage>
   m_ForwardProjectionFilter = _arg;
 }
 
+template< typename TOutputImage >
+void
+ReconstructionConjugateGradientOperator<TOutputImage>
+::SetProjectionsPreconditioner (const ProjectionsPreconditionerPointer _arg)
+{
+  if(m_ProjectionsPreconditioner != _arg)
+    {
+    m_ProjectionsPreconditioner = _arg;
+    this->Modified();
+    }
+}
+
 template< typename TOutputImage >
 void
 ReconstructionConjugateGradientOperator<TOutputImage>
@@ -158,29 +171,50 @@ ReconstructionConjugateGradientOperator<TOutputImage>
   m_MultiplyProjectionsFilter->SetInput1(m_ForwardProjectionFilter->GetOutput());
   m_MultiplyProjectionsFilter->SetInput2(this->GetInput(2));
 
-  // Set the back projection filter's inputs
+  // Set the back projection filter's inputs, after the preconditioning of the
+  // weighted projections if any. The weights are then the square root of the
+  // weights and they are applied before and after the preconditioner.
   m_BackProjectionFilter->SetInput(0, m_ConstantVolumeSource->GetOutput());
   m_BackProjectionFilter->SetInput(1, m_MultiplyProjectionsFilter->GetOutput());
+  if (m_ProjectionsPreconditioner.IsNotNull())
+    {
+    m_ProjectionsPreconditioner->SetInput(m_MultiplyProjectionsFilter->GetOutput());
+    m_MultiplyPreconditionedProjectionsFilter->SetInput1(m_ProjectionsPreconditioner->GetOutput());
+    m_MultiplyPreconditionedProjectionsFilter->SetInput2(this->GetInput(2));
+    m_BackProjectionFilter->SetInput(1, m_MultiplyPreconditionedProjectionsFilter->GetOutput());
+
+    m_MultiplyProjectionsFilter->ReleaseDataFlagOn();
+    m_ProjectionsPreconditioner->ReleaseDataFlagOn();
+    m_MultiplyPreconditionedProjectionsFilter->ReleaseDataFlagOn();
+    }
   m_FloatingOutputPointer= m_BackProjectionFilter->GetOutput();
 
-  // Set the filters to compute the regularization, if any
-  if (m_Regularized)
+  // Set the filters to compute the regularization, if any. With a support
+  // mask, the output is multiplied by the mask in the same pass. Set
+  // "-1.0*gamma" because we need to perform "-1.0*Laplacian" for correctly
+  // applying quadratic regularization || grad f ||_2^2
+  if (m_Regularized && this->GetSupportMask().IsNotNull())
     {
     m_LaplacianFilter->SetInput(m_FloatingInputPointer);
-    m_MultiplyLaplacianFilter->SetInput1(m_LaplacianFilter->GetOutput());
-    // Set "-1.0*gamma" because we need to perform "-1.0*Laplacian"
-    // for correctly applying quadratic regularization || grad f ||_2^2
-    m_MultiplyLaplacianFilter->SetConstant2(-1.0*m_Gamma);
+    m_MaskedAddFilter->SetInput(0, m_BackProjectionFilter->GetOutput());
+    m_MaskedAddFilter->SetInput(1, m_LaplacianFilter->GetOutput());
+    m_MaskedAddFilter->SetInput(2, this->GetSupportMask());
+    m_MaskedAddFilter->SetParameter(0, -1.0*m_Gamma);
 
-    m_AddFilter->SetInput1( m_BackProjectionFilter->GetOutput());
-    m_AddFilter->SetInput2( m_MultiplyLaplacianFilter->GetOutput());
+    m_FloatingOutputPointer= m_MaskedAddFilter->GetOutput();
+    }
+  else if (m_Regularized)
+    {
+    m_LaplacianFilter->SetInput(m_FloatingInputPointer);
+    m_AddFilter->SetInput(0, m_BackProjectionFilter->GetOutput());
+    m_AddFilter->SetInput(1, m_LaplacianFilter->GetOutput());
+    m_AddFilter->SetParameter(0, -1.0*m_Gamma);
 
     m_FloatingOutputPointer= m_AddFilter->GetOutput();
     }
-
-  // Set the second multiply filter to use the Support Mask, if any
-  if (this->GetSupportMask().IsNotNull())
+  else if (this->GetSupportMask().IsNotNull())
     {
+    // Set the second multiply filter to use the Support Mask
     m_MultiplyOutputVolumeFilter->SetInput1( m_FloatingOutputPointer);
     m_MultiplyOutputVolumeFilter->SetInput2( this->GetSupportMask() );
     m_FloatingOutputPointer= m_MultiplyOutputVolumeFilter->GetOutput();
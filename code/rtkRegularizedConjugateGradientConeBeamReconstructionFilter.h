@@ -188,11 +188,24 @@ public:
   itkSetMacro(TV_iterations, int)
   itkGetMacro(TV_iterations, int)
 
+  /** Stopping criteria of each conjugate gradient, see
+   * ConjugateGradientImageFilter. Both are disabled by default (0). */
+  itkSetMacro(CG_Tolerance, double)
+  itkGetMacro(CG_Tolerance, double)
+  itkSetMacro(CG_StagnationTolerance, double)
+  itkGetMacro(CG_StagnationTolerance, double)
+
+  /** Norms of the residuals of the last conjugate gradient. An
+   * itk::IterationEvent is invoked after each iteration of each conjugate
+   * gradient. */
+  const std::vector<double> &GetResidualNorms();
+
   // Geometry
   itkSetMacro(Geometry, typename ThreeDCircularProjectionGeometry::Pointer)
   itkGetMacro(Geometry, typename ThreeDCircularProjectionGeometry::Pointer)
 
-  /** Preconditioning flag for the conjugate gradient filter */
+  /** Preconditioning flag for the conjugate gradient filter, which then uses
+   * the diagonal preconditioner of ConjugateGradientConeBeamReconstructionFilter */
   itkSetMacro(Preconditioned, bool)
   itkGetMacro(Preconditioned, bool)
 
@@ -225,6 +238,9 @@ protected:
   // so there is nothing to verify
   void VerifyInputInformation() ITK_OVERRIDE {}
 
+  /** Invokes an itk::IterationEvent after each iteration of m_CGFilter */
+  void ReportIteration();
+
   /** Member pointers to the filters used internally (for convenience)*/
   typename CGFilterType::Pointer                   m_CGFilter;
   typename ThresholdFilterType::Pointer            m_PositivityFilter;
@@ -256,6 +272,8 @@ protected:
   /** Conjugate gradient parameters */
   bool            m_IterationCosts;
   bool            m_DisableDisplacedDetectorFilter;
+  double          m_CG_Tolerance;
+  double          m_CG_StagnationTolerance;
 
   // Iterations
   int   m_MainLoop_iterations;
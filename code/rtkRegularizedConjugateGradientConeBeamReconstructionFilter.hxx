@@ -20,6 +20,8 @@
 
 #include "rtkRegularizedConjugateGradientConeBeamReconstructionFilter.h"
 
+#include <itkCommand.h>
+
 namespace rtk
 {
 
@@ -37,6 +39,8 @@ RegularizedConjugateGradientConeBeamReconstructionFilter<TImage>::RegularizedCon
   m_TV_iterations=10;
   m_MainLoop_iterations=10;
   m_CG_iterations=4;
+  m_CG_Tolerance=0.;
+  m_CG_StagnationTolerance=0.;
 
   // Default pipeline: CG, positivity, spatial TV
   m_PerformPositivity = true;
@@ -61,6 +65,28 @@ RegularizedConjugateGradientConeBeamReconstructionFilter<TImage>::RegularizedCon
   m_TVDenoising = TVDenoisingFilterType::New();
   m_WaveletsDenoising = WaveletsDenoisingFilterType::New();
   m_SoftThresholdFilter = SoftThresholdFilterType::New();
+
+  // Forward the iteration events of the conjugate gradient
+  typedef itk::SimpleMemberCommand<Self> IterationCommandType;
+  typename IterationCommandType::Pointer iterationCommand = IterationCommandType::New();
+  iterationCommand->SetCallbackFunction(this, &Self::ReportIteration);
+  m_CGFilter->AddObserver(itk::IterationEvent(), iterationCommand);
+}
+
+template< typename TImage >
+const std::vector<double> &
+RegularizedConjugateGradientConeBeamReconstructionFilter<TImage>
+::GetResidualNorms()
+{
+  return m_CGFilter->GetResidualNorms();
+}
+
+template< typename TImage >
+void
+RegularizedConjugateGradientConeBeamReconstructionFilter<TImage>
+::ReportIteration()
+{
+  this->InvokeEvent( itk::IterationEvent() );
 }
 
 template< typename TImage >
@@ -185,9 +211,15 @@ RegularizedConjugateGradientConeBeamReconstructionFilter<TImage>
   m_CGFilter->SetSupportMask(this->GetSupportMask());
   m_CGFilter->SetGeometry(this->m_Geometry);
   m_CGFilter->SetNumberOfIterations(this->m_CG_iterations);
+  m_CGFilter->SetTolerance(this->m_CG_Tolerance);
+  m_CGFilter->SetStagnationTolerance(this->m_CG_StagnationTolerance);
   m_CGFilter->SetCudaConjugateGradient(this->GetCudaConjugateGradient());
   m_CGFilter->SetRegularized(this->m_RegularizedCG);
   m_CGFilter->SetGamma(this->m_Gamma);
+  if (m_Preconditioned)
+    m_CGFilter->SetPreconditioner(CGFilterType::DIAGONAL);
+  else
+    m_CGFilter->SetPreconditioner(CGFilterType::NONE);
   m_CGFilter->SetIterationCosts(m_IterationCosts);
   m_CGFilter->SetDisableDisplacedDetectorFilter(m_DisableDisplacedDetectorFilter);
 
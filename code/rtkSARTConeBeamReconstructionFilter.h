@@ -24,16 +24,14 @@
 
 #include <itkExtractImageFilter.h>
 #include <itkMultiplyImageFilter.h>
-#include <itkSubtractImageFilter.h>
-#include <itkAddImageAdaptor.h>
-#include <itkDivideOrZeroOutImageFilter.h>
 #include <itkTimeProbe.h>
-#include <itkThresholdImageFilter.h>
 
 #include "rtkRayBoxIntersectionImageFilter.h"
 #include "rtkConstantImageSource.h"
 #include "rtkIterativeConeBeamReconstructionFilter.h"
 #include "rtkDisplacedDetectorImageFilter.h"
+#include "rtkSubSelectFromListImageFilter.h"
+#include "rtkExpressionImageFilter.h"
 
 namespace rtk
 {
@@ -45,16 +43,19 @@ namespace rtk
  * the different steps of the SART cone-beam reconstruction, mainly:
  * - ExtractFilterType to work on one projection at a time
  * - ForwardProjectionImageFilter,
- * - SubtractImageFilter,
- * - BackProjectionImageFilter.
+ * - ExpressionImageFilter to compute the weighted difference with the measured projections,
+ * - BackProjectionImageFilter,
+ * - ExpressionImageFilter to update the volume and enforce positivity.
  * The input stack of projections is processed piece by piece (the size is
  * controlled with ProjectionSubsetSize) via the use of itk::ExtractImageFilter
  * to extract sub-stacks.
  *
  * Two weighting steps must be applied when processing a given projection:
- * - each pixel of the forward projection must be divided by the total length of the
+ * - each pixel of the difference must be divided by the total length of the
  * intersection between the ray and the reconstructed volume. This weighting step
- * is performed using the part of the pipeline that contains RayBoxIntersectionImageFilter
+ * is performed using the part of the pipeline that contains RayBoxIntersectionImageFilter.
+ * The intersection lengths of all projections are computed once and reused in
+ * all iterations, until the geometry or the volume information change.
  * - each voxel of the back projection must be divided by the value it would take if
  * a projection filled with ones was being reprojected. This weighting step is not
  * performed when using a voxel-based back projection, as the weights are all equal to one
@@ -62,6 +63,21 @@ namespace rtk
  * It is implemented in NormalizedJosephBackProjectionImageFilter, which
  * is used in the SART pipeline.
  *
+ * The difference between the measured and the forward projections, its
+ * multiplication by lambda and the gating weight and its division by the ray
+ * lengths are computed in a single pass with ExpressionImageFilter. The sum
+ * of the backprojection and of the current volume and the positivity
+ * threshold are computed in a second one, in place of the backprojection.
+ *
+ * The projections of a subset are processed one at a time by default. With
+ * ParallelSubsetProcessing, the projections of each subset are gathered in a
+ * stack with SubSelectFromListImageFilter and the whole stack goes through
+ * the pipeline at once with the geometry of the subset. The forward and back
+ * projectors then process several projections concurrently and the overhead
+ * of the pipeline is paid once per subset. The result is the same up to the
+ * order of the floating point operations. This mode is not used with gating
+ * weights, which are set projection per projection.
+ *
  * \dot
  * digraph SARTConeBeamReconstructionFilter {
  *
@@ -77,50 +93,42 @@ namespace rtk
  * Extract [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter"];
  * MultiplyByZero [ label="itk::MultiplyImageFilter (by zero)" URL="\ref itk::MultiplyImageFilter"];
  * AfterExtract [label="", fixedsize="false", width=0, height=0, shape=none];
- * Subtract [ label="itk::SubtractImageFilter" URL="\ref itk::SubtractImageFilter"];
- * MultiplyByLambda [ label="itk::MultiplyImageFilter (by lambda)" URL="\ref itk::MultiplyImageFilter"];
- * Divide [ label="itk::DivideOrZeroOutImageFilter" URL="\ref itk::DivideOrZeroOutImageFilter"];
- * GatingWeight [ label="itk::MultiplyImageFilter (by gating weight)" URL="\ref itk::MultiplyImageFilter", style=dashed];
+ * Correction [ label="rtk::ExpressionImageFilter (lambda * (Input0 - Input1) / Input2)" URL="\ref rtk::ExpressionImageFilter"];
  * Displaced [ label="rtk::DisplacedDetectorImageFilter" URL="\ref rtk::DisplacedDetectorImageFilter"];
  * ConstantProjectionStack [ label="rtk::ConstantImageSource" URL="\ref rtk::ConstantImageSource"];
- * ExtractConstantProjection [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter"];
+ * ExtractRayBox [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter"];
  * RayBox [ label="rtk::RayBoxIntersectionImageFilter" URL="\ref rtk::RayBoxIntersectionImageFilter"];
  * ConstantVolume [ label="rtk::ConstantImageSource" URL="\ref rtk::ConstantImageSource"];
  * BackProjection [ label="rtk::BackProjectionImageFilter" URL="\ref rtk::BackProjectionImageFilter"];
- * Add [ label="itk::AddImageFilter" URL="\ref itk::AddImageFilter"];
+ * Update [ label="rtk::ExpressionImageFilter (max(Input0 + Input1, threshold))" URL="\ref rtk::ExpressionImageFilter"];
  * OutofInput0 [label="", fixedsize="false", width=0, height=0, shape=none];
- * Threshold [ label="itk::ThresholdImageFilter" URL="\ref itk::ThresholdImageFilter"];
- * OutofThreshold [label="", fixedsize="false", width=0, height=0, shape=none];
+ * OutofUpdate [label="", fixedsize="false", width=0, height=0, shape=none];
  * OutofBP [label="", fixedsize="false", width=0, height=0, shape=none];
  * BeforeBP [label="", fixedsize="false", width=0, height=0, shape=none];
- * BeforeAdd [label="", fixedsize="false", width=0, height=0, shape=none];
+ * BeforeUpdate [label="", fixedsize="false", width=0, height=0, shape=none];
  * Input0 -> OutofInput0 [arrowhead=none];
  * OutofInput0 -> ForwardProject;
- * OutofInput0 -> BeforeAdd [arrowhead=none];
- * BeforeAdd -> Add;
+ * OutofInput0 -> BeforeUpdate [arrowhead=none];
+ * BeforeUpdate -> Update;
  * ConstantVolume -> BeforeBP [arrowhead=none];
  * BeforeBP -> BackProjection;
  * Extract -> AfterExtract[arrowhead=none];
  * AfterExtract -> MultiplyByZero;
- * AfterExtract -> Subtract;
+ * AfterExtract -> Correction;
  * MultiplyByZero -> ForwardProject;
  * Input1 -> Extract;
- * ForwardProject -> Subtract;
- * Subtract -> MultiplyByLambda;
- * MultiplyByLambda -> Divide;
- * Divide -> GatingWeight;
- * GatingWeight -> Displaced;
- * ConstantProjectionStack -> ExtractConstantProjection;
- * ExtractConstantProjection -> RayBox;
- * RayBox -> Divide;
+ * ForwardProject -> Correction;
+ * ConstantProjectionStack -> RayBox;
+ * RayBox -> ExtractRayBox;
+ * ExtractRayBox -> Correction;
+ * Correction -> Displaced;
  * Displaced -> BackProjection;
  * BackProjection -> OutofBP [arrowhead=none];
- * OutofBP -> Add;
+ * OutofBP -> Update;
  * OutofBP -> BeforeBP [style=dashed, constraint=false];
- * Add -> Threshold;
- * Threshold -> OutofThreshold [arrowhead=none];
- * OutofThreshold -> OutofInput0 [headport="se", style=dashed];
- * OutofThreshold -> Output;
+ * Update -> OutofUpdate [arrowhead=none];
+ * OutofUpdate -> OutofInput0 [headport="se", style=dashed];
+ * OutofUpdate -> Output;
  * }
  * \enddot
  *
@@ -149,15 +157,22 @@ public:
   typedef itk::ExtractImageFilter< InputImageType, InputImageType >                          ExtractFilterType;
   typedef itk::MultiplyImageFilter< OutputImageType, OutputImageType, OutputImageType >      MultiplyFilterType;
   typedef rtk::ForwardProjectionImageFilter< OutputImageType, OutputImageType >              ForwardProjectionFilterType;
-  typedef itk::SubtractImageFilter< OutputImageType, OutputImageType >                       SubtractFilterType;
-  typedef itk::AddImageFilter< OutputImageType, OutputImageType >                            AddFilterType;
   typedef rtk::BackProjectionImageFilter< OutputImageType, OutputImageType >                 BackProjectionFilterType;
   typedef rtk::RayBoxIntersectionImageFilter<OutputImageType, OutputImageType>               RayBoxIntersectionFilterType;
-  typedef itk::DivideOrZeroOutImageFilter<OutputImageType, OutputImageType, OutputImageType> DivideFilterType;
   typedef rtk::ConstantImageSource<OutputImageType>                                          ConstantImageSourceType;
-  typedef itk::ThresholdImageFilter<OutputImageType>                                         ThresholdFilterType;
   typedef rtk::DisplacedDetectorImageFilter<InputImageType>                                  DisplacedDetectorFilterType;
-  typedef itk::MultiplyImageFilter<InputImageType,InputImageType, InputImageType>            GatingWeightsFilterType;
+  typedef rtk::SubSelectFromListImageFilter<InputImageType>                                  SubSelectFilterType;
+
+  /** Expressions of the projection correction, lambda * (p - Rf) / length,
+   * and of the volume update, max(f + correction, threshold) */
+  typedef Expression::QuotientOrZero< Expression::Product< Expression::Difference< Expression::Input<0>,
+                                                                                   Expression::Input<1> >,
+                                                           Expression::Parameter<0> >,
+                                      Expression::Input<2> >                                 CorrectionExpressionType;
+  typedef Expression::Maximum< Expression::Sum< Expression::Input<0>, Expression::Input<1> >,
+                               Expression::Parameter<0> >                                   UpdateExpressionType;
+  typedef rtk::ExpressionImageFilter<OutputImageType, CorrectionExpressionType>             CorrectionFilterType;
+  typedef rtk::ExpressionImageFilter<OutputImageType, UpdateExpressionType>                 UpdateFilterType;
 
 /** Standard New method. */
   itkNewMacro(Self);
@@ -199,6 +214,11 @@ public:
   /** Set / Get whether the displaced detector filter should be disabled */
   itkSetMacro(DisableDisplacedDetectorFilter, bool)
   itkGetMacro(DisableDisplacedDetectorFilter, bool)
+
+  /** Set / Get whether all the projections of a subset are processed at
+   * once. Default is false. */
+  itkSetMacro(ParallelSubsetProcessing, bool)
+  itkGetMacro(ParallelSubsetProcessing, bool)
 protected:
   SARTConeBeamReconstructionFilter();
   ~SARTConeBeamReconstructionFilter() {}
@@ -213,25 +233,27 @@ protected:
    * to verify. */
   void VerifyInputInformation() ITK_OVERRIDE {}
 
+  /** True if the projections of each subset are processed at once */
+  bool ProcessSubsetsAtOnce() const;
+
   /** Pointers to each subfilter of this composite filter */
   typename ExtractFilterType::Pointer            m_ExtractFilter;
   typename ExtractFilterType::Pointer            m_ExtractFilterRayBox;
   typename MultiplyFilterType::Pointer           m_ZeroMultiplyFilter;
   typename ForwardProjectionFilterType::Pointer  m_ForwardProjectionFilter;
-  typename SubtractFilterType::Pointer           m_SubtractFilter;
-  typename AddFilterType::Pointer                m_AddFilter;
-  typename MultiplyFilterType::Pointer           m_MultiplyFilter;
+  typename CorrectionFilterType::Pointer         m_CorrectionFilter;
+  typename UpdateFilterType::Pointer             m_UpdateFilter;
   typename BackProjectionFilterType::Pointer     m_BackProjectionFilter;
   typename RayBoxIntersectionFilterType::Pointer m_RayBoxFilter;
-  typename DivideFilterType::Pointer             m_DivideFilter;
   typename ConstantImageSourceType::Pointer      m_ConstantProjectionStackSource;
   typename ConstantImageSourceType::Pointer      m_ConstantVolumeSource;
-  typename ThresholdFilterType::Pointer          m_ThresholdFilter;
   typename DisplacedDetectorFilterType::Pointer  m_DisplacedDetectorFilter;
-  typename GatingWeightsFilterType::Pointer      m_GatingWeightsFilter;
+  typename SubSelectFilterType::Pointer          m_SubSelectFilter;
+  typename SubSelectFilterType::Pointer          m_SubSelectFilterRayBox;
 
   bool m_EnforcePositivity;
   bool m_DisableDisplacedDetectorFilter;
+  bool m_ParallelSubsetProcessing;
 
 private:
   /** Number of projections processed before the volume is updated (1 for SART,
@@ -261,15 +283,11 @@ private:
   itk::TimeProbe m_ExtractProbe;
   itk::TimeProbe m_ZeroMultiplyProbe;
   itk::TimeProbe m_ForwardProjectionProbe;
-  itk::TimeProbe m_SubtractProbe;
+  itk::TimeProbe m_CorrectionProbe;
   itk::TimeProbe m_DisplacedDetectorProbe;
-  itk::TimeProbe m_MultiplyProbe;
   itk::TimeProbe m_RayBoxProbe;
-  itk::TimeProbe m_DivideProbe;
   itk::TimeProbe m_BackProjectionProbe;
-  itk::TimeProbe m_ThresholdProbe;
-  itk::TimeProbe m_AddProbe;
-  itk::TimeProbe m_GatingProbe;
+  itk::TimeProbe m_UpdateProbe;
 
 }; // end of class
 
@@ -41,37 +41,34 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   // Create each filter of the composite filter
   m_ExtractFilter = ExtractFilterType::New();
   m_ZeroMultiplyFilter = MultiplyFilterType::New();
-  m_SubtractFilter = SubtractFilterType::New();
-  m_AddFilter = AddFilterType::New();
+  m_CorrectionFilter = CorrectionFilterType::New();
+  m_UpdateFilter = UpdateFilterType::New();
   m_DisplacedDetectorFilter = DisplacedDetectorFilterType::New();
-  m_MultiplyFilter = MultiplyFilterType::New();
-  m_GatingWeightsFilter = GatingWeightsFilterType::New();
   m_ConstantVolumeSource = ConstantImageSourceType::New();
 
   // Create the filters required for correct weighting of the difference
   // projection
   m_ExtractFilterRayBox = ExtractFilterType::New();
   m_RayBoxFilter = RayBoxIntersectionFilterType::New();
-  m_DivideFilter = DivideFilterType::New();
   m_ConstantProjectionStackSource = ConstantImageSourceType::New();
 
-  // Create the filter that enforces positivity
-  m_ThresholdFilter = ThresholdFilterType::New();
+  // Create the filters gathering the projections of a subset
+  m_SubSelectFilter = SubSelectFilterType::New();
+  m_SubSelectFilterRayBox = SubSelectFilterType::New();
 
   //Permanent internal connections
   m_ZeroMultiplyFilter->SetInput1( itk::NumericTraits<typename InputImageType::PixelType>::ZeroValue() );
   m_ZeroMultiplyFilter->SetInput2( m_ExtractFilter->GetOutput() );
 
-  m_SubtractFilter->SetInput(0, m_ExtractFilter->GetOutput() );
+  m_CorrectionFilter->SetInput(0, m_ExtractFilter->GetOutput() );
 
-  m_MultiplyFilter->SetInput1( itk::NumericTraits<typename InputImageType::PixelType>::ZeroValue() );
-  m_MultiplyFilter->SetInput2( m_SubtractFilter->GetOutput() );
+  m_RayBoxFilter->SetInput(m_ConstantProjectionStackSource->GetOutput());
+  m_ExtractFilterRayBox->SetInput(m_RayBoxFilter->GetOutput());
+  m_CorrectionFilter->SetInput(2, m_ExtractFilterRayBox->GetOutput());
+  m_DisplacedDetectorFilter->SetInput(m_CorrectionFilter->GetOutput());
 
-  m_ExtractFilterRayBox->SetInput(m_ConstantProjectionStackSource->GetOutput());
-  m_RayBoxFilter->SetInput(m_ExtractFilterRayBox->GetOutput());
-  m_DivideFilter->SetInput1(m_MultiplyFilter->GetOutput());
-  m_DivideFilter->SetInput2(m_RayBoxFilter->GetOutput());
-  m_DisplacedDetectorFilter->SetInput(m_DivideFilter->GetOutput());
+  // The volume is updated in place of the backprojection
+  m_UpdateFilter->SetInPlace(true);
 
   // Default parameters
   m_ExtractFilter->SetDirectionCollapseToSubmatrix();
@@ -80,6 +77,7 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   m_NumberOfProjectionsPerSubset = 1; //Default is the SART behavior
   m_DisplacedDetectorFilter->SetPadOnTruncatedSide(false);
   m_DisableDisplacedDetectorFilter = false;
+  m_ParallelSubsetProcessing = false;
 }
 
 template<class TInputImage, class TOutputImage>
@@ -115,6 +113,14 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   m_IsGated = true;
 }
 
+template<class TInputImage, class TOutputImage>
+bool
+SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
+::ProcessSubsetsAtOnce() const
+{
+  return m_ParallelSubsetProcessing && !m_IsGated && m_NumberOfProjectionsPerSubset > 1;
+}
+
 template<class TInputImage, class TOutputImage>
 void
 SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
@@ -126,16 +132,8 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   if ( !inputPtr )
     return;
 
-  if(m_EnforcePositivity)
-    {
-    m_ThresholdFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
-    m_ThresholdFilter->GetOutput()->PropagateRequestedRegion();
-    }
-  else
-    {
-    m_BackProjectionFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
-    m_BackProjectionFilter->GetOutput()->PropagateRequestedRegion();
-    }
+  m_UpdateFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
+  m_UpdateFilter->GetOutput()->PropagateRequestedRegion();
 }
 
 template<class TInputImage, class TOutputImage>
@@ -163,13 +161,13 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   m_BackProjectionFilter->SetInput(1, m_DisplacedDetectorFilter->GetOutput() );
   m_BackProjectionFilter->SetTranspose(false);
 
-  m_AddFilter->SetInput1(m_BackProjectionFilter->GetOutput());
-  m_AddFilter->SetInput2(this->GetInput(0));
+  m_UpdateFilter->SetInput(0, m_BackProjectionFilter->GetOutput());
+  m_UpdateFilter->SetInput(1, this->GetInput(0));
 
   m_ForwardProjectionFilter->SetInput( 0, m_ZeroMultiplyFilter->GetOutput() );
   m_ForwardProjectionFilter->SetInput( 1, this->GetInput(0) );
   m_ExtractFilter->SetInput( this->GetInput(1) );
-  m_SubtractFilter->SetInput(1, m_ForwardProjectionFilter->GetOutput() );
+  m_CorrectionFilter->SetInput(1, m_ForwardProjectionFilter->GetOutput() );
 
   // For the same reason, set geometry now
   // Check and set geometry
@@ -177,15 +175,64 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
     {
     itkGenericExceptionMacro(<< "The geometry of the reconstruction has not been set");
     }
-  m_ForwardProjectionFilter->SetGeometry(this->m_Geometry);
-  m_BackProjectionFilter->SetGeometry(this->m_Geometry.GetPointer());
-  m_DisplacedDetectorFilter->SetGeometry(this->m_Geometry);
 
-  if (m_IsGated) // For gated SART, insert a gating filter into the pipeline
+  if(ProcessSubsetsAtOnce())
     {
-    m_GatingWeightsFilter->SetInput1(m_DivideFilter->GetOutput());
-    m_GatingWeightsFilter->SetConstant2(1);
-    m_DisplacedDetectorFilter->SetInput(m_GatingWeightsFilter->GetOutput());
+    // The projections of a subset are gathered in a stack with the
+    // corresponding geometry. Only the first subset is set at that point.
+    std::vector<bool> selection(projRegion.GetSize(this->InputImageDimension-1), false);
+    for(unsigned int i=0; i<m_NumberOfProjectionsPerSubset && i<selection.size(); i++)
+      selection[i] = true;
+    m_SubSelectFilter->SetInputProjectionStack( this->GetInput(1) );
+    m_SubSelectFilter->SetInputGeometry( this->m_Geometry );
+    m_SubSelectFilter->SetSelectedProjections( selection );
+    m_SubSelectFilterRayBox->SetInputProjectionStack( m_RayBoxFilter->GetOutput() );
+    m_SubSelectFilterRayBox->SetInputGeometry( this->m_Geometry );
+    m_SubSelectFilterRayBox->SetSelectedProjections( selection );
+
+    m_ZeroMultiplyFilter->SetInput2( m_SubSelectFilter->GetOutput() );
+    m_CorrectionFilter->SetInput(0, m_SubSelectFilter->GetOutput() );
+    m_CorrectionFilter->SetInput(2, m_SubSelectFilterRayBox->GetOutput() );
+
+    m_ForwardProjectionFilter->SetGeometry( m_SubSelectFilter->GetOutputGeometry() );
+    m_BackProjectionFilter->SetGeometry( m_SubSelectFilter->GetOutputGeometry().GetPointer() );
+    m_DisplacedDetectorFilter->SetGeometry( m_SubSelectFilter->GetOutputGeometry() );
+    }
+  else
+    {
+    m_ZeroMultiplyFilter->SetInput2( m_ExtractFilter->GetOutput() );
+    m_CorrectionFilter->SetInput(0, m_ExtractFilter->GetOutput() );
+    m_CorrectionFilter->SetInput(2, m_ExtractFilterRayBox->GetOutput() );
+
+    m_ForwardProjectionFilter->SetGeometry(this->m_Geometry);
+    m_BackProjectionFilter->SetGeometry(this->m_Geometry.GetPointer());
+    m_DisplacedDetectorFilter->SetGeometry(this->m_Geometry);
+    }
+
+  // The displaced detector filter computes its corners from the projections
+  // of its geometry, i.e., from the projections of the subset only with
+  // ParallelSubsetProcessing. The offsets are computed from all projections
+  // so that the weights are the same for all subsets and in both modes.
+  if(!m_DisableDisplacedDetectorFilter)
+    {
+    typename TInputImage::PointType corner;
+    this->GetInput(1)->TransformIndexToPhysicalPoint(projRegion.GetIndex(), corner);
+    double inferiorCorner = corner[0];
+    double superiorCorner = corner[0];
+    if(this->GetInput(1)->GetSpacing()[0] < 0.)
+      inferiorCorner += this->GetInput(1)->GetSpacing()[0] * (projRegion.GetSize(0)-1);
+    else
+      superiorCorner += this->GetInput(1)->GetSpacing()[0] * (projRegion.GetSize(0)-1);
+
+    double maxInfUntiltCorner = itk::NumericTraits<double>::NonpositiveMin();
+    double minSupUntiltCorner = itk::NumericTraits<double>::max();
+    for(unsigned int i=0; i<this->m_Geometry->GetProjectionOffsetsX().size(); i++)
+      {
+      maxInfUntiltCorner = std::max(maxInfUntiltCorner, this->m_Geometry->ToUntiltedCoordinateAtIsocenter(i, inferiorCorner) );
+      minSupUntiltCorner = std::min(minSupUntiltCorner, this->m_Geometry->ToUntiltedCoordinateAtIsocenter(i, superiorCorner) );
+      }
+    m_DisplacedDetectorFilter->SetOffsets(minSupUntiltCorner - superiorCorner,
+                                          maxInfUntiltCorner - inferiorCorner);
     }
 
   m_ConstantProjectionStackSource->SetInformationFromImage(const_cast<TInputImage *>(this->GetInput(1)));
@@ -207,41 +254,30 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   m_RayBoxFilter->SetBoxMin(Corner1);
   m_RayBoxFilter->SetBoxMax(Corner2);
 
+  // The ray box intersection of all projections is computed once and reused
+  // in all iterations. It is recomputed only if the geometry, the volume
+  // information or the projection information have changed.
+  if(this->GetGeometry()->GetMTime() > m_RayBoxFilter->GetOutput()->GetUpdateMTime())
+    m_RayBoxFilter->Modified();
+
+  // Positivity is enforced with a zero threshold of the updated volume
   if(m_EnforcePositivity)
-    {
-    m_ThresholdFilter->SetOutsideValue(0);
-    m_ThresholdFilter->ThresholdBelow(0);
-    m_ThresholdFilter->SetInput(m_AddFilter->GetOutput() );
-
-    // Update output information
-    m_ThresholdFilter->UpdateOutputInformation();
-    this->GetOutput()->SetOrigin( m_ThresholdFilter->GetOutput()->GetOrigin() );
-    this->GetOutput()->SetSpacing( m_ThresholdFilter->GetOutput()->GetSpacing() );
-    this->GetOutput()->SetDirection( m_ThresholdFilter->GetOutput()->GetDirection() );
-    this->GetOutput()->SetLargestPossibleRegion( m_ThresholdFilter->GetOutput()->GetLargestPossibleRegion() );
-    }
+    m_UpdateFilter->SetParameter(0, 0.);
   else
-    {
-    // Update output information
-    m_AddFilter->UpdateOutputInformation();
-    this->GetOutput()->SetOrigin( m_AddFilter->GetOutput()->GetOrigin() );
-    this->GetOutput()->SetSpacing( m_AddFilter->GetOutput()->GetSpacing() );
-    this->GetOutput()->SetDirection( m_AddFilter->GetOutput()->GetDirection() );
-    this->GetOutput()->SetLargestPossibleRegion( m_AddFilter->GetOutput()->GetLargestPossibleRegion() );
-    }
+    m_UpdateFilter->SetParameter(0, -itk::NumericTraits<double>::max());
+
+  // Update output information
+  m_UpdateFilter->UpdateOutputInformation();
+  this->GetOutput()->SetOrigin( m_UpdateFilter->GetOutput()->GetOrigin() );
+  this->GetOutput()->SetSpacing( m_UpdateFilter->GetOutput()->GetSpacing() );
+  this->GetOutput()->SetDirection( m_UpdateFilter->GetOutput()->GetDirection() );
+  this->GetOutput()->SetLargestPossibleRegion( m_UpdateFilter->GetOutput()->GetLargestPossibleRegion() );
 
   // Set memory management flags
   m_ZeroMultiplyFilter->ReleaseDataFlagOn();
   m_ForwardProjectionFilter->ReleaseDataFlagOn();
-  m_SubtractFilter->ReleaseDataFlagOn();
-  m_MultiplyFilter->ReleaseDataFlagOn();
-  m_RayBoxFilter->ReleaseDataFlagOn();
-  m_DivideFilter->ReleaseDataFlagOn();
+  m_CorrectionFilter->ReleaseDataFlagOn();
   m_DisplacedDetectorFilter->ReleaseDataFlagOn();
-
-  if (m_EnforcePositivity)
-    m_AddFilter->ReleaseDataFlagOn();
-
 }
 
 template<class TInputImage, class TOutputImage>
@@ -265,10 +301,16 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
     projOrder[i] = i;
   std::random_shuffle( projOrder.begin(), projOrder.end() );
 
-  m_MultiplyFilter->SetInput1( (const float) m_Lambda/(double)m_NumberOfProjectionsPerSubset  );
+  m_CorrectionFilter->SetParameter(0, m_Lambda/(double)m_NumberOfProjectionsPerSubset );
 
-  // Create the zero projection stack used as input by RayBoxIntersectionFilter
-  m_ConstantProjectionStackSource->Update();
+  // Compute the ray box intersection of all projections, if required
+  m_RayBoxProbe.Start();
+  m_RayBoxFilter->UpdateLargestPossibleRegion();
+  m_RayBoxProbe.Stop();
+
+  // Number of projections processed at once, one or a whole subset
+  const bool subsetsAtOnce = ProcessSubsetsAtOnce();
+  const unsigned int nProjPerStep = (subsetsAtOnce)?m_NumberOfProjectionsPerSubset:1;
 
   // Declare the image used in the main loop
   typename TInputImage::Pointer pimg;
@@ -277,17 +319,28 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   for(unsigned int iter = 0; iter < m_NumberOfIterations; iter++)
     {
     unsigned int projectionsProcessedInSubset = 0;
-    for(unsigned int i = 0; i < nProj; i++)
+    for(unsigned int i = 0; i < nProj; i += nProjPerStep)
       {
       // Change projection subset
-      subsetRegion.SetIndex( Dimension-1, projOrder[i] );
-      m_ExtractFilter->SetExtractionRegion(subsetRegion);
-      m_ExtractFilterRayBox->SetExtractionRegion(subsetRegion);
+      if (subsetsAtOnce)
+        {
+        std::vector<bool> selection(nProj, false);
+        for(unsigned int j = i; j < nProj && j < i + nProjPerStep; j++)
+          selection[ projOrder[j] ] = true;
+        m_SubSelectFilter->SetSelectedProjections(selection);
+        m_SubSelectFilterRayBox->SetSelectedProjections(selection);
+        }
+      else
+        {
+        subsetRegion.SetIndex( Dimension-1, projOrder[i] );
+        m_ExtractFilter->SetExtractionRegion(subsetRegion);
+        m_ExtractFilterRayBox->SetExtractionRegion(subsetRegion);
+        }
 
       // Set gating weight for the current projection
       if (m_IsGated)
         {
-        m_GatingWeightsFilter->SetConstant2(m_GatingWeights[i]);
+        m_CorrectionFilter->SetParameter(0, m_Lambda * m_GatingWeights[i] / (double)m_NumberOfProjectionsPerSubset );
         }
 
       // This is required to reset the full pipeline
@@ -295,8 +348,16 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
       m_BackProjectionFilter->GetOutput()->PropagateRequestedRegion();
 
       m_ExtractProbe.Start();
-      m_ExtractFilter->Update();
-      m_ExtractFilterRayBox->Update();
+      if (subsetsAtOnce)
+        {
+        m_SubSelectFilter->Update();
+        m_SubSelectFilterRayBox->Update();
+        }
+      else
+        {
+        m_ExtractFilter->Update();
+        m_ExtractFilterRayBox->Update();
+        }
       m_ExtractProbe.Stop();
 
       m_ZeroMultiplyProbe.Start();
@@ -307,28 +368,9 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
       m_ForwardProjectionFilter->Update();
       m_ForwardProjectionProbe.Stop();
 
-      m_SubtractProbe.Start();
-      m_SubtractFilter->Update();
-      m_SubtractProbe.Stop();
-
-      m_MultiplyProbe.Start();
-      m_MultiplyFilter->Update();
-      m_MultiplyProbe.Stop();
-
-      m_RayBoxProbe.Start();
-      m_RayBoxFilter->Update();
-      m_RayBoxProbe.Stop();
-
-      m_DivideProbe.Start();
-      m_DivideFilter->Update();
-      m_DivideProbe.Stop();
-
-      if (m_IsGated)
-        {
-        m_GatingProbe.Start();
-        m_GatingWeightsFilter->Update();
-        m_GatingProbe.Stop();
-        }
+      m_CorrectionProbe.Start();
+      m_CorrectionFilter->Update();
+      m_CorrectionProbe.Stop();
 
       m_DisplacedDetectorProbe.Start();
       m_DisplacedDetectorFilter->Update();
@@ -338,33 +380,23 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
       m_BackProjectionFilter->Update();
       m_BackProjectionProbe.Stop();
 
-      projectionsProcessedInSubset++;
-      if ((projectionsProcessedInSubset == m_NumberOfProjectionsPerSubset) || (i == nProj - 1))
+      projectionsProcessedInSubset += nProjPerStep;
+      if ((projectionsProcessedInSubset >= m_NumberOfProjectionsPerSubset) || (i + nProjPerStep >= nProj))
         {
-        m_AddFilter->SetInput1(m_BackProjectionFilter->GetOutput());
+        m_UpdateFilter->SetInput(0, m_BackProjectionFilter->GetOutput());
 
-        m_AddProbe.Start();
-        m_AddFilter->Update();
-        m_AddProbe.Start();
-
-        if (m_EnforcePositivity)
-          {
-          m_ThresholdProbe.Start();
-          m_ThresholdFilter->Update();
-          m_ThresholdProbe.Stop();
-          }
+        m_UpdateProbe.Start();
+        m_UpdateFilter->Update();
+        m_UpdateProbe.Stop();
 
         // To start a new subset:
         // - plug the output of the pipeline back into the Forward projection filter
         // - set the input of the Back projection filter to zero
-        if (m_EnforcePositivity)
-          pimg = m_ThresholdFilter->GetOutput();
-        else
-          pimg = m_AddFilter->GetOutput();
+        pimg = m_UpdateFilter->GetOutput();
         pimg->DisconnectPipeline();
 
         m_ForwardProjectionFilter->SetInput(1, pimg );
-        m_AddFilter->SetInput2(pimg);
+        m_UpdateFilter->SetInput(1, pimg);
         m_BackProjectionFilter->SetInput(0, m_ConstantVolumeSource->GetOutput());
 
         projectionsProcessedInSubset = 0;
@@ -393,27 +425,16 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
      << ' ' << m_ZeroMultiplyProbe.GetUnit() << std::endl;
   os << "  Forward projection: " << m_ForwardProjectionProbe.GetTotal()
      << ' ' << m_ForwardProjectionProbe.GetUnit() << std::endl;
-  os << "  Subtraction: " << m_SubtractProbe.GetTotal()
-     << ' ' << m_SubtractProbe.GetUnit() << std::endl;
-  os << "  Multiplication by lambda: " << m_MultiplyProbe.GetTotal()
-     << ' ' << m_MultiplyProbe.GetUnit() << std::endl;
+  os << "  Weighted difference: " << m_CorrectionProbe.GetTotal()
+     << ' ' << m_CorrectionProbe.GetUnit() << std::endl;
   os << "  Ray box intersection: " << m_RayBoxProbe.GetTotal()
      << ' ' << m_RayBoxProbe.GetUnit() << std::endl;
-  os << "  Division: " << m_DivideProbe.GetTotal()
-     << ' ' << m_DivideProbe.GetUnit() << std::endl;
-  os << "  Multiplication by the gating weights: " << m_GatingProbe.GetTotal()
-     << ' ' << m_GatingProbe.GetUnit() << std::endl;
   os << "  Displaced detector: " << m_DisplacedDetectorProbe.GetTotal()
      << ' ' << m_DisplacedDetectorProbe.GetUnit() << std::endl;
   os << "  Back projection: " << m_BackProjectionProbe.GetTotal()
      << ' ' << m_BackProjectionProbe.GetUnit() << std::endl;
-  os << "  Volume update: " << m_AddProbe.GetTotal()
-     << ' ' << m_AddProbe.GetUnit() << std::endl;
-  if (m_EnforcePositivity)
-    {
-    os << "  Positivity enforcement: " << m_ThresholdProbe.GetTotal()
-    << ' ' << m_ThresholdProbe.GetUnit() << std::endl;
-    }
+  os << "  Volume update: " << m_UpdateProbe.GetTotal()
+     << ' ' << m_UpdateProbe.GetUnit() << std::endl;
 }
 
 } // end namespace rtk
@@ -0,0 +1,106 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkSiddonBackProjectionImageFilter_h
+#define rtkSiddonBackProjectionImageFilter_h
+
+#include "rtkConfiguration.h"
+#include "rtkBackProjectionImageFilter.h"
+#include "rtkThreeDCircularProjectionGeometry.h"
+
+namespace rtk
+{
+
+/** \class SiddonBackProjectionImageFilter
+ * \brief Back projection with the exact intersection length of the rays with
+ * the voxels.
+ *
+ * The back projector is the adjoint operator of
+ * SiddonForwardProjectionImageFilter: each projection value is added to the
+ * voxels crossed by its ray, weighted by the intersection length in mm.
+ *
+ * The volume is split in slabs, one per thread. Each thread clips the rays to
+ * its slab, so it only visits and updates its own voxels, in the order of the
+ * projection pixels. The result is therefore the same as with a single thread
+ * and there is no concurrent write.
+ *
+ * \test rtkadjointoperatorstest.cxx
+ *
+ * \ingroup Projector
+ */
+
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT SiddonBackProjectionImageFilter :
+  public BackProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef SiddonBackProjectionImageFilter                        Self;
+  typedef BackProjectionImageFilter<TInputImage,TOutputImage>    Superclass;
+  typedef itk::SmartPointer<Self>                                Pointer;
+  typedef itk::SmartPointer<const Self>                          ConstPointer;
+  typedef typename TInputImage::PixelType                        InputPixelType;
+  typedef typename TOutputImage::PixelType                       OutputPixelType;
+  typedef typename TOutputImage::RegionType                      OutputImageRegionType;
+  typedef rtk::ThreeDCircularProjectionGeometry                  GeometryType;
+  typedef typename GeometryType::Pointer                         GeometryPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SiddonBackProjectionImageFilter, BackProjectionImageFilter);
+
+protected:
+  SiddonBackProjectionImageFilter() {}
+  ~SiddonBackProjectionImageFilter() {}
+
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
+
+  /** The requested region is split in slabs, see the class description. */
+  bool SupportsBricks() const ITK_OVERRIDE { return false; }
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+  void VerifyInputInformation() ITK_OVERRIDE {}
+
+private:
+  SiddonBackProjectionImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                  //purposely not implemented
+
+  /** Adds the ray value weighted by the intersection lengths */
+  struct RaySplat
+    {
+    OutputPixelType *m_Volume;
+    double           m_Value;
+    inline void operator()(const std::ptrdiff_t offset, const double length)
+      {
+      m_Volume[offset] += length * m_Value;
+      }
+    };
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkSiddonBackProjectionImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkSiddonBackProjectionImageFilter_hxx
+#define rtkSiddonBackProjectionImageFilter_hxx
+
+#include "rtkHomogeneousMatrix.h"
+#include "rtkProjectionsRegionConstIteratorRayBased.h"
+#include "rtkSiddonRayTraversal.h"
+
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+void
+SiddonBackProjectionImageFilter<TInputImage,TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  // The checks of the voxel-based back projection do not apply, rays are
+  // computed for any detector by the ray-based projection iterator
+  if( !dynamic_cast<GeometryType*>(this->GetGeometry().GetPointer()) )
+    {
+    itkGenericExceptionMacro(<< "Error, ThreeDCircularProjectionGeometry expected");
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+SiddonBackProjectionImageFilter<TInputImage,TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId))
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const typename TInputImage::RegionType buffReg = this->GetInput(1)->GetBufferedRegion();
+  GeometryType *geometry = dynamic_cast<GeometryType*>(this->GetGeometry().GetPointer());
+
+  // Initialize output region with input region in case the filter is not in
+  // place
+  if(this->GetInput() != this->GetOutput() )
+    {
+    itk::ImageRegionConstIterator<TInputImage> itVolIn(this->GetInput(0), outputRegionForThread);
+    itk::ImageRegionIterator<TOutputImage> itVolOut(this->GetOutput(), outputRegionForThread);
+    for(; !itVolOut.IsAtEnd(); ++itVolIn, ++itVolOut)
+      itVolOut.Set( itVolIn.Get() );
+    }
+
+  // Traversal of the voxels of the thread, which are the only ones it
+  // updates. The offsets are relative to the voxel of index (0,0,0), which
+  // may not be in the buffer.
+  const typename TOutputImage::RegionType &volRegion = this->GetOutput()->GetBufferedRegion();
+  int boxMin[3], boxMax[3];
+  std::ptrdiff_t offsets[3];
+  offsets[0] = 1;
+  offsets[1] = volRegion.GetSize(0);
+  offsets[2] = volRegion.GetSize(0) * volRegion.GetSize(1);
+  RaySplat raySplat;
+  raySplat.m_Volume = this->GetOutput()->GetBufferPointer();
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    boxMin[i] = outputRegionForThread.GetIndex(i);
+    boxMax[i] = outputRegionForThread.GetIndex(i) + outputRegionForThread.GetSize(i) - 1;
+    raySplat.m_Volume -= offsets[i] * volRegion.GetIndex(i);
+    }
+  const SiddonRayTraversal traversal(boxMin, boxMax, offsets);
+  const typename TOutputImage::SpacingType spacing = this->GetOutput()->GetSpacing();
+
+  // volPPToIndex maps the physical 3D coordinates of a point (in mm) to the
+  // corresponding 3D volume index
+  typename GeometryType::ThreeDHomogeneousMatrixType volPPToIndex;
+  volPPToIndex = GetPhysicalPointToIndexMatrix( this->GetInput(0) );
+
+  // Iterators on projections input
+  typedef ProjectionsRegionConstIteratorRayBased<TInputImage> InputRegionIterator;
+  InputRegionIterator *itIn;
+  itIn = InputRegionIterator::New(this->GetInput(1),
+                                  buffReg,
+                                  geometry,
+                                  volPPToIndex);
+
+  // Go over each pixel of the projection. The intersection lengths are
+  // fractions of the source to pixel vector which is converted to mm.
+  for(unsigned int pix=0; pix<buffReg.GetNumberOfPixels(); pix++, itIn->Next())
+    {
+    const typename InputRegionIterator::PointType source = itIn->GetSourcePosition();
+    const typename InputRegionIterator::PointType sourceToPixel = itIn->GetSourceToPixel();
+    double norm = 0.;
+    for(unsigned int i=0; i<Dimension; i++)
+      norm += vnl_math_sqr(sourceToPixel[i] * spacing[i]);
+    raySplat.m_Value = itIn->Get() * std::sqrt(norm);
+    traversal(&source[0], &sourceToPixel[0], raySplat);
+    }
+
+  delete itIn;
+}
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,97 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkSiddonForwardProjectionImageFilter_h
+#define rtkSiddonForwardProjectionImageFilter_h
+
+#include "rtkConfiguration.h"
+#include "rtkForwardProjectionImageFilter.h"
+
+namespace rtk
+{
+
+/** \class SiddonForwardProjectionImageFilter
+ * \brief Forward projection with the exact intersection length of the rays
+ * with the voxels.
+ *
+ * The volume is considered piecewise constant and the line integral is
+ * computed with the incremental voxel traversal of [Siddon, Med Phys, 1985]
+ * and [Jacobs et al, 1998], see SiddonRayTraversal. It computes the same
+ * model as RayCastInterpolatorForwardProjectionImageFilter without its
+ * per-ray overhead. SiddonBackProjectionImageFilter is the adjoint operator.
+ *
+ * \test rtkforwardprojectiontest.cxx, rtkadjointoperatorstest.cxx
+ *
+ * \ingroup Projector
+ */
+
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT SiddonForwardProjectionImageFilter :
+  public ForwardProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef SiddonForwardProjectionImageFilter                     Self;
+  typedef ForwardProjectionImageFilter<TInputImage,TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                                Pointer;
+  typedef itk::SmartPointer<const Self>                          ConstPointer;
+
+  /** Useful typedefs. */
+  typedef typename TInputImage::PixelType                        InputPixelType;
+  typedef typename TOutputImage::PixelType                       OutputPixelType;
+  typedef typename TOutputImage::RegionType                      OutputImageRegionType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SiddonForwardProjectionImageFilter, ForwardProjectionImageFilter);
+
+protected:
+  SiddonForwardProjectionImageFilter() {}
+  ~SiddonForwardProjectionImageFilter() {}
+
+  void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+  void VerifyInputInformation() ITK_OVERRIDE {}
+
+private:
+  SiddonForwardProjectionImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                     //purposely not implemented
+
+  /** Accumulates the voxel values weighted by the intersection lengths */
+  struct RaySum
+    {
+    const InputPixelType *m_Volume;
+    double                m_Sum;
+    inline void operator()(const std::ptrdiff_t offset, const double length)
+      {
+      m_Sum += length * m_Volume[offset];
+      }
+    };
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkSiddonForwardProjectionImageFilter.hxx"
+#endif
+
+#endif
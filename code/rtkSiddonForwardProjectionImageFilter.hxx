@@ -0,0 +1,103 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkSiddonForwardProjectionImageFilter_hxx
+#define rtkSiddonForwardProjectionImageFilter_hxx
+
+#include "rtkHomogeneousMatrix.h"
+#include "rtkProjectionsRegionConstIteratorRayBased.h"
+#include "rtkSiddonRayTraversal.h"
+
+#include <itkImageRegionIteratorWithIndex.h>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+void
+SiddonForwardProjectionImageFilter<TInputImage,TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId) )
+{
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const typename Superclass::GeometryPointer geometry = this->GetGeometry();
+  const TInputImage *volume = this->GetInput(1);
+
+  // Traversal of the voxels of the buffered region. The offsets are relative
+  // to the voxel of index (0,0,0), which may not be in the buffer.
+  const typename TInputImage::RegionType &volRegion = volume->GetBufferedRegion();
+  int boxMin[3], boxMax[3];
+  std::ptrdiff_t offsets[3];
+  offsets[0] = 1;
+  offsets[1] = volRegion.GetSize(0);
+  offsets[2] = volRegion.GetSize(0) * volRegion.GetSize(1);
+  RaySum raySum;
+  raySum.m_Volume = volume->GetBufferPointer();
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    boxMin[i] = volRegion.GetIndex(i);
+    boxMax[i] = volRegion.GetIndex(i) + volRegion.GetSize(i) - 1;
+    raySum.m_Volume -= offsets[i] * volRegion.GetIndex(i);
+    }
+  const SiddonRayTraversal traversal(boxMin, boxMax, offsets);
+  const typename TInputImage::SpacingType spacing = volume->GetSpacing();
+
+  // volPPToIndex maps the physical 3D coordinates of a point (in mm) to the
+  // corresponding 3D volume index
+  typename Superclass::GeometryType::ThreeDHomogeneousMatrixType volPPToIndex;
+  volPPToIndex = GetPhysicalPointToIndexMatrix( volume );
+
+  // Only the rays of the pixels in the bounding rectangle of the projection
+  // of the volume are traced, one region per projection
+  std::vector<OutputImageRegionType> regions;
+  this->CullRays(outputRegionForThread, regions);
+
+  // Iterators on input and output projections
+  typedef ProjectionsRegionConstIteratorRayBased<TInputImage> InputRegionIterator;
+  typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
+  for(unsigned int iRegion=0; iRegion<regions.size(); iRegion++)
+    {
+    InputRegionIterator *itIn;
+    itIn = InputRegionIterator::New(this->GetInput(),
+                                    regions[iRegion],
+                                    geometry,
+                                    volPPToIndex);
+    OutputRegionIterator itOut(this->GetOutput(), regions[iRegion]);
+
+    // Go over each projection pixel. The intersection lengths are fractions
+    // of the source to pixel vector which is converted to mm.
+    for(unsigned int pix=0; pix<regions[iRegion].GetNumberOfPixels(); pix++, itIn->Next(), ++itOut)
+      {
+      const typename InputRegionIterator::PointType source = itIn->GetSourcePosition();
+      const typename InputRegionIterator::PointType sourceToPixel = itIn->GetSourceToPixel();
+      raySum.m_Sum = 0.;
+      traversal(&source[0], &sourceToPixel[0], raySum);
+
+      double norm = 0.;
+      for(unsigned int i=0; i<Dimension; i++)
+        norm += vnl_math_sqr(sourceToPixel[i] * spacing[i]);
+      itOut.Set( itIn->Get() + raySum.m_Sum * std::sqrt(norm) );
+      }
+
+    delete itIn;
+    }
+}
+
+} // end namespace rtk
+
+#endif
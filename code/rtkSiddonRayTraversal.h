@@ -0,0 +1,148 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef rtkSiddonRayTraversal_h
+#define rtkSiddonRayTraversal_h
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace rtk
+{
+
+/** \class SiddonRayTraversal
+ * \brief Incremental traversal of the voxels crossed by a ray.
+ *
+ * The voxels of a box of indices [BoxMin, BoxMax] crossed by the segment
+ * source+alpha*sourceToPixel, alpha in [0,1], are visited in order with the
+ * incremental algorithm of [Jacobs et al, Journal of Computing and
+ * Information Technology, 1998], an improvement of [Siddon, Med Phys, 1985].
+ * All coordinates are continuous volume indices, voxel i spans [i-0.5, i+0.5]
+ * along each dimension. The visitor is called with the offset of each voxel
+ * from the voxel of index (0,0,0) and the length of the intersection of the
+ * ray with the voxel, as a fraction of the length of sourceToPixel.
+ *
+ * The traversal does not allocate memory and the visitor is a template
+ * parameter so that it can be inlined.
+ *
+ * \ingroup Functions
+ */
+class SiddonRayTraversal
+{
+public:
+  SiddonRayTraversal(const int boxMin[3], const int boxMax[3], const std::ptrdiff_t offsets[3])
+  {
+    for(unsigned int i=0; i<3; i++)
+      {
+      m_BoxMin[i] = boxMin[i];
+      m_BoxMax[i] = boxMax[i];
+      m_Offsets[i] = offsets[i];
+      }
+  }
+
+  template <class TVisitor>
+  inline void operator()(const double source[3], const double sourceToPixel[3], TVisitor &visitor) const
+  {
+    // Intersection of the segment with the box
+    double alphaMin = 0.;
+    double alphaMax = 1.;
+    for(unsigned int i=0; i<3; i++)
+      {
+      if(sourceToPixel[i] != 0.)
+        {
+        const double inv = 1./sourceToPixel[i];
+        const double a0 = (m_BoxMin[i] - 0.5 - source[i]) * inv;
+        const double a1 = (m_BoxMax[i] + 0.5 - source[i]) * inv;
+        alphaMin = std::max(alphaMin, std::min(a0, a1));
+        alphaMax = std::min(alphaMax, std::max(a0, a1));
+        }
+      else if(source[i] < m_BoxMin[i] - 0.5 || source[i] > m_BoxMax[i] + 0.5)
+        return;
+      }
+    if(alphaMin >= alphaMax)
+      return;
+
+    // First voxel and next voxel borders along each dimension. On a border,
+    // the voxel is the one in the direction of the ray.
+    int index[3];
+    int step[3];
+    double alphaNext[3];
+    double alphaStep[3];
+    std::ptrdiff_t offset = 0;
+    for(unsigned int i=0; i<3; i++)
+      {
+      const double p = source[i] + alphaMin * sourceToPixel[i] + 0.5;
+      if(sourceToPixel[i] < 0.)
+        index[i] = (int)std::ceil(p) - 1;
+      else
+        index[i] = (int)std::floor(p);
+      index[i] = std::min(std::max(index[i], m_BoxMin[i]), m_BoxMax[i]);
+      offset += index[i] * m_Offsets[i];
+
+      if(sourceToPixel[i] > 0.)
+        {
+        step[i] = 1;
+        alphaStep[i] = 1./sourceToPixel[i];
+        alphaNext[i] = (index[i] + 0.5 - source[i]) * alphaStep[i];
+        }
+      else if(sourceToPixel[i] < 0.)
+        {
+        step[i] = -1;
+        alphaStep[i] = -1./sourceToPixel[i];
+        alphaNext[i] = (source[i] - index[i] + 0.5) * alphaStep[i];
+        }
+      else
+        {
+        step[i] = 0;
+        alphaStep[i] = 0.;
+        alphaNext[i] = std::numeric_limits<double>::max();
+        }
+      }
+
+    // Go from border to border
+    double alpha = alphaMin;
+    for(;;)
+      {
+      unsigned int m = (alphaNext[0]<alphaNext[1])?0:1;
+      m = (alphaNext[2]<alphaNext[m])?2:m;
+      if(alphaNext[m] >= alphaMax)
+        {
+        visitor(offset, alphaMax - alpha);
+        return;
+        }
+      visitor(offset, alphaNext[m] - alpha);
+      alpha = alphaNext[m];
+      index[m] += step[m];
+      if(index[m] < m_BoxMin[m] || index[m] > m_BoxMax[m])
+        return;
+      offset += step[m] * m_Offsets[m];
+      alphaNext[m] += alphaStep[m];
+      }
+  }
+
+private:
+  int            m_BoxMin[3];
+  int            m_BoxMax[3];
+  std::ptrdiff_t m_Offsets[3];
+};
+
+} // end namespace rtk
+
+#endif
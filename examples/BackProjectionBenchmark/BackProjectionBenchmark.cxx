@@ -0,0 +1,91 @@
+// RTK includes
+#include "rtkConfiguration.h"
+#include <rtkFDKBackProjectionImageFilter.h>
+#include <rtkConstantImageSource.h>
+#include <rtkThreeDCircularProjectionGeometry.h>
+
+// ITK includes
+#include <itkTimeProbe.h>
+
+#include <cstdlib>
+
+// Times the FDK backprojection of a constant projection stack in a cubic
+// volume with the default split of the volume in slabs and with bricks.
+// Usage: BackProjectionBenchmark [volume size, e.g., 512 or 1024]
+//                                [number of projections] [brick size]
+int main(int argc, char *argv[])
+{
+  const unsigned int volumeSize = (argc>1)?atoi(argv[1]):512;
+  const unsigned int numberOfProjections = (argc>2)?atoi(argv[2]):64;
+  const unsigned int brickSize = (argc>3)?atoi(argv[3]):32;
+
+  // Defines the image type
+  typedef itk::Image< float, 3 > ImageType;
+
+  // Circular geometry, 1 mm voxels and a detector large enough to cover the
+  // volume with a magnification of 2
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  GeometryType::Pointer geometry = GeometryType::New();
+  const double sid = 2. * volumeSize;
+  const double sdd = 4. * volumeSize;
+  for(unsigned int noProj=0; noProj<numberOfProjections; noProj++)
+    geometry->AddProjection(sid, sdd, noProj * 360. / numberOfProjections);
+
+  // Projections
+  typedef rtk::ConstantImageSource< ImageType > ConstantImageSourceType;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SpacingType spacing;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  size[0] = 2 * volumeSize;
+  size[1] = 2 * volumeSize;
+  size[2] = numberOfProjections;
+  spacing.Fill(1.);
+  origin[0] = -0.5 * (size[0] - 1.);
+  origin[1] = -0.5 * (size[1] - 1.);
+  origin[2] = 0.;
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+  projectionsSource->SetConstant( 1. );
+  projectionsSource->Update();
+
+  // Volume
+  ConstantImageSourceType::Pointer volumeSource = ConstantImageSourceType::New();
+  size.Fill(volumeSize);
+  origin.Fill(-0.5 * (volumeSize - 1.));
+  volumeSource->SetOrigin( origin );
+  volumeSource->SetSpacing( spacing );
+  volumeSource->SetSize( size );
+  volumeSource->SetConstant( 0. );
+
+  std::cout << "Backprojecting " << numberOfProjections << " projections in a "
+            << volumeSize << "^3 volume" << std::endl;
+
+  // Backprojection, in place in the volume which is therefore regenerated
+  // (and zeroed) at each run
+  typedef rtk::FDKBackProjectionImageFilter<ImageType, ImageType> BackProjectionType;
+  BackProjectionType::Pointer bp = BackProjectionType::New();
+  bp->SetInput( 0, volumeSource->GetOutput() );
+  bp->SetInput( 1, projectionsSource->GetOutput() );
+  bp->SetGeometry( geometry );
+
+  const unsigned int bricks[2] = {0, brickSize};
+  for(unsigned int b=0; b<2; b++)
+    {
+    bp->SetBrickSize(bricks[b]);
+
+    itk::TimeProbe probe;
+    probe.Start();
+    bp->Update();
+    probe.Stop();
+
+    if(bricks[b])
+      std::cout << "Bricks of " << bricks[b] << "^3 voxels: ";
+    else
+      std::cout << "Slabs: ";
+    std::cout << probe.GetTotal() << ' ' << probe.GetUnit() << std::endl;
+    }
+
+  return 0;
+}
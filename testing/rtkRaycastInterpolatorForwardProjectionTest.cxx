@@ -152,5 +152,16 @@ int main(int , char** )
   CheckImageQuality<OutputImageType>(slp->GetOutput(), fp->GetOutput(), 1.25, 43, 255.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+  std::cout << "\n\n****** Case 3: Shepp-Logan, empty space skipping ******" << std::endl;
+
+  // Skipping the bricks of zeros must not change the result
+  OutputImageType::Pointer noSkipping = fp->GetOutput();
+  noSkipping->DisconnectPipeline();
+  fp->SetEmptySpaceSkipping(true);
+  fp->Update();
+
+  CheckImageQuality<OutputImageType>(fp->GetOutput(), noSkipping, 1e-10, 100, 255.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
   return EXIT_SUCCESS;
 }
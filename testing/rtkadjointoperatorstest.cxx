@@ -4,6 +4,10 @@
 #include "rtkConstantImageSource.h"
 #include "rtkJosephBackProjectionImageFilter.h"
 #include "rtkJosephForwardProjectionImageFilter.h"
+#include "rtkRayCastBackProjectionImageFilter.h"
+#include "rtkRayCastForwardProjectionImageFilter.h"
+#include "rtkSiddonBackProjectionImageFilter.h"
+#include "rtkSiddonForwardProjectionImageFilter.h"
 #ifdef RTK_USE_CUDA
   #include "rtkCudaForwardProjectionImageFilter.h"
   #include "rtkCudaRayCastBackProjectionImageFilter.h"
@@ -16,8 +20,8 @@
  *
  * This test generates a random volume "v" and a random set of projections "p",
  * and compares the scalar products <Rv , p> and <v, R* p>, where R is either the
- * Joseph forward projector or the Cuda ray cast forward projector,
- * and R* is either the Joseph back projector or the Cuda ray cast back projector.
+ * Joseph, the Siddon, the ray cast or the Cuda ray cast forward projector, and
+ * R* is the corresponding back projector.
  * If R* is indeed the adjoint of R, these scalar products are equal.
  *
  * \author Cyril Mory
@@ -161,6 +165,51 @@ int main(int, char** )
       CheckScalarProducts<OutputImageType, OutputImageType>(randomVolumeSource->GetOutput(), bp->GetOutput(), randomProjectionsSource->GetOutput(), fw->GetOutput());
       std::cout << "\n\nTest PASSED! " << std::endl;
 
+      std::cout << "\n\n****** Siddon Forward projector ******" << std::endl;
+
+      typedef rtk::SiddonForwardProjectionImageFilter<OutputImageType, OutputImageType> SiddonForwardProjectorType;
+      SiddonForwardProjectorType::Pointer sfw = SiddonForwardProjectorType::New();
+      sfw->SetInput(0, constantProjectionsSource->GetOutput());
+      sfw->SetInput(1, randomVolumeSource->GetOutput());
+      sfw->SetGeometry( geometry );
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( sfw->Update() );
+
+      std::cout << "\n\n****** Siddon Back projector ******" << std::endl;
+
+      typedef rtk::SiddonBackProjectionImageFilter<OutputImageType, OutputImageType> SiddonBackProjectorType;
+      SiddonBackProjectorType::Pointer sbp = SiddonBackProjectorType::New();
+      sbp->SetInput(0, constantVolumeSource->GetOutput());
+      sbp->SetInput(1, randomProjectionsSource->GetOutput());
+      sbp->SetGeometry( geometry.GetPointer() );
+
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( sbp->Update() );
+
+      CheckScalarProducts<OutputImageType, OutputImageType>(randomVolumeSource->GetOutput(), sbp->GetOutput(), randomProjectionsSource->GetOutput(), sfw->GetOutput());
+      std::cout << "\n\nTest PASSED! " << std::endl;
+
+      std::cout << "\n\n****** Ray Cast Forward projector ******" << std::endl;
+
+      typedef rtk::RayCastForwardProjectionImageFilter<OutputImageType, OutputImageType> RayCastForwardProjectorType;
+      RayCastForwardProjectorType::Pointer rfw = RayCastForwardProjectorType::New();
+      rfw->SetInput(0, constantProjectionsSource->GetOutput());
+      rfw->SetInput(1, randomVolumeSource->GetOutput());
+      rfw->SetGeometry( geometry );
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( rfw->Update() );
+
+      std::cout << "\n\n****** Ray Cast Back projector ******" << std::endl;
+
+      typedef rtk::RayCastBackProjectionImageFilter<OutputImageType, OutputImageType> RayCastBackProjectorType;
+      RayCastBackProjectorType::Pointer rbp = RayCastBackProjectorType::New();
+      rbp->SetInput(0, constantVolumeSource->GetOutput());
+      rbp->SetInput(1, randomProjectionsSource->GetOutput());
+      rbp->SetGeometry( geometry.GetPointer() );
+      rbp->SetNormalize(false);
+
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( rbp->Update() );
+
+      CheckScalarProducts<OutputImageType, OutputImageType>(randomVolumeSource->GetOutput(), rbp->GetOutput(), randomProjectionsSource->GetOutput(), rfw->GetOutput());
+      std::cout << "\n\nTest PASSED! " << std::endl;
+
     #ifdef USE_CUDA
       std::cout << "\n\n****** Cuda Ray Cast Forward projector ******" << std::endl;
 
@@ -1,5 +1,6 @@
 #include <itkRandomImageSource.h>
 #include <itkImageRegionIterator.h>
+#include <itkCommand.h>
 
 #include "rtkConstantImageSource.h"
 #include "rtkTestConfiguration.h"
@@ -104,6 +105,32 @@ void CheckImageQuality(typename TImage1::Pointer recon, typename TImage2::Pointe
  * \author Cyril Mory
  */
 
+// Counts the iteration events
+class IterationCounter : public itk::Command
+{
+public:
+  typedef IterationCounter        Self;
+  typedef itk::Command            Superclass;
+  typedef itk::SmartPointer<Self> Pointer;
+  itkNewMacro(Self);
+
+  void Execute(itk::Object *caller, const itk::EventObject &event) ITK_OVERRIDE
+    {
+    Execute( (const itk::Object *)caller, event);
+    }
+
+  void Execute(const itk::Object *, const itk::EventObject &event) ITK_OVERRIDE
+    {
+    if( itk::IterationEvent().CheckEvent(&event) )
+      m_Count++;
+    }
+
+  unsigned int m_Count;
+
+protected:
+  IterationCounter() : m_Count(0) {}
+};
+
 int main(int, char** )
 {
   const unsigned int Dimension = 3;
@@ -191,6 +218,61 @@ int main(int, char** )
 
   CheckImageQuality<OutputImageType, OutputImageType>(cg->GetOutput(), randomVolumeSource->GetOutput());
 
+  // Same with a relative residual tolerance, which must stop the iterations
+  // before the maximum number of iterations
+  const double tolerance = 1e-1;
+  const int maxIterations = 200;
+  IterationCounter::Pointer counter = IterationCounter::New();
+  cg->AddObserver(itk::IterationEvent(), counter);
+  cg->SetNumberOfIterations(maxIterations);
+  cg->SetTolerance(tolerance);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( cg->Update() );
+
+  const std::vector<double> &norms = cg->GetResidualNorms();
+  const int performedIterations = norms.size()-1;
+  if( (int)counter->m_Count != performedIterations || performedIterations > maxIterations )
+    {
+    std::cerr << "Test Failed, " << counter->m_Count << " iteration events for "
+              << performedIterations << " iterations." << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  if( performedIterations < maxIterations && norms.back() > tolerance * norms.front() )
+    {
+    std::cerr << "Test Failed, stopped at iteration " << performedIterations
+              << " with a relative residual of " << norms.back() / norms.front() << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  if( performedIterations == maxIterations )
+    {
+    std::cerr << "Test Failed, the tolerance did not stop the iterations." << std::endl;
+    exit(EXIT_FAILURE);
+    }
+
+  // Same with a stagnation tolerance only, which must stop the iterations at
+  // the first iteration decreasing the residual by less than this fraction
+  const double stagnationTolerance = 0.5;
+  cg->SetTolerance(0.);
+  cg->SetStagnationTolerance(stagnationTolerance);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( cg->Update() );
+
+  const std::vector<double> &stagnationNorms = cg->GetResidualNorms();
+  const int stagnationIterations = stagnationNorms.size()-1;
+  if( stagnationIterations >= maxIterations )
+    {
+    std::cerr << "Test Failed, the stagnation tolerance did not stop the iterations." << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  for(int k=1; k<=stagnationIterations; k++)
+    {
+    const bool stagnation = stagnationNorms[k-1] - stagnationNorms[k] < stagnationTolerance * stagnationNorms[k-1];
+    if( stagnation != (k == stagnationIterations) )
+      {
+      std::cerr << "Test Failed, stopped at iteration " << stagnationIterations
+                << " while the residual stagnates at iteration " << k << std::endl;
+      exit(EXIT_FAILURE);
+      }
+    }
+
   std::cout << "\n\nTest PASSED! " << std::endl;
 
   return EXIT_SUCCESS;
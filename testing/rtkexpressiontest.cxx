@@ -0,0 +1,185 @@
+#include <itkRandomImageSource.h>
+#include <itkImageDuplicator.h>
+#include <itkImageRegionIterator.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkAddImageFilter.h>
+#include <itkSubtractImageFilter.h>
+#include <itkMultiplyImageFilter.h>
+#include <itkDivideOrZeroOutImageFilter.h>
+#include <itkThresholdImageFilter.h>
+
+#include "rtkTest.h"
+#include "rtkMacro.h"
+
+#include "rtkExpressionImageFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * \file rtkexpressiontest.cxx
+ *
+ * \brief Tests the pointwise expressions of ExpressionImageFilter
+ *
+ * Evaluates on random images the expressions used by the iterative
+ * reconstruction filters and compares them with the equivalent chains of itk
+ * arithmetic filters: the SART correction against DivideOrZeroOutImageFilter
+ * with denominators around its threshold of 1e-5, the update with Maximum as
+ * positivity constraint against ThresholdImageFilter, and the conjugate
+ * gradient sum computed in place while input 0 is also read as input 1.
+ */
+
+template<class TImage>
+void CheckExpression(typename TImage::Pointer expression, typename TImage::Pointer reference)
+{
+  typedef itk::ImageRegionConstIterator<TImage> IteratorType;
+  IteratorType itExp(expression, expression->GetLargestPossibleRegion());
+  IteratorType itRef(reference, reference->GetLargestPossibleRegion());
+
+  double maxError = 0.;
+  while(!itRef.IsAtEnd())
+    {
+    const double error = std::abs(itExp.Get() - itRef.Get()) /
+                         std::max(1., (double)std::abs(itRef.Get()));
+    maxError = std::max(maxError, error);
+    ++itExp;
+    ++itRef;
+    }
+  std::cout << "Maximum relative error = " << maxError << std::endl;
+  if(maxError > 1e-5)
+    {
+    std::cerr << "Test Failed, maximum relative error " << maxError
+              << " is above 1e-5" << std::endl;
+    exit(EXIT_FAILURE);
+    }
+}
+
+int main(int, char** )
+{
+  const unsigned int Dimension = 3;
+  typedef float                                     OutputPixelType;
+  typedef itk::Image< OutputPixelType, Dimension >  ImageType;
+
+  // Random image sources
+  typedef itk::RandomImageSource< ImageType > RandomImageSourceType;
+  RandomImageSourceType::Pointer randomSource[3];
+
+  RandomImageSourceType::SizeType size;
+#if FAST_TESTS_NO_CHECKS
+  size.Fill(4);
+#else
+  size.Fill(32);
+#endif
+  const double minimum[3] = {-2., -5., -1.};
+  const double maximum[3] = { 3.,  1.,  4.};
+  for(unsigned int i=0; i<3; i++)
+    {
+    randomSource[i] = RandomImageSourceType::New();
+    randomSource[i]->SetSize( size );
+    randomSource[i]->SetMin( minimum[i] );
+    randomSource[i]->SetMax( maximum[i] );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( randomSource[i]->Update() );
+    }
+
+  // Denominators on both sides of the threshold of DivideOrZeroOutImageFilter
+  const OutputPixelType smallValues[6] = {0., 4e-6, -9e-6, 2e-5, -3e-5, 1e-4};
+  itk::ImageRegionIterator<ImageType> itDen(randomSource[2]->GetOutput(),
+                                            randomSource[2]->GetOutput()->GetLargestPossibleRegion());
+  for(unsigned int i=0; !itDen.IsAtEnd(); ++itDen, i++)
+    if(i%3 == 0)
+      itDen.Set( smallValues[(i/3)%6] );
+
+  std::cout << "\n\n****** Case 1: SART correction, quotient or zero ******" << std::endl;
+
+  typedef rtk::Expression::QuotientOrZero< rtk::Expression::Product< rtk::Expression::Difference< rtk::Expression::Input<0>,
+                                                                                                   rtk::Expression::Input<1> >,
+                                                                     rtk::Expression::Parameter<0> >,
+                                           rtk::Expression::Input<2> >            CorrectionExpressionType;
+  typedef rtk::ExpressionImageFilter<ImageType, CorrectionExpressionType>        CorrectionFilterType;
+  CorrectionFilterType::Pointer correction = CorrectionFilterType::New();
+  correction->SetInput(0, randomSource[0]->GetOutput());
+  correction->SetInput(1, randomSource[1]->GetOutput());
+  correction->SetInput(2, randomSource[2]->GetOutput());
+  correction->SetParameter(0, 0.3);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( correction->Update() );
+
+  typedef itk::SubtractImageFilter<ImageType, ImageType>        SubtractFilterType;
+  typedef itk::MultiplyImageFilter<ImageType, ImageType>        MultiplyFilterType;
+  typedef itk::DivideOrZeroOutImageFilter<ImageType, ImageType> DivideFilterType;
+  SubtractFilterType::Pointer subtract = SubtractFilterType::New();
+  subtract->SetInput1(randomSource[0]->GetOutput());
+  subtract->SetInput2(randomSource[1]->GetOutput());
+  MultiplyFilterType::Pointer multiply = MultiplyFilterType::New();
+  multiply->SetInput1(subtract->GetOutput());
+  multiply->SetConstant2(0.3);
+  DivideFilterType::Pointer divide = DivideFilterType::New();
+  divide->SetInput1(multiply->GetOutput());
+  divide->SetInput2(randomSource[2]->GetOutput());
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( divide->Update() );
+
+  CheckExpression<ImageType>(correction->GetOutput(), divide->GetOutput());
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 2: SART update, maximum as positivity constraint ******" << std::endl;
+
+  typedef rtk::Expression::Maximum< rtk::Expression::Sum< rtk::Expression::Input<0>, rtk::Expression::Input<1> >,
+                                    rtk::Expression::Parameter<0> >               UpdateExpressionType;
+  typedef rtk::ExpressionImageFilter<ImageType, UpdateExpressionType>            UpdateFilterType;
+  UpdateFilterType::Pointer update = UpdateFilterType::New();
+  update->SetInput(0, randomSource[0]->GetOutput());
+  update->SetInput(1, randomSource[1]->GetOutput());
+  update->SetParameter(0, 0.);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( update->Update() );
+
+  typedef itk::AddImageFilter<ImageType, ImageType>   AddFilterType;
+  typedef itk::ThresholdImageFilter<ImageType>        ThresholdFilterType;
+  AddFilterType::Pointer add = AddFilterType::New();
+  add->SetInput1(randomSource[0]->GetOutput());
+  add->SetInput2(randomSource[1]->GetOutput());
+  ThresholdFilterType::Pointer threshold = ThresholdFilterType::New();
+  threshold->SetInput(add->GetOutput());
+  threshold->SetOutsideValue(0);
+  threshold->ThresholdBelow(0);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( threshold->Update() );
+
+  CheckExpression<ImageType>(update->GetOutput(), threshold->GetOutput());
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 3: conjugate gradient sum, in place with input 0 also read ******" << std::endl;
+
+  // Reference (1+p0) * in0
+  MultiplyFilterType::Pointer multiplyRef = MultiplyFilterType::New();
+  multiplyRef->SetInput1(randomSource[0]->GetOutput());
+  multiplyRef->SetConstant2(1.+0.7);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( multiplyRef->Update() );
+
+  // The in place filter overwrites the buffer of its input 0, which is
+  // therefore a copy of the random image
+  typedef itk::ImageDuplicator<ImageType> DuplicatorType;
+  DuplicatorType::Pointer duplicator = DuplicatorType::New();
+  duplicator->SetInputImage(randomSource[0]->GetOutput());
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( duplicator->Update() );
+  ImageType::Pointer inPlaceInput = duplicator->GetOutput();
+  const OutputPixelType *inPlaceBuffer = inPlaceInput->GetBufferPointer();
+
+  typedef rtk::Expression::Sum< rtk::Expression::Input<0>,
+                                rtk::Expression::Product< rtk::Expression::Parameter<0>,
+                                                          rtk::Expression::Input<1> > > AddExpressionType;
+  typedef rtk::ExpressionImageFilter<ImageType, AddExpressionType>                    AddExpressionFilterType;
+  AddExpressionFilterType::Pointer inPlaceAdd = AddExpressionFilterType::New();
+  inPlaceAdd->SetInput(0, inPlaceInput);
+  inPlaceAdd->SetInput(1, inPlaceInput);
+  inPlaceAdd->SetParameter(0, 0.7);
+  inPlaceAdd->SetInPlace(true);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( inPlaceAdd->Update() );
+
+  if(inPlaceAdd->GetOutput()->GetBufferPointer() != inPlaceBuffer)
+    {
+    std::cerr << "Test Failed, the filter did not run in place" << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  CheckExpression<ImageType>(inPlaceAdd->GetOutput(), multiplyRef->GetOutput());
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -1,5 +1,6 @@
 #include <itkImageRegionConstIterator.h>
 #include <itkStreamingImageFilter.h>
+#include <itkCommand.h>
 #if ITK_VERSION_MAJOR > 4 || (ITK_VERSION_MAJOR == 4 && ITK_VERSION_MINOR >= 4)
   #include <itkImageRegionSplitterDirection.h>
 #endif
@@ -29,6 +30,31 @@
  * \author Simon Rit and Marc Vila
  */
 
+#ifndef USE_CUDA
+// Aborts the execution of the observed filter when it starts
+class AbortCommand : public itk::Command
+{
+public:
+  typedef AbortCommand            Self;
+  typedef itk::Command            Superclass;
+  typedef itk::SmartPointer<Self> Pointer;
+  itkNewMacro(Self);
+
+  void Execute(itk::Object *caller, const itk::EventObject &event) ITK_OVERRIDE
+    {
+    Execute( (const itk::Object *)caller, event);
+    }
+
+  void Execute(const itk::Object *, const itk::EventObject &) ITK_OVERRIDE
+    {
+    throw itk::ProcessAborted(__FILE__, __LINE__);
+    }
+
+protected:
+  AbortCommand() {}
+};
+#endif
+
 int main(int, char** )
 {
   const unsigned int Dimension = 3;
@@ -224,5 +250,85 @@ int main(int, char** )
   TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->UpdateLargestPossibleRegion() )
   CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
   std::cout << "Test PASSED! " << std::endl;
+
+#ifndef USE_CUDA
+  std::cout << "\n\n****** Case 6: pipelined projection subsets ******" << std::endl;
+  feldkamp->SetProjectionSubsetSize(8);
+  feldkamp->SetPipelineDepth(2);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 7: blocks of projections ******" << std::endl;
+  feldkamp->SetPipelineDepth(0);
+  feldkamp->GetBackProjectionFilter()->SetProjectionBlockSize(4);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 8: bricks ******" << std::endl;
+  feldkamp->GetBackProjectionFilter()->SetBrickSize(16);
+  feldkamp->Modified();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 9: field of view clipping ******" << std::endl;
+  double fovCenterX, fovCenterZ, fovRadius;
+  if( !fov->ComputeFOVRadius(FOVFilterType::RADIUSBOTH, fovCenterX, fovCenterZ, fovRadius) )
+    {
+    std::cerr << "Test Failed, could not compute the field of view" << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  feldkamp->GetBackProjectionFilter()->SetFOVCenterX(fovCenterX);
+  feldkamp->GetBackProjectionFilter()->SetFOVCenterZ(fovCenterZ);
+  feldkamp->GetBackProjectionFilter()->SetFOVRadius(fovRadius);
+  feldkamp->Modified();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 10: bicubic interpolation ******" << std::endl;
+  feldkamp->GetBackProjectionFilter()->SetInterpolation(FDKType::BackProjectionFilterType::BICUBIC);
+  feldkamp->Modified();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 11: nearest neighbor interpolation ******" << std::endl;
+  feldkamp->GetBackProjectionFilter()->SetInterpolation(FDKType::BackProjectionFilterType::NEAREST);
+  feldkamp->Modified();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+  CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.04, 24, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 12: abort in a thread of the pipelined projection subsets ******" << std::endl;
+  // The exception must be rethrown in the calling thread with its type, which
+  // the itk pipeline handles differently from other exceptions
+  feldkamp->SetPipelineDepth(2);
+  AbortCommand::Pointer abortCommand = AbortCommand::New();
+  feldkamp->GetRampFilter()->AddObserver(itk::StartEvent(), abortCommand);
+  bool aborted = false;
+  try
+    {
+    fov->UpdateLargestPossibleRegion();
+    }
+  catch( itk::ProcessAborted & )
+    {
+    aborted = true;
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cerr << "Test Failed, the abort has been rethrown as " << err.GetNameOfClass() << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  feldkamp->GetRampFilter()->RemoveAllObservers();
+  if(!aborted)
+    {
+    std::cerr << "Test Failed, the reconstruction has not been aborted" << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  std::cout << "Test PASSED! " << std::endl;
+#endif
   return EXIT_SUCCESS;
 }
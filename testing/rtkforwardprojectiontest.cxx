@@ -14,6 +14,8 @@
 #  include "rtkCudaForwardProjectionImageFilter.h"
 #else
 #  include "rtkJosephForwardProjectionImageFilter.h"
+#  include "rtkSiddonForwardProjectionImageFilter.h"
+#  include "rtkMipMapForwardProjectionImageFilter.h"
 #endif
 
 /**
@@ -28,6 +30,33 @@
  * \author Simon Rit and Marc Vila
  */
 
+#ifndef USE_CUDA
+/** Same interpolation as the default functor of the Joseph forward projector
+ * but of another type, which has no SIMD kernel. The rays are then traced
+ * one at a time. */
+class ScalarInterpolationWeightMultiplication
+{
+public:
+  bool operator!=( const ScalarInterpolationWeightMultiplication & ) const
+    {
+    return false;
+    }
+  bool operator==( const ScalarInterpolationWeightMultiplication & ) const
+    {
+    return true;
+    }
+
+  inline double operator()( const itk::ThreadIdType itkNotUsed(threadId),
+                            const double itkNotUsed(stepLengthInVoxel),
+                            const double weight,
+                            const float *p,
+                            const int i ) const
+    {
+    return weight*p[i];
+    }
+};
+#endif
+
 int main(int , char** )
 {
   const unsigned int Dimension = 3;
@@ -236,5 +265,152 @@ int main(int , char** )
   CheckImageQuality<OutputImageType>(stream->GetOutput(), slp->GetOutput(), 1.28, 44, 255.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+#ifndef USE_CUDA
+  std::cout << "\n\n****** Case 6: Shepp-Logan, inner ray source, empty space skipping ******" << std::endl;
+
+  // Skipping the bricks of zeros must not change the result
+  OutputImageType::Pointer noSkipping = stream->GetOutput();
+  noSkipping->DisconnectPipeline();
+  jfp->SetEmptySpaceSkipping(true);
+  jfp->SetEmptySpaceBrickSize(4);
+  stream->Update();
+
+  CheckImageQuality<OutputImageType>(stream->GetOutput(), noSkipping, 1e-10, 100, 255.0);
+  CheckImageQuality<OutputImageType>(stream->GetOutput(), slp->GetOutput(), 1.28, 44, 255.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 7: Shepp-Logan, inner ray source, Siddon ******" << std::endl;
+  typedef rtk::SiddonForwardProjectionImageFilter<OutputImageType, OutputImageType> SFPType;
+  SFPType::Pointer sfp = SFPType::New();
+  sfp->InPlaceOff();
+  sfp->SetInput( projInput->GetOutput() );
+  sfp->SetInput( 1, dsl->GetOutput() );
+  sfp->SetGeometry( geometry );
+  stream->SetInput(sfp->GetOutput());
+  stream->Update();
+
+  CheckImageQuality<OutputImageType>(stream->GetOutput(), slp->GetOutput(), 1.28, 44, 255.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 8: Shepp-Logan, pixels larger than voxels, mip-map ******" << std::endl;
+  // The pixel footprint is twice the voxel size in the middle of the volume
+  // and the rays are mostly traced in the second level of the pyramid
+  geometry = GeometryType::New();
+  for(unsigned int i=0; i<NumberOfProjectionImages; i++)
+    geometry->AddProjection(500., 500., i*8.);
+
+  slp->SetGeometry(geometry);
+  slp->Update();
+
+  typedef rtk::MipMapForwardProjectionImageFilter<OutputImageType, OutputImageType> MFPType;
+  MFPType::Pointer mfp = MFPType::New();
+  mfp->InPlaceOff();
+  mfp->SetInput( projInput->GetOutput() );
+  mfp->SetInput( 1, dsl->GetOutput() );
+  mfp->SetGeometry( geometry );
+  stream->SetInput(mfp->GetOutput());
+  stream->Update();
+
+  CheckImageQuality<OutputImageType>(stream->GetOutput(), slp->GetOutput(), 1.6, 40, 255.0);
+
+  // With pixels not larger than the voxels in the volume, all rays are
+  // traced in the full resolution volume and the pyramid must not change
+  // the result
+  geometry = GeometryType::New();
+  for(unsigned int i=0; i<NumberOfProjectionImages; i++)
+    geometry->AddProjection(500., 1000., i*8.);
+  mfp->SetGeometry( geometry );
+  mfp->SetNumberOfLevels(1);
+  stream->Update();
+  OutputImageType::Pointer levelZero = stream->GetOutput();
+  levelZero->DisconnectPipeline();
+  mfp->SetNumberOfLevels(4);
+  stream->Update();
+
+  CheckImageQuality<OutputImageType>(stream->GetOutput(), levelZero, 1e-10, 100, 255.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 9: ray culling, ROI volume, offset and cylindrical detectors ******" << std::endl;
+
+  // Volume whose projection only covers a part of the detector
+  origin[0] = -40.;
+  origin[1] = -20.;
+  origin[2] = 10.;
+  size.Fill(32);
+  spacing.Fill(2.);
+  volInput->SetOrigin( origin );
+  volInput->SetSpacing( spacing );
+  volInput->SetSize( size );
+  volInput->SetConstant( 0. );
+  dsl->Update();
+
+  // Tracing only the rays of the bounding rectangles of the projections of
+  // the volume must give exactly the same projections as tracing all rays
+  stream->SetInput(sfp->GetOutput());
+  for(unsigned int c=0; c<2; c++)
+    {
+    geometry = GeometryType::New();
+    for(unsigned int i=0; i<NumberOfProjectionImages; i++)
+      geometry->AddProjection(500., 1000., i*8., 30., -20.);
+    if(c==1)
+      geometry->SetRadiusCylindricalDetector(600);
+    sfp->SetGeometry( geometry );
+
+    sfp->SetRayCulling(false);
+    stream->Update();
+    OutputImageType::Pointer noCulling = stream->GetOutput();
+    noCulling->DisconnectPipeline();
+    sfp->SetRayCulling(true);
+    stream->Update();
+
+    CheckImageQuality<OutputImageType>(stream->GetOutput(), noCulling, 0., 100, 255.0);
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 10: Joseph, packets of rays against rays traced one at a time ******" << std::endl;
+
+  // Shepp-Logan volume of case 3 and projections around 45 degrees so that
+  // the main direction changes within some packets of rays
+  origin.Fill(-127);
+  size.Fill(128);
+  spacing.Fill(2.);
+  volInput->SetOrigin( origin );
+  volInput->SetSpacing( spacing );
+  volInput->SetSize( size );
+  volInput->SetConstant( 0. );
+  dsl->Update();
+
+  geometry = GeometryType::New();
+  for(unsigned int i=0; i<NumberOfProjectionImages; i++)
+    geometry->AddProjection(500., 1000., 45.+i*8.);
+
+  typedef rtk::JosephForwardProjectionImageFilter<OutputImageType,
+                                                  OutputImageType,
+                                                  ScalarInterpolationWeightMultiplication> ScalarJFPType;
+  ScalarJFPType::Pointer scalarJfp = ScalarJFPType::New();
+  scalarJfp->InPlaceOff();
+  scalarJfp->SetInput( projInput->GetOutput() );
+  scalarJfp->SetInput( 1, dsl->GetOutput() );
+  scalarJfp->SetGeometry( geometry );
+  stream->SetInput(scalarJfp->GetOutput());
+  stream->Update();
+  OutputImageType::Pointer scalarRays = stream->GetOutput();
+  scalarRays->DisconnectPipeline();
+
+  JFPType::Pointer packetJfp = JFPType::New();
+  packetJfp->InPlaceOff();
+  packetJfp->SetInput( projInput->GetOutput() );
+  packetJfp->SetInput( 1, dsl->GetOutput() );
+  packetJfp->SetGeometry( geometry );
+  stream->SetInput(packetJfp->GetOutput());
+  stream->Update();
+
+  // The middle steps of the packets are accumulated in float and the others
+  // in double. Without SIMD kernel, both projections are computed with the
+  // same scalar code.
+  CheckImageQuality<OutputImageType>(stream->GetOutput(), scalarRays, 0.01, 80, 255.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+#endif
+
   return EXIT_SUCCESS;
 }
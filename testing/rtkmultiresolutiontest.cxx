@@ -0,0 +1,273 @@
+#include <itkImageRegionConstIterator.h>
+
+#include "rtkTest.h"
+#include "rtkDrawEllipsoidImageFilter.h"
+#include "rtkRayEllipsoidIntersectionImageFilter.h"
+#include "rtkConstantImageSource.h"
+
+#ifdef RTK_USE_CUDA
+  #include "itkCudaImage.h"
+#endif
+#include "rtkSARTConeBeamReconstructionFilter.h"
+#include "rtkConjugateGradientConeBeamReconstructionFilter.h"
+#include "rtkADMMTotalVariationConeBeamReconstructionFilter.h"
+#include "rtkMultiResolutionConeBeamReconstructionFilter.h"
+
+/**
+ * \file rtkmultiresolutiontest.cxx
+ *
+ * \brief Functional test for coarse-to-fine reconstruction
+ *
+ * This test generates the projections of an ellipsoid and reconstructs the CT
+ * image with SART, conjugate gradient and ADMM TV reconstruction filters,
+ * once at full resolution with N iterations and once on two resolution
+ * levels with N/2 iterations at full resolution. The generated results are
+ * compared to the expected results (analytical calculation) and the root
+ * mean square error of the multiresolution reconstruction must not be larger
+ * than the one of the full resolution reconstruction.
+ */
+
+template<class TImage>
+double RootMeanSquareError(typename TImage::Pointer recon, typename TImage::Pointer ref)
+{
+  itk::ImageRegionConstIterator<TImage> itTest( recon, recon->GetBufferedRegion() );
+  itk::ImageRegionConstIterator<TImage> itRef( ref, ref->GetBufferedRegion() );
+  double sum = 0.;
+  for(; !itRef.IsAtEnd(); ++itTest, ++itRef)
+    sum += vcl_pow(double(itRef.Get() - itTest.Get()), 2.);
+  return vcl_sqrt(sum / ref->GetBufferedRegion().GetNumberOfPixels());
+}
+
+#if FAST_TESTS_NO_CHECKS
+template<class TImage>
+void CheckNotWorse(typename TImage::Pointer itkNotUsed(multiresolution),
+                   typename TImage::Pointer itkNotUsed(fullresolution),
+                   typename TImage::Pointer itkNotUsed(ref))
+{
+}
+#else
+template<class TImage>
+void CheckNotWorse(typename TImage::Pointer multiresolution,
+                   typename TImage::Pointer fullresolution,
+                   typename TImage::Pointer ref)
+{
+  const double multiresolutionRMSE = RootMeanSquareError<TImage>(multiresolution, ref);
+  const double fullresolutionRMSE = RootMeanSquareError<TImage>(fullresolution, ref);
+  std::cout << "RMSE with N iterations at full resolution = " << fullresolutionRMSE << std::endl;
+  std::cout << "RMSE with N/2 iterations at full resolution after the coarse level = "
+            << multiresolutionRMSE << std::endl;
+  if(multiresolutionRMSE > fullresolutionRMSE)
+    {
+    std::cerr << "Test Failed, the multiresolution reconstruction is worse than the full resolution one"
+              << std::endl;
+    exit(EXIT_FAILURE);
+    }
+}
+#endif
+
+int main(int, char** )
+{
+  const unsigned int Dimension = 3;
+  typedef float                                    OutputPixelType;
+
+#ifdef RTK_USE_CUDA
+  typedef itk::CudaImage< OutputPixelType, Dimension > OutputImageType;
+  typedef itk::CudaImage< itk::CovariantVector
+      < OutputPixelType, Dimension >, Dimension >      GradientOutputImageType;
+#else
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+  typedef itk::Image< itk::CovariantVector
+      < OutputPixelType, Dimension >, Dimension >      GradientOutputImageType;
+#endif
+
+#if FAST_TESTS_NO_CHECKS
+  const unsigned int NumberOfProjectionImages = 3;
+#else
+  const unsigned int NumberOfProjectionImages = 180;
+#endif
+
+
+  // Constant image sources
+  typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  ConstantImageSourceType::Pointer tomographySource  = ConstantImageSourceType::New();
+  origin[0] = -127.;
+  origin[1] = -127.;
+  origin[2] = -127.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  size[2] = 2;
+  spacing[0] = 252.;
+  spacing[1] = 252.;
+  spacing[2] = 252.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = 64;
+  spacing[0] = 4.;
+  spacing[1] = 4.;
+  spacing[2] = 4.;
+#endif
+  tomographySource->SetOrigin( origin );
+  tomographySource->SetSpacing( spacing );
+  tomographySource->SetSize( size );
+  tomographySource->SetConstant( 0. );
+
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  origin[0] = -255.;
+  origin[1] = -255.;
+  origin[2] = -255.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  size[2] = NumberOfProjectionImages;
+  spacing[0] = 504.;
+  spacing[1] = 504.;
+  spacing[2] = 504.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = NumberOfProjectionImages;
+  spacing[0] = 8.;
+  spacing[1] = 8.;
+  spacing[2] = 8.;
+#endif
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+  projectionsSource->SetConstant( 0. );
+
+  // Geometry object
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*360./NumberOfProjectionImages);
+
+  // Create ellipsoid PROJECTIONS
+  typedef rtk::RayEllipsoidIntersectionImageFilter<OutputImageType, OutputImageType> REIType;
+  REIType::Pointer rei;
+
+  rei = REIType::New();
+  REIType::VectorType semiprincipalaxis, center;
+  semiprincipalaxis.Fill(90.);
+  center.Fill(0.);
+  rei->SetAngle(0.);
+  rei->SetDensity(1.);
+  rei->SetCenter(center);
+  rei->SetAxis(semiprincipalaxis);
+
+  rei->SetInput( projectionsSource->GetOutput() );
+  rei->SetGeometry( geometry );
+
+  //Update
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rei->Update() );
+
+  // Create REFERENCE object (3D ellipsoid).
+  typedef rtk::DrawEllipsoidImageFilter<OutputImageType, OutputImageType> DEType;
+  DEType::Pointer dsl = DEType::New();
+  dsl->SetInput( tomographySource->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->Update() )
+
+  // Two resolution levels, the reconstruction filters are set in each case.
+  // Each case also runs the same filter at full resolution only, with twice
+  // the number of full resolution iterations of the multiresolution run.
+  typedef rtk::MultiResolutionConeBeamReconstructionFilter< OutputImageType > MultiResolutionType;
+  MultiResolutionType::Pointer multires = MultiResolutionType::New();
+  multires->SetInput( tomographySource->GetOutput() );
+  multires->SetInput(1, rei->GetOutput());
+  multires->SetNumberOfLevels( 2 );
+
+  std::cout << "\n\n****** Case 1: SART ******" << std::endl;
+
+  // Level l=2 is the single full resolution reconstruction with N iterations
+  typedef rtk::SARTConeBeamReconstructionFilter< OutputImageType > SARTType;
+  const unsigned int sartIterations = 2;
+  SARTType::Pointer sarts[3];
+  for(unsigned int l=0; l<3; l++)
+    {
+    sarts[l] = SARTType::New();
+    sarts[l]->SetGeometry( geometry );
+    sarts[l]->SetNumberOfIterations( (l==0)?sartIterations/2:sartIterations );
+    sarts[l]->SetLambda( 0.5 );
+    sarts[l]->SetBackProjectionFilter( 0 ); // Voxel based
+    sarts[l]->SetForwardProjectionFilter( 0 ); // Joseph
+    }
+  multires->SetReconstructionFilter(0, sarts[0]);
+  multires->SetReconstructionFilter(1, sarts[1]);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( multires->Update() );
+  sarts[2]->SetInput( tomographySource->GetOutput() );
+  sarts[2]->SetInput(1, rei->GetOutput());
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( sarts[2]->Update() );
+
+  CheckImageQuality<OutputImageType>(multires->GetOutput(), dsl->GetOutput(), 0.032, 28.6, 2.0);
+  CheckNotWorse<OutputImageType>(multires->GetOutput(), sarts[2]->GetOutput(), dsl->GetOutput());
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 2: Conjugate gradient ******" << std::endl;
+
+  // The weights are binned as the projections
+  ConstantImageSourceType::Pointer uniformWeightsSource = ConstantImageSourceType::New();
+  uniformWeightsSource->SetInformationFromImage(projectionsSource->GetOutput());
+  uniformWeightsSource->SetConstant(1.0);
+  multires->SetInput(2, uniformWeightsSource->GetOutput());
+
+  typedef rtk::ConjugateGradientConeBeamReconstructionFilter< OutputImageType > ConjugateGradientType;
+  const unsigned int cgIterations = 6;
+  ConjugateGradientType::Pointer conjugategradients[3];
+  for(unsigned int l=0; l<3; l++)
+    {
+    conjugategradients[l] = ConjugateGradientType::New();
+    conjugategradients[l]->SetGeometry( geometry );
+    conjugategradients[l]->SetNumberOfIterations( (l==0)?cgIterations/2:cgIterations );
+    conjugategradients[l]->SetBackProjectionFilter( 0 ); // Voxel based
+    conjugategradients[l]->SetForwardProjectionFilter( 0 ); // Joseph
+    }
+  multires->SetReconstructionFilter(0, conjugategradients[0]);
+  multires->SetReconstructionFilter(1, conjugategradients[1]);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( multires->Update() );
+  conjugategradients[2]->SetInput( tomographySource->GetOutput() );
+  conjugategradients[2]->SetInput(1, rei->GetOutput());
+  conjugategradients[2]->SetInput(2, uniformWeightsSource->GetOutput());
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( conjugategradients[2]->Update() );
+
+  CheckImageQuality<OutputImageType>(multires->GetOutput(), dsl->GetOutput(), 0.08, 23, 2.0);
+  CheckNotWorse<OutputImageType>(multires->GetOutput(), conjugategradients[2]->GetOutput(), dsl->GetOutput());
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 3: ADMM TV ******" << std::endl;
+
+  // ADMM TV only has two inputs
+  multires->SetInput(2, ITK_NULLPTR);
+
+  typedef rtk::ADMMTotalVariationConeBeamReconstructionFilter
+    <OutputImageType, GradientOutputImageType>                ADMMTotalVariationType;
+  const unsigned int admmIterations = 4;
+  ADMMTotalVariationType::Pointer admmtotalvariations[3];
+  for(unsigned int l=0; l<3; l++)
+    {
+    admmtotalvariations[l] = ADMMTotalVariationType::New();
+    admmtotalvariations[l]->SetGeometry( geometry );
+    admmtotalvariations[l]->SetAlpha( 100 );
+    admmtotalvariations[l]->SetBeta( 1000 );
+    admmtotalvariations[l]->SetAL_iterations( (l==0)?admmIterations/2:admmIterations );
+    admmtotalvariations[l]->SetCG_iterations( 2 );
+    admmtotalvariations[l]->SetBackProjectionFilter( 0 ); // Voxel based
+    admmtotalvariations[l]->SetForwardProjectionFilter( 0 ); // Joseph
+    }
+  multires->SetReconstructionFilter(0, admmtotalvariations[0]);
+  multires->SetReconstructionFilter(1, admmtotalvariations[1]);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( multires->Update() );
+  admmtotalvariations[2]->SetInput( tomographySource->GetOutput() );
+  admmtotalvariations[2]->SetInput(1, rei->GetOutput());
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( admmtotalvariations[2]->Update() );
+
+  CheckImageQuality<OutputImageType>(multires->GetOutput(), dsl->GetOutput(), 0.05, 23, 2.0);
+  CheckNotWorse<OutputImageType>(multires->GetOutput(), admmtotalvariations[2]->GetOutput(), dsl->GetOutput());
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,259 @@
+#include <itkImageRegionConstIterator.h>
+
+#include "rtkTest.h"
+#include "rtkDrawEllipsoidImageFilter.h"
+#include "rtkRayEllipsoidIntersectionImageFilter.h"
+#include "rtkConstantImageSource.h"
+
+#ifdef RTK_USE_CUDA
+  #include "itkCudaImage.h"
+#endif
+#include "rtkOSSQSConeBeamReconstructionFilter.h"
+#include "rtkSARTConeBeamReconstructionFilter.h"
+
+#include <algorithm>
+
+/**
+ * \file rtkossqstest.cxx
+ *
+ * \brief Functional test for OS-SQS reconstruction
+ *
+ * This test generates the projections of an ellipsoid and reconstructs the CT
+ * image using the OS-SQS algorithm without and with Nesterov's momentum and
+ * total variation regularization. The generated results are compared to the
+ * expected results (analytical calculation). The error of OS-SQS with
+ * momentum is also compared to the one of OS-SART with the same subsets and
+ * the same number of passes. It also checks that the SQS denominators are
+ * not recomputed when the reconstruction is updated again with the same
+ * inputs.
+ */
+
+template<class TImage>
+double ComputeMSE(typename TImage::Pointer recon, typename TImage::Pointer ref)
+{
+  typedef itk::ImageRegionConstIterator<TImage> ImageIteratorType;
+  ImageIteratorType itTest( recon, recon->GetBufferedRegion() );
+  ImageIteratorType itRef( ref, ref->GetBufferedRegion() );
+
+  double EnerError = 0.;
+  while( !itRef.IsAtEnd() )
+    {
+    EnerError += vcl_pow(double(itRef.Get() - itTest.Get()), 2.);
+    ++itTest;
+    ++itRef;
+    }
+  return EnerError / ref->GetBufferedRegion().GetNumberOfPixels();
+}
+
+// Gives access to the SQS denominators of the reconstruction filter
+template<class TImage>
+class OSSQSWithDenominatorAccess : public rtk::OSSQSConeBeamReconstructionFilter<TImage>
+{
+public:
+  typedef OSSQSWithDenominatorAccess Self;
+  typedef itk::SmartPointer<Self>    Pointer;
+
+  itkNewMacro(Self);
+
+  const TImage * GetInverseDenominator() const
+    { return this->m_InverseDenominatorFilter->GetOutput(); }
+
+protected:
+  OSSQSWithDenominatorAccess() {}
+};
+
+int main(int, char** )
+{
+  const unsigned int Dimension = 3;
+  typedef float                                    OutputPixelType;
+
+#ifdef RTK_USE_CUDA
+  typedef itk::CudaImage< OutputPixelType, Dimension > OutputImageType;
+#else
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+#endif
+
+#if FAST_TESTS_NO_CHECKS
+  const unsigned int NumberOfProjectionImages = 3;
+#else
+  const unsigned int NumberOfProjectionImages = 180;
+#endif
+
+
+  // Constant image sources
+  typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  ConstantImageSourceType::Pointer tomographySource  = ConstantImageSourceType::New();
+  origin[0] = -127.;
+  origin[1] = -127.;
+  origin[2] = -127.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  size[2] = 2;
+  spacing[0] = 252.;
+  spacing[1] = 252.;
+  spacing[2] = 252.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = 64;
+  spacing[0] = 4.;
+  spacing[1] = 4.;
+  spacing[2] = 4.;
+#endif
+  tomographySource->SetOrigin( origin );
+  tomographySource->SetSpacing( spacing );
+  tomographySource->SetSize( size );
+  tomographySource->SetConstant( 0. );
+
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  origin[0] = -255.;
+  origin[1] = -255.;
+  origin[2] = -255.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  size[2] = NumberOfProjectionImages;
+  spacing[0] = 504.;
+  spacing[1] = 504.;
+  spacing[2] = 504.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = NumberOfProjectionImages;
+  spacing[0] = 8.;
+  spacing[1] = 8.;
+  spacing[2] = 8.;
+#endif
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+  projectionsSource->SetConstant( 0. );
+
+  // Geometry object
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*360./NumberOfProjectionImages);
+
+  // Create ellipsoid PROJECTIONS
+  typedef rtk::RayEllipsoidIntersectionImageFilter<OutputImageType, OutputImageType> REIType;
+  REIType::Pointer rei;
+
+  rei = REIType::New();
+  REIType::VectorType semiprincipalaxis, center;
+  semiprincipalaxis.Fill(90.);
+  center.Fill(0.);
+  rei->SetAngle(0.);
+  rei->SetDensity(1.);
+  rei->SetCenter(center);
+  rei->SetAxis(semiprincipalaxis);
+
+  rei->SetInput( projectionsSource->GetOutput() );
+  rei->SetGeometry( geometry );
+
+  //Update
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rei->Update() );
+
+  // Create REFERENCE object (3D ellipsoid).
+  typedef rtk::DrawEllipsoidImageFilter<OutputImageType, OutputImageType> DEType;
+  DEType::Pointer dsl = DEType::New();
+  dsl->SetInput( tomographySource->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->Update() )
+
+  // OS-SQS reconstruction filtering
+  typedef OSSQSWithDenominatorAccess< OutputImageType > OSSQSType;
+  OSSQSType::Pointer ossqs = OSSQSType::New();
+  ossqs->SetInput( tomographySource->GetOutput() );
+  ossqs->SetInput(1, rei->GetOutput());
+  ossqs->SetGeometry( geometry );
+  ossqs->SetBackProjectionFilter( 0 ); // Voxel based
+  ossqs->SetForwardProjectionFilter( 0 ); // Joseph
+  ossqs->SetNumberOfSubsets( 10 );
+
+  std::cout << "\n\n****** Case 1: OS-SQS with 10 subsets ******" << std::endl;
+
+  ossqs->SetNumberOfIterations( 5 );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( ossqs->Update() );
+
+  CheckImageQuality<OutputImageType>(ossqs->GetOutput(), dsl->GetOutput(), 0.05, 23, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 2: second update, the SQS denominators are reused ******" << std::endl;
+
+  const unsigned long denominatorTime = ossqs->GetInverseDenominator()->GetUpdateMTime();
+  ossqs->Modified();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( ossqs->Update() );
+
+  if(ossqs->GetInverseDenominator()->GetUpdateMTime() != denominatorTime)
+    {
+    std::cerr << "Test Failed, the SQS denominators have been recomputed" << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  CheckImageQuality<OutputImageType>(ossqs->GetOutput(), dsl->GetOutput(), 0.05, 23, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 3: OS-SQS with Nesterov's momentum ******" << std::endl;
+
+  ossqs->SetNumberOfIterations( 3 );
+  ossqs->SetNesterovMomentum( true );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( ossqs->Update() );
+
+  CheckImageQuality<OutputImageType>(ossqs->GetOutput(), dsl->GetOutput(), 0.05, 23, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 4: OS-SQS with Nesterov's momentum against OS-SART, same subsets and passes ******" << std::endl;
+
+  const double ossqsMSE = ComputeMSE<OutputImageType>(ossqs->GetOutput(), dsl->GetOutput());
+
+  typedef rtk::SARTConeBeamReconstructionFilter< OutputImageType > SARTType;
+  SARTType::Pointer sart = SARTType::New();
+  sart->SetInput( tomographySource->GetOutput() );
+  sart->SetInput(1, rei->GetOutput());
+  sart->SetGeometry( geometry );
+  sart->SetBackProjectionFilter( 0 ); // Voxel based
+  sart->SetForwardProjectionFilter( 0 ); // Joseph
+  sart->SetNumberOfIterations( ossqs->GetNumberOfIterations() );
+  sart->SetNumberOfProjectionsPerSubset( std::max(1u, NumberOfProjectionImages / ossqs->GetNumberOfSubsets()) );
+  sart->SetLambda( 0.5 );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() );
+
+  const double sartMSE = ComputeMSE<OutputImageType>(sart->GetOutput(), dsl->GetOutput());
+  std::cout << "OS-SQS MSE = " << ossqsMSE << ", OS-SART MSE = " << sartMSE << std::endl;
+#if !(FAST_TESTS_NO_CHECKS)
+  if(ossqsMSE > sartMSE)
+    {
+    std::cerr << "Test Failed, the error of OS-SQS is larger than the one of OS-SART" << std::endl;
+    exit(EXIT_FAILURE);
+    }
+#endif
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 5: OS-SQS with Nesterov's momentum, positivity and TV regularization ******" << std::endl;
+
+  ossqs->SetEnforcePositivity( true );
+  ossqs->SetPerformTVSpatialDenoising( true );
+  ossqs->SetGammaTV( 0.01 );
+  ossqs->SetTV_iterations( 5 );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( ossqs->Update() );
+
+  CheckImageQuality<OutputImageType>(ossqs->GetOutput(), dsl->GetOutput(), 0.05, 23, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+#ifdef USE_CUDA
+  std::cout << "\n\n****** Case 6: CUDA projectors ******" << std::endl;
+
+  ossqs->SetBackProjectionFilter( 2 ); // Cuda voxel based
+  ossqs->SetForwardProjectionFilter( 2 ); // Cuda ray cast
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( ossqs->Update() );
+
+  CheckImageQuality<OutputImageType>(ossqs->GetOutput(), dsl->GetOutput(), 0.05, 23, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+#endif
+
+  return EXIT_SUCCESS;
+}
@@ -1,5 +1,8 @@
 #include <itkImageRegionConstIterator.h>
 
+#include <cstdlib>
+#include <algorithm>
+
 #include "rtkTest.h"
 #include "rtkDrawEllipsoidImageFilter.h"
 #include "rtkRayEllipsoidIntersectionImageFilter.h"
@@ -175,7 +178,45 @@ int main(int, char** )
   std::cout << "\n\nTest PASSED! " << std::endl;
 #endif
 
-  std::cout << "\n\n****** Case 5: Voxel-Based Backprojector and gating ******" << std::endl;
+  std::cout << "\n\n****** Case 5: Voxel-Based Backprojector, OS-SART with 4 projections per subset processed at once ******" << std::endl;
+
+  sart->SetBackProjectionFilter( 0 ); // Voxel based
+  sart->SetForwardProjectionFilter( 0 ); // Joseph
+  sart->SetNumberOfProjectionsPerSubset(4);
+
+  // Sequential OS-SART with the same subsets, the projection order is drawn
+  // with std::random_shuffle from the same seed
+  std::srand(0);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() );
+  OutputImageType::Pointer sequential = sart->GetOutput();
+  sequential->DisconnectPipeline();
+
+  sart->SetParallelSubsetProcessing(true);
+  std::srand(0);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() );
+
+  CheckImageQuality<OutputImageType>(sart->GetOutput(), dsl->GetOutput(), 0.032, 28.6, 2.0);
+
+  // Both modes must give the same result up to the order of the floating
+  // point operations
+  itk::ImageRegionConstIterator<OutputImageType> itPar(sart->GetOutput(), sart->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<OutputImageType> itSeq(sequential, sequential->GetLargestPossibleRegion());
+  double maxDifference = 0.;
+  for(; !itPar.IsAtEnd(); ++itPar, ++itSeq)
+    maxDifference = std::max(maxDifference, (double)vcl_abs(itPar.Get() - itSeq.Get()));
+  std::cout << "Maximum difference with sequential OS-SART = " << maxDifference << std::endl;
+  if(maxDifference > 1e-4)
+    {
+    std::cerr << "Test Failed, parallel and sequential OS-SART differ by " << maxDifference << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  // Back to the settings of the next case
+  sart->SetNumberOfProjectionsPerSubset(2);
+  sart->SetParallelSubsetProcessing(false);
+
+  std::cout << "\n\n****** Case 6: Voxel-Based Backprojector and gating ******" << std::endl;
 
   sart->SetBackProjectionFilter( 0 ); // Voxel based
   sart->SetForwardProjectionFilter( 0 ); // Joseph